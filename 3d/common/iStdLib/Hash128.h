@@ -0,0 +1,411 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "types.h"
+#include "utility.h"
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ISTD_HASH128_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+#if defined(_WIN32) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+namespace iSTD
+{
+
+/*****************************************************************************\
+STRUCT: Hash128Value
+\*****************************************************************************/
+struct Hash128Value
+{
+    QWORD   lo;
+    QWORD   hi;
+
+    bool operator==( const Hash128Value& other ) const
+    {
+        return lo == other.lo && hi == other.hi;
+    }
+
+    bool operator!=( const Hash128Value& other ) const
+    {
+        return !( *this == other );
+    }
+};
+
+/*****************************************************************************\
+
+Class:
+    Hash128
+
+Description:
+    Streaming hash of byte sequences.
+
+    HASH128_LANES processes the input in 64-byte stripes held in eight
+    independent 64-bit lanes. Each lane accumulates the 32x32-bit product of
+    the halves of its key-mixed input, so there is no serial dependency
+    between lanes and four 128-bit SSE2 multiplies handle a stripe. The
+    lanes are scrambled every 1KB and folded into a 128-bit result. The
+    result does not depend on whether the SSE2 or scalar path is used.
+
+    HASH128_LEGACY feeds the input as DWORDs through the Jenkins mix of
+    iSTD::Hash. The result's lo is identical to iSTD::Hash for inputs of
+    whole DWORDs (and to iSTD::HashFromBuffer for any input), hi is 0. Use
+    it where hash values must stay stable, e.g. dump and override names.
+
+    Update() can be called any number of times; the result depends only on
+    the concatenation of the data. Final() does not modify the state.
+
+    All magic values are QWORDs of SHA2-512 mixing data.
+
+\*****************************************************************************/
+class Hash128
+{
+public:
+    enum Mode
+    {
+        HASH128_LANES,
+        HASH128_LEGACY
+    };
+
+    explicit Hash128( Mode mode = HASH128_LANES );
+
+    void            Update( const void* data, size_t size );
+    Hash128Value    Final( void ) const;
+
+    template<class Type>
+    void UpdateValue( const Type& value )
+    {
+        Update( &value, sizeof( Type ) );
+    }
+
+protected:
+    enum
+    {
+        NUM_LANES           = 8,
+        STRIPE_SIZE         = NUM_LANES * sizeof( QWORD ),
+        STRIPES_PER_BLOCK   = 16
+    };
+
+    void    ConsumeStripe( const BYTE* stripe );
+    void    ConsumeLegacy( const BYTE* data, size_t numDwords );
+    static void AccumulateStripe( QWORD* acc, const BYTE* stripe );
+    static void ScrambleLanes( QWORD* acc );
+    static QWORD MulFold64( QWORD a, QWORD b );
+    static QWORD Avalanche( QWORD h );
+
+    static const QWORD* Keys( void );
+    static const QWORD* ScrambleKeys( void );
+
+    Mode    m_Mode;
+    QWORD   m_Acc[ NUM_LANES ];
+    DWORD   m_StripesInBlock;
+    QWORD   m_TotalSize;
+    BYTE    m_Buffer[ STRIPE_SIZE ];
+    size_t  m_BufferSize;
+
+    // HASH128_LEGACY state
+    DWORD   m_LegacyA;
+    DWORD   m_LegacyHi;
+    DWORD   m_LegacyLo;
+};
+
+inline const QWORD* Hash128::Keys( void )
+{
+    static const QWORD keys[ NUM_LANES ] =
+    {
+        0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+        0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL
+    };
+    return keys;
+}
+
+inline const QWORD* Hash128::ScrambleKeys( void )
+{
+    static const QWORD keys[ NUM_LANES ] =
+    {
+        0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+        0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL
+    };
+    return keys;
+}
+
+inline Hash128::Hash128( Mode mode )
+    : m_Mode( mode ),
+      m_StripesInBlock( 0 ),
+      m_TotalSize( 0 ),
+      m_BufferSize( 0 ),
+      m_LegacyA( 0x428a2f98 ),
+      m_LegacyHi( 0x71374491 ),
+      m_LegacyLo( 0xb5c0fbcf )
+{
+    for( DWORD i = 0; i < NUM_LANES; i++ )
+    {
+        m_Acc[ i ] = Keys()[ ( i + 1 ) % NUM_LANES ];
+    }
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128::AccumulateStripe
+
+Description:
+    For each lane i: acc[i] += lo32(d ^ key) * hi32(d ^ key), acc[i^1] += d
+\*****************************************************************************/
+__forceinline void Hash128::AccumulateStripe( QWORD* acc, const BYTE* stripe )
+{
+#if defined(ISTD_HASH128_SSE2)
+    for( DWORD i = 0; i < NUM_LANES; i += 2 )
+    {
+        const __m128i data = _mm_loadu_si128( reinterpret_cast<const __m128i*>( stripe ) + i / 2 );
+        const __m128i key = _mm_loadu_si128( reinterpret_cast<const __m128i*>( Keys() ) + i / 2 );
+        const __m128i mixed = _mm_xor_si128( data, key );
+        const __m128i mixedHi = _mm_shuffle_epi32( mixed, _MM_SHUFFLE( 0, 3, 0, 1 ) );
+        const __m128i product = _mm_mul_epu32( mixed, mixedHi );
+        const __m128i swapped = _mm_shuffle_epi32( data, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+        __m128i* accVec = reinterpret_cast<__m128i*>( acc ) + i / 2;
+        _mm_storeu_si128( accVec,
+            _mm_add_epi64( _mm_loadu_si128( accVec ), _mm_add_epi64( product, swapped ) ) );
+    }
+#else
+    for( DWORD i = 0; i < NUM_LANES; i++ )
+    {
+        QWORD data;
+        memcpy( &data, stripe + i * sizeof( QWORD ), sizeof( QWORD ) );
+        const QWORD mixed = data ^ Keys()[ i ];
+        acc[ i ] += ( mixed & 0xffffffff ) * ( mixed >> 32 );
+        acc[ i ^ 1 ] += data;
+    }
+#endif
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128::ScrambleLanes
+\*****************************************************************************/
+__forceinline void Hash128::ScrambleLanes( QWORD* acc )
+{
+    const DWORD prime = 0x9E3779B1;
+#if defined(ISTD_HASH128_SSE2)
+    const __m128i primeVec = _mm_set1_epi32( (int)prime );
+    for( DWORD i = 0; i < NUM_LANES; i += 2 )
+    {
+        __m128i* accVec = reinterpret_cast<__m128i*>( acc ) + i / 2;
+        __m128i a = _mm_loadu_si128( accVec );
+        a = _mm_xor_si128( a, _mm_srli_epi64( a, 47 ) );
+        a = _mm_xor_si128( a, _mm_loadu_si128( reinterpret_cast<const __m128i*>( ScrambleKeys() ) + i / 2 ) );
+        // 64x32-bit multiply from two 32x32->64 products
+        const __m128i lo = _mm_mul_epu32( a, primeVec );
+        const __m128i hi = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), primeVec );
+        _mm_storeu_si128( accVec, _mm_add_epi64( lo, _mm_slli_epi64( hi, 32 ) ) );
+    }
+#else
+    for( DWORD i = 0; i < NUM_LANES; i++ )
+    {
+        QWORD a = acc[ i ];
+        a ^= a >> 47;
+        a ^= ScrambleKeys()[ i ];
+        acc[ i ] = a * prime;
+    }
+#endif
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128::MulFold64
+
+Description:
+    Folds the 128-bit product of a and b into 64 bits.
+\*****************************************************************************/
+__forceinline QWORD Hash128::MulFold64( QWORD a, QWORD b )
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = (unsigned __int128)a * b;
+    return (QWORD)product ^ (QWORD)( product >> 64 );
+#elif defined(_WIN32) && defined(_M_X64)
+    QWORD hi;
+    const QWORD lo = _umul128( a, b, &hi );
+    return lo ^ hi;
+#else
+    const QWORD aLo = a & 0xffffffff, aHi = a >> 32;
+    const QWORD bLo = b & 0xffffffff, bHi = b >> 32;
+    const QWORD ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    const QWORD cross = ( ll >> 32 ) + ( lh & 0xffffffff ) + hl;
+    const QWORD hi = hh + ( lh >> 32 ) + ( cross >> 32 );
+    const QWORD lo = ( cross << 32 ) | ( ll & 0xffffffff );
+    return lo ^ hi;
+#endif
+}
+
+__forceinline QWORD Hash128::Avalanche( QWORD h )
+{
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+inline void Hash128::ConsumeStripe( const BYTE* stripe )
+{
+    AccumulateStripe( m_Acc, stripe );
+    if( ++m_StripesInBlock == STRIPES_PER_BLOCK )
+    {
+        ScrambleLanes( m_Acc );
+        m_StripesInBlock = 0;
+    }
+}
+
+inline void Hash128::ConsumeLegacy( const BYTE* data, size_t numDwords )
+{
+    DWORD a = m_LegacyA, hi = m_LegacyHi, lo = m_LegacyLo;
+    for( size_t i = 0; i < numDwords; i++ )
+    {
+        DWORD dw;
+        memcpy( &dw, data + i * sizeof( DWORD ), sizeof( DWORD ) );
+        HashNext( a, hi, lo, dw );
+    }
+    m_LegacyA = a;
+    m_LegacyHi = hi;
+    m_LegacyLo = lo;
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128::Update
+\*****************************************************************************/
+inline void Hash128::Update( const void* data, size_t size )
+{
+    const BYTE* bytes = static_cast<const BYTE*>( data );
+    const size_t unit = ( m_Mode == HASH128_LEGACY ) ? sizeof( DWORD ) : (size_t)STRIPE_SIZE;
+    m_TotalSize += size;
+
+    // Complete a partially filled unit first
+    if( m_BufferSize != 0 )
+    {
+        const size_t fill = ( size < unit - m_BufferSize ) ? size : unit - m_BufferSize;
+        memcpy( m_Buffer + m_BufferSize, bytes, fill );
+        m_BufferSize += fill;
+        bytes += fill;
+        size -= fill;
+        if( m_BufferSize < unit )
+        {
+            return;
+        }
+        if( m_Mode == HASH128_LEGACY )
+        {
+            ConsumeLegacy( m_Buffer, 1 );
+        }
+        else
+        {
+            ConsumeStripe( m_Buffer );
+        }
+        m_BufferSize = 0;
+    }
+
+    if( m_Mode == HASH128_LEGACY )
+    {
+        ConsumeLegacy( bytes, size / unit );
+    }
+    else
+    {
+        for( size_t i = 0; i < size / unit; i++ )
+        {
+            ConsumeStripe( bytes + i * unit );
+        }
+    }
+
+    const size_t consumed = size - size % unit;
+    m_BufferSize = size % unit;
+    memcpy( m_Buffer, bytes + consumed, m_BufferSize );
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128::Final
+\*****************************************************************************/
+inline Hash128Value Hash128::Final( void ) const
+{
+    Hash128Value result;
+
+    if( m_Mode == HASH128_LEGACY )
+    {
+        DWORD a = m_LegacyA, hi = m_LegacyHi, lo = m_LegacyLo;
+        if( m_BufferSize != 0 )
+        {
+            // Same zero padding of the last DWORD as HashFromBuffer
+            DWORD lastDw = 0;
+            memcpy( &lastDw, m_Buffer, m_BufferSize );
+            HashNext( a, hi, lo, lastDw );
+        }
+        result.lo = ( ( (QWORD)hi ) << 32 ) | lo;
+        result.hi = 0;
+        return result;
+    }
+
+    QWORD acc[ NUM_LANES ];
+    memcpy( acc, m_Acc, sizeof( acc ) );
+    if( m_BufferSize != 0 )
+    {
+        BYTE lastStripe[ STRIPE_SIZE ] = {};
+        memcpy( lastStripe, m_Buffer, m_BufferSize );
+        AccumulateStripe( acc, lastStripe );
+    }
+
+    // The length distinguishes inputs that only differ in trailing zeros
+    QWORD lo = m_TotalSize * 0x9E3779B185EBCA87ULL;
+    QWORD hi = ~m_TotalSize * 0xC2B2AE3D27D4EB4FULL;
+    for( DWORD i = 0; i < NUM_LANES; i += 2 )
+    {
+        lo += MulFold64( acc[ i ] ^ ScrambleKeys()[ i ], acc[ i + 1 ] ^ ScrambleKeys()[ i + 1 ] );
+        hi += MulFold64( acc[ i ] ^ Keys()[ i + 1 ], acc[ i + 1 ] ^ Keys()[ i ] );
+    }
+    result.lo = Avalanche( lo );
+    result.hi = Avalanche( hi ^ lo );
+    return result;
+}
+
+/*****************************************************************************\
+Inline Function:
+    Hash128Buffer
+
+Description:
+    Calculates 128-bit hash of a data buffer in a single call.
+\*****************************************************************************/
+inline Hash128Value Hash128Buffer(
+    const void* data,
+    size_t size,
+    Hash128::Mode mode = Hash128::HASH128_LANES )
+{
+    Hash128 hash( mode );
+    hash.Update( data, size );
+    return hash.Final();
+}
+
+} // namespace iSTD
@@ -152,6 +152,22 @@ void CGen8OpenCLProgram::AddKernelBinary(
     m_KernelBinaries.push_back( kernelHeap );
 }
 
+void CGen8OpenCLProgram::AddKernelBinary(
+        const char*  kernelBinary,
+        size_t       kernelBinarySize )
+{
+    Util::BinaryStream* kernelHeap = new Util::BinaryStream();
+
+    kernelHeap->Write( kernelBinary, kernelBinarySize );
+
+    m_KernelBinaries.push_back( kernelHeap );
+}
+
+Util::BinaryStream* CGen8OpenCLProgram::GetLastKernelBinary()
+{
+    return m_KernelBinaries.empty() ? nullptr : m_KernelBinaries.back();
+}
+
 void CGen8OpenCLProgram::CreateProgramScopePatchStream(const IGC::SOpenCLProgramInfo& annotations)
 {
     m_StateProcessor.CreateProgramScopePatchStream(annotations, *m_ProgramScopePatchStream);
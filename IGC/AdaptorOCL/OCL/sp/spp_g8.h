@@ -60,6 +60,15 @@ public:
         USC::SSystemThreadKernelOutput* pSystemThreadKernelOutput,
         unsigned int unpaddedBinarySize);
 
+    // Adds a kernel binary built by an earlier AddKernelBinary call, e.g. one
+    // taken from the kernel binary cache.
+    void AddKernelBinary(
+        const char*  kernelBinary,
+        size_t       kernelBinarySize);
+
+    // Returns the binary of the kernel added last, nullptr if there is none.
+    Util::BinaryStream* GetLastKernelBinary();
+
     void CreateProgramScopePatchStream(const IGC::SOpenCLProgramInfo& programInfo);
 
     void AddKernelDebugData(
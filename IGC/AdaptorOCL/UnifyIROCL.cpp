@@ -450,13 +450,15 @@ void UnifyIRSPIR(
     {
         pContext->getModule()->setTargetTriple("vISA_32");
 		BuiltinGenericModule->setTargetTriple("vISA_32");
-		BuiltinSizeModule->setTargetTriple("vISA_32");
+		if (BuiltinSizeModule)
+			BuiltinSizeModule->setTargetTriple("vISA_32");
     }
     else // pointer size 64bit
     {
         pContext->getModule()->setTargetTriple("vISA_64");
 		BuiltinGenericModule->setTargetTriple("vISA_64");
-		BuiltinSizeModule->setTargetTriple("vISA_64");
+		if (BuiltinSizeModule)
+			BuiltinSizeModule->setTargetTriple("vISA_64");
     }
 
     CommonOCLBasedPasses(pContext, std::move(BuiltinGenericModule), std::move(BuiltinSizeModule));
@@ -26,6 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <assert.h>
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <string>
 #include <stdexcept>
 
@@ -561,6 +563,26 @@ bool ParseInput(
     return true;
 }
 
+// Builtin resources never change, so each one is loaded once per process and
+// every build parses its builtin modules from a non-owning view of it.
+static std::unique_ptr<llvm::MemoryBuffer> GetBuiltinResource(const char* pResName)
+{
+    static std::mutex cacheMutex;
+    static std::map<std::string, std::unique_ptr<llvm::MemoryBuffer>> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::unique_ptr<llvm::MemoryBuffer>& pBuffer = cache[pResName];
+    if (!pBuffer)
+    {
+        pBuffer.reset(llvm::LoadBufferFromResource(pResName, "BC"));
+        if (!pBuffer)
+        {
+            return nullptr;
+        }
+    }
+    return llvm::MemoryBuffer::getMemBuffer(pBuffer->getMemBufferRef(), false);
+}
+
 bool TranslateBuild(
     const STB_TranslateInputArgs* pInputArgs,
     STB_TranslateOutputArgs* pOutputArgs,
@@ -577,12 +599,14 @@ bool TranslateBuild(
 
     // Parse the module we want to compile
     llvm::Module* pKernelModule = nullptr;
-    LLVMContextWrapper* llvmContext = new LLVMContextWrapper;
+    LLVMContextWrapper* llvmContext = LLVMContextPool::acquire();
     RegisterComputeErrHandlers(*llvmContext);
     if (!ParseInput(pKernelModule, pInputArgs, pOutputArgs, *llvmContext, inputDataFormatTemp))
     {
         return false;
     }
+    // Passes remove some of the input types, e.g. device enqueue lowering.
+    llvmContext->retireStructTypes(*pKernelModule);
     CDriverInfoOCLNEO driverInfoOCL;
     IGC::CDriverInfo* driverInfo = &driverInfoOCL;
     
@@ -632,7 +656,7 @@ bool TranslateBuild(
 
     /// set retry manager
     bool retry = false;
-    oclContext.m_retryManager.Enable();
+    oclContext.m_retryManager.Enable(oclContext.getRegKeys());
     do
     {
         std::unique_ptr<llvm::Module> BuiltinGenericModule = nullptr;
@@ -660,57 +684,89 @@ bool TranslateBuild(
 			// when linking M1 into M0 (M0 : dstModule, M1 : srcModule), the final type is the type
 			// used in M0.
 
-			// Load the builtin module -  Generic BC
+			// Load the pre-lowered builtin module if the build provides one. It holds the generic
+			// and the pointer size builtins already linked and cleaned up, so there is no size module.
+			if (IGC_IS_FLAG_ENABLED(EnablePreloweredBiF))
 			{
-				char Resource[5] = { '-' };
-				_snprintf(Resource, sizeof(Resource), "#%d", OCL_BC);
-
-				pGenericBuffer.reset(llvm::LoadBufferFromResource(Resource, "BC"));
-				assert(pGenericBuffer && "Error loading the Generic builtin resource");
-
-				llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-					getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), toLLVMContext(oclContext));
-				if (llvm::Error EC = ModuleOrErr.takeError())
-					assert(0 && "Error lazily loading bitcode for generic builtins");
-				else
-					BuiltinGenericModule = std::move(*ModuleOrErr);
+				char ResNumber[5] = { '-' };
+				_snprintf(ResNumber, sizeof(ResNumber), "#%d",
+					(PtrSzInBits == 32) ? OCL_BC_PRELOWERED_32 : OCL_BC_PRELOWERED_64);
 
-				assert(BuiltinGenericModule &&
-					"Error loading the Generic builtin module from buffer");
+				pGenericBuffer = GetBuiltinResource(ResNumber);
+				if (pGenericBuffer)
+				{
+					llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+						getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), toLLVMContext(oclContext));
+					if (llvm::Error EC = ModuleOrErr.takeError())
+						llvm::consumeError(std::move(EC));
+					else
+						BuiltinGenericModule = std::move(*ModuleOrErr);
+				}
 			}
 
-			// Load the builtin module -  pointer depended
+			if (!BuiltinGenericModule)
 			{
-				char ResNumber[5] = { '-' };
-				switch (PtrSzInBits)
+				// Load the builtin module -  Generic BC
 				{
-				case 32:
-					_snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_32);
-					break;
-				case 64:
-					_snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_64);
-					break;
-				default:
-					assert(0 && "Unknown bitness of compiled module");
-				}
+					char Resource[5] = { '-' };
+					_snprintf(Resource, sizeof(Resource), "#%d", OCL_BC);
 
-				// the MemoryBuffer becomes owned by the module and does not need to be managed
-				pSizeTBuffer.reset(llvm::LoadBufferFromResource(ResNumber, "BC"));
-				assert(pSizeTBuffer && "Error loading builtin resource");
+					pGenericBuffer = GetBuiltinResource(Resource);
+					assert(pGenericBuffer && "Error loading the Generic builtin resource");
 
-				llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-					getLazyBitcodeModule(pSizeTBuffer->getMemBufferRef(), toLLVMContext(oclContext));
-				if (llvm::Error EC = ModuleOrErr.takeError())
-					assert(0 && "Error lazily loading bitcode for size_t builtins");
-				else
-					BuiltinSizeModule = std::move(*ModuleOrErr);
+					llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+						getLazyBitcodeModule(pGenericBuffer->getMemBufferRef(), toLLVMContext(oclContext));
+					if (llvm::Error EC = ModuleOrErr.takeError())
+						assert(0 && "Error lazily loading bitcode for generic builtins");
+					else
+						BuiltinGenericModule = std::move(*ModuleOrErr);
 
-				assert(BuiltinSizeModule
-					&& "Error loading builtin module from buffer");
+					assert(BuiltinGenericModule &&
+						"Error loading the Generic builtin module from buffer");
+				}
+
+				// Load the builtin module -  pointer depended
+				{
+					char ResNumber[5] = { '-' };
+					switch (PtrSzInBits)
+					{
+					case 32:
+						_snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_32);
+						break;
+					case 64:
+						_snprintf(ResNumber, sizeof(ResNumber), "#%d", OCL_BC_64);
+						break;
+					default:
+						assert(0 && "Unknown bitness of compiled module");
+					}
+
+					pSizeTBuffer = GetBuiltinResource(ResNumber);
+					assert(pSizeTBuffer && "Error loading builtin resource");
+
+					llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+						getLazyBitcodeModule(pSizeTBuffer->getMemBufferRef(), toLLVMContext(oclContext));
+					if (llvm::Error EC = ModuleOrErr.takeError())
+						assert(0 && "Error lazily loading bitcode for size_t builtins");
+					else
+						BuiltinSizeModule = std::move(*ModuleOrErr);
+
+					assert(BuiltinSizeModule
+						&& "Error loading builtin module from buffer");
+				}
+
+				BuiltinGenericModule->setDataLayout(BuiltinSizeModule->getDataLayout());
+				BuiltinGenericModule->setTargetTriple(BuiltinSizeModule->getTargetTriple());
 			}
 
-			BuiltinGenericModule->setDataLayout(BuiltinSizeModule->getDataLayout());
-			BuiltinGenericModule->setTargetTriple(BuiltinSizeModule->getTargetTriple());
+			// The builtin modules are consumed by linking, remember their types
+			// while they are still around in case the context is reused.
+			for (llvm::Module* pBuiltinModule : { BuiltinGenericModule.get(), BuiltinSizeModule.get() })
+			{
+				if (pBuiltinModule)
+				{
+					oclContext.getLLVMContextWrapper()->retireStructTypes(*pBuiltinModule);
+				}
+			}
 		}
 
         if (llvm::StringRef(oclContext.getModule()->getTargetTriple()).startswith("spir"))
@@ -741,6 +797,15 @@ bool TranslateBuild(
             oclContext.m_floatDenormMode32 = FLOAT_DENORM_FLUSH_TO_ZERO;
         }
 
+        // Find the kernels that did not change since an earlier build, code
+        // generation reuses their binaries.
+        if (oclContext.m_retryManager.IsFirstTry() &&
+            IGC_IS_FLAG_ENABLED(EnableKernelBinaryCache) &&
+            !GTPIN_IGC_OCL_IsEnabled())
+        {
+            IGC::LookupCachedKernels(&oclContext, pInputArgs);
+        }
+
         // Optimize the IR. This happens once for each program, not per-kernel.
         IGC::OptimizeIR(&oclContext);
 
@@ -755,7 +820,7 @@ bool TranslateBuild(
             oclContext.clear();
 
             // Create a new LLVMContext
-            oclContext.initLLVMContextWrapper();
+            oclContext.initLLVMContextWrapper(LLVMContextPool::acquire());
 			
 			IGC::Debug::RegisterComputeErrHandlers(toLLVMContext(oclContext));
 
@@ -763,6 +828,7 @@ bool TranslateBuild(
             {
                 return false;
             }
+            oclContext.getLLVMContextWrapper()->retireStructTypes(*pKernelModule);
             oclContext.setModule(pKernelModule);
         }
     } while (retry);
@@ -823,6 +889,11 @@ bool TranslateBuild(
 
     COMPILER_TIME_PRINT(&oclContext, ShaderType::OPENCL_SHADER, oclContext.hash);
 
+    if (oclContext.m_passProfile)
+    {
+        oclContext.m_passProfile->print(ShaderType::OPENCL_SHADER, oclContext.hash);
+    }
+
     COMPILER_TIME_DEL(&oclContext, m_compilerTimeStats);
 
     return true;
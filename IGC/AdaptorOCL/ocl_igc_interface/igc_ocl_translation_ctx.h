@@ -27,6 +27,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <cinttypes>
+#include <vector>
 
 #include "cif/builtins/memory/buffer/buffer.h"
 #include "cif/common/id.h"
@@ -66,6 +67,42 @@ protected:
                                                   uint32_t tracingOptionsCount);
 };
 
+CIF_DEFINE_INTERFACE_VER_WITH_COMPATIBILITY(IgcOclTranslationCtx, 2, 1) {
+  CIF_INHERIT_CONSTRUCTOR();
+
+  // Translates count programs over the device context's worker pool. options
+  // and internalOptions may be null, otherwise they hold count entries (each
+  // of which may be null). Returns one output per program, in input order;
+  // an output is null only if it could not be allocated.
+  template <typename OclTranslationOutputInterface = OclTranslationOutputTagOCL>
+  std::vector<CIF::RAII::UPtr_t<OclTranslationOutputInterface>> TranslateBatch(uint32_t count,
+                                                                              CIF::Builtins::BufferSimple **src,
+                                                                              CIF::Builtins::BufferSimple **options,
+                                                                              CIF::Builtins::BufferSimple **internalOptions,
+                                                                              CIF::Builtins::BufferSimple *tracingOptions,
+                                                                              uint32_t tracingOptionsCount) {
+      std::vector<OclTranslationOutputBase *> outputs(count, nullptr);
+      TranslateBatchImpl(OclTranslationOutputInterface::GetVersion(), count, src, options, internalOptions,
+                         tracingOptions, tracingOptionsCount, outputs.data());
+      std::vector<CIF::RAII::UPtr_t<OclTranslationOutputInterface>> ret;
+      ret.reserve(count);
+      for(auto output : outputs){
+          ret.push_back(CIF::RAII::Pack<OclTranslationOutputInterface>(output));
+      }
+      return ret;
+  }
+
+protected:
+  virtual void TranslateBatchImpl(CIF::Version_t outVersion,
+                                  uint32_t count,
+                                  CIF::Builtins::BufferSimple **src,
+                                  CIF::Builtins::BufferSimple **options,
+                                  CIF::Builtins::BufferSimple **internalOptions,
+                                  CIF::Builtins::BufferSimple *tracingOptions,
+                                  uint32_t tracingOptionsCount,
+                                  OclTranslationOutputBase **outputs);
+};
+
 CIF_GENERATE_VERSIONS_LIST_AND_DECLARE_INTERFACE_DEPENDENCIES(IgcOclTranslationCtx, IGC::OclTranslationOutput, CIF::Builtins::Buffer);
 CIF_MARK_LATEST_VERSION(IgcOclTranslationCtxLatest, IgcOclTranslationCtx);
 using IgcOclTranslationCtxTagOCL = IgcOclTranslationCtxLatest; // Note : can tag with different version for
@@ -34,6 +34,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "cif/export/library_api.h"
 
+#include <algorithm>
+
 #include "cif/macros/enable.h"
 
 namespace IGC {
@@ -60,6 +62,89 @@ IgcOclTranslationCtxBase *CIF_GET_INTERFACE_CLASS(IgcOclDeviceCtx, 1)::CreateTra
     return CIF_GET_PIMPL()->CreateTranslationCtx(ver, inType, outType);
 }
 
+TranslationWorkerPool::~TranslationWorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        shutdown = true;
+    }
+    jobQueued.notify_all();
+    for(auto &worker : workers){
+        worker.join();
+    }
+}
+
+void TranslationWorkerPool::ParallelFor(uint32_t count, unsigned int numThreads, const std::function<void(uint32_t)> &body)
+{
+    if(numThreads == 0){
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    if((count <= 1) || (numThreads <= 1)){
+        for(uint32_t i = 0; i < count; ++i){
+            body(i);
+        }
+        return;
+    }
+
+    Job job(count, body);
+    {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        // the calling thread is one of the numThreads
+        while(workers.size() + 1 < numThreads){
+            workers.emplace_back(&TranslationWorkerPool::WorkerMain, this);
+        }
+        jobs.push_back(&job);
+    }
+    jobQueued.notify_all();
+
+    Run(job);
+
+    std::unique_lock<std::mutex> lock{this->mutex};
+    jobDone.wait(lock, [&job](){ return (job.finished == job.count) && (job.helpers == 0); });
+    auto it = std::find(jobs.begin(), jobs.end(), &job);
+    if(it != jobs.end()){
+        jobs.erase(it);
+    }
+}
+
+void TranslationWorkerPool::Run(Job &job)
+{
+    for(uint32_t i = job.next++; i < job.count; i = job.next++){
+        job.body(i);
+
+        std::lock_guard<std::mutex> lock{this->mutex};
+        if(++job.finished == job.count){
+            jobDone.notify_all();
+        }
+    }
+}
+
+void TranslationWorkerPool::WorkerMain()
+{
+    std::unique_lock<std::mutex> lock{this->mutex};
+    while(true){
+        jobQueued.wait(lock, [this](){ return shutdown || (jobs.empty() == false); });
+        if(shutdown){
+            return;
+        }
+
+        Job *job = jobs.front();
+        if(job->next >= job->count){
+            // all items are taken, the owner removes it once they are done
+            jobs.pop_front();
+            continue;
+        }
+
+        ++job->helpers;
+        lock.unlock();
+        Run(*job);
+        lock.lock();
+        if(--job->helpers == 0){
+            jobDone.notify_all();
+        }
+    }
+}
+
 IgcOclTranslationCtxBase *CIF_PIMPL(IgcOclDeviceCtx)::CreateTranslationCtx(CIF::Version_t version, CodeType::CodeType_t inType, CodeType::CodeType_t outType)
 {
     if(false == CIF_PIMPL(IgcOclTranslationCtx)::SupportsTranslation(inType, outType)){
@@ -28,7 +28,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "ocl_igc_interface/igc_ocl_device_ctx.h"
 
+#include<atomic>
+#include<condition_variable>
+#include<deque>
+#include<functional>
 #include<mutex>
+#include<thread>
+#include<vector>
 
 #include "cif/common/cif.h"
 #include "cif/export/cif_main_impl.h"
@@ -47,6 +53,45 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 namespace IGC
 {
 
+// Persistent worker threads shared by all batched translations of a device
+// context. Threads are started on first use and live as long as the context,
+// so per-thread compiler state survives between programs.
+class TranslationWorkerPool
+{
+public:
+    TranslationWorkerPool() = default;
+    TranslationWorkerPool(const TranslationWorkerPool &) = delete;
+    TranslationWorkerPool &operator=(const TranslationWorkerPool &) = delete;
+    ~TranslationWorkerPool();
+
+    // Runs body(0), ..., body(count - 1) on up to numThreads threads (0 means
+    // one per hardware thread), including the calling thread. Returns once all
+    // of them are done. Concurrent callers share the workers.
+    void ParallelFor(uint32_t count, unsigned int numThreads, const std::function<void(uint32_t)> &body);
+
+protected:
+    struct Job
+    {
+        Job(uint32_t count, const std::function<void(uint32_t)> &body) : count(count), body(body) {}
+
+        const uint32_t count;
+        const std::function<void(uint32_t)> &body;
+        std::atomic<uint32_t> next{0};
+        uint32_t finished = 0; // guarded by mutex
+        uint32_t helpers = 0;  // workers currently running items, guarded by mutex
+    };
+
+    void Run(Job &job);
+    void WorkerMain();
+
+    std::mutex                mutex;
+    std::condition_variable   jobQueued;
+    std::condition_variable   jobDone;
+    std::deque<Job *>         jobs;
+    std::vector<std::thread>  workers;
+    bool                      shutdown = false;
+};
+
 CIF_DECLARE_INTERFACE_PIMPL(IgcOclDeviceCtx) : CIF::PimplBase
 {
     CIF_PIMPL_DECLARE_CONSTRUCTOR(CIF::Version_t version, CIF::ICIF *parentInterface)
@@ -113,12 +158,18 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclDeviceCtx) : CIF::PimplBase
         return *igcPlatform;
     }
 
+    TranslationWorkerPool & GetTranslationWorkerPool()
+    {
+        return translationWorkers;
+    }
+
 protected:
     std::mutex                                   mutex;
     CIF::Multiversion<Platform>                  platform;
     CIF::Multiversion<GTSystemInfo>              gtSystemInfo;
     CIF::Multiversion<IgcFeaturesAndWorkarounds> igcFeaturesAndWorkarounds;
     std::unique_ptr<IGC::CPlatform>              igcPlatform;
+    TranslationWorkerPool                        translationWorkers;
 };
 
 CIF_DEFINE_INTERFACE_TO_PIMPL_FORWARDING_CTOR_DTOR(IgcOclDeviceCtx);
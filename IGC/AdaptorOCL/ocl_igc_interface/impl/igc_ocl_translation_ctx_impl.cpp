@@ -41,6 +41,18 @@ OclTranslationOutputBase *CIF_GET_INTERFACE_CLASS(IgcOclTranslationCtx, 1)::Tran
     return CIF_GET_PIMPL()->Translate(outVersion, src, options, internalOptions, tracingOptions, tracingOptionsCount);
 }
 
+void CIF_GET_INTERFACE_CLASS(IgcOclTranslationCtx, 2)::TranslateBatchImpl(
+                                                 CIF::Version_t outVersion,
+                                                 uint32_t count,
+                                                 CIF::Builtins::BufferSimple **src,
+                                                 CIF::Builtins::BufferSimple **options,
+                                                 CIF::Builtins::BufferSimple **internalOptions,
+                                                 CIF::Builtins::BufferSimple *tracingOptions,
+                                                 uint32_t tracingOptionsCount,
+                                                 OclTranslationOutputBase **outputs) {
+    CIF_GET_PIMPL()->TranslateBatch(outVersion, count, src, options, internalOptions, tracingOptions, tracingOptionsCount, outputs);
+}
+
 }
 
 #include "cif/macros/disable.h"
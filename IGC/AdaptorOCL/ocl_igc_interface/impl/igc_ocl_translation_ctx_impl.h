@@ -114,6 +114,50 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
                                         CIF::Builtins::BufferSimple *tracingOptions,
                                         uint32_t tracingOptionsCount
                                         ) const{
+        LoadRegistryKeys();
+
+        IGC::CPlatform igcPlatform = this->globalState.GetIgcCPlatform();
+        return Translate(outVersion, src, options, internalOptions, tracingOptions, tracingOptionsCount, igcPlatform);
+    }
+
+    void TranslateBatch(CIF::Version_t outVersion,
+                        uint32_t count,
+                        CIF::Builtins::BufferSimple **src,
+                        CIF::Builtins::BufferSimple **options,
+                        CIF::Builtins::BufferSimple **internalOptions,
+                        CIF::Builtins::BufferSimple *tracingOptions,
+                        uint32_t tracingOptionsCount,
+                        OclTranslationOutputBase **outputs
+                        ) const{
+        if((count == 0) || (src == nullptr) || (outputs == nullptr)){
+            return;
+        }
+
+        LoadRegistryKeys();
+
+        // platform and WA tables are set up once and shared by the whole batch
+        const IGC::CPlatform &igcPlatform = this->globalState.GetIgcCPlatform();
+        unsigned int numThreads = IGC_GET_FLAG_VALUE(BatchTranslationThreads);
+        this->globalState.GetTranslationWorkerPool().ParallelFor(count, numThreads, [&](uint32_t i){
+            outputs[i] = Translate(outVersion,
+                                   src[i],
+                                   (options != nullptr) ? options[i] : nullptr,
+                                   (internalOptions != nullptr) ? internalOptions[i] : nullptr,
+                                   tracingOptions,
+                                   tracingOptionsCount,
+                                   igcPlatform);
+        });
+    }
+
+protected:
+    OclTranslationOutputBase *Translate(CIF::Version_t outVersion,
+                                        CIF::Builtins::BufferSimple *src,
+                                        CIF::Builtins::BufferSimple *options,
+                                        CIF::Builtins::BufferSimple *internalOptions,
+                                        CIF::Builtins::BufferSimple *tracingOptions,
+                                        uint32_t tracingOptionsCount,
+                                        const IGC::CPlatform &igcPlatform
+                                        ) const{
         // Create interface for return data
         auto outputInterface = CIF::RAII::UPtr(CIF::InterfaceCreator<OclTranslationOutput>::CreateInterfaceVer(outVersion, this->outType));
         if(outputInterface == nullptr){
@@ -137,8 +181,7 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
             inputArgs.pTracingOptions = tracingOptions->GetMemoryRawWriteable();
         }
         inputArgs.TracingOptionsCount = tracingOptionsCount;
-     
-        IGC::CPlatform igcPlatform = this->globalState.GetIgcCPlatform();
+
         CIF::Sanity::NotNullOrAbort(this->globalState.GetPlatformImpl());
         auto platform = this->globalState.GetPlatformImpl()->p;
 
@@ -148,8 +191,6 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
         TC::STB_TranslateOutputArgs output;
         CIF::SafeZeroOut(output);
 
-        LoadRegistryKeys();
-
         bool success = false;
         if (this->inType == CodeType::elf)
         {
@@ -203,8 +244,7 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
 
         return outputInterface.release();
     }
-    
-protected:
+
     CIF_PIMPL(IgcOclDeviceCtx) &globalState;
     CodeType::CodeType_t inType;
     CodeType::CodeType_t outType;
@@ -0,0 +1,215 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Allocation-heavy compile workload used to compare the custom memory
+// allocator (common/allocator.cpp) with the C runtime allocator. The same
+// source is built twice: AllocatorBenchmark_cma links allocator.cpp with
+// IGC_CUSTOM_MEM_ALLOCATOR so CMA replaces operator new/delete, and
+// AllocatorBenchmark_malloc uses the default operators.
+//
+// Usage: AllocatorBenchmark_{cma,malloc} [threads] [iterations]
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Pass.h>
+#include <llvm/Transforms/Scalar.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include "visaBuilder_interface.h"
+#include "visa_wa.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    const unsigned NumBlocks = 64;
+    const unsigned InstsPerBlock = 64;
+    const unsigned NumVISAInsts = 20000;
+
+    // Builds a function with NumBlocks blocks of redundant float arithmetic
+    // and runs a few scalar cleanups over it, so the workload allocates and
+    // frees many small IR objects the way IGC's own pass pipeline does.
+    void RunLLVMWorkload()
+    {
+        llvm::LLVMContext context;
+        std::unique_ptr<llvm::Module> module(new llvm::Module("bench", context));
+
+        llvm::Type* floatTy = llvm::Type::getFloatTy(context);
+        std::vector<llvm::Type*> argTys(4, floatTy);
+        llvm::FunctionType* funcTy = llvm::FunctionType::get(floatTy, argTys, false);
+        llvm::Function* func = llvm::Function::Create(
+            funcTy, llvm::GlobalValue::ExternalLinkage, "kernel", module.get());
+
+        std::vector<llvm::Value*> values;
+        for (auto& arg : func->args())
+        {
+            values.push_back(&arg);
+        }
+
+        llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", func));
+        for (unsigned b = 0; b < NumBlocks; b++)
+        {
+            for (unsigned i = 0; i < InstsPerBlock; i++)
+            {
+                llvm::Value* lhs = values[values.size() - 1 - (i % 4)];
+                llvm::Value* rhs = values[values.size() - 1 - ((i + 1) % 4)];
+                // Every other value is computed twice for EarlyCSE to remove
+                llvm::Value* v = (i % 2) ? builder.CreateFAdd(lhs, rhs) : builder.CreateFMul(lhs, rhs);
+                if (i % 2)
+                {
+                    builder.CreateFAdd(lhs, rhs);
+                }
+                values.push_back(v);
+            }
+            llvm::BasicBlock* next = llvm::BasicBlock::Create(context, "bb", func);
+            builder.CreateBr(next);
+            builder.SetInsertPoint(next);
+        }
+        builder.CreateRet(values.back());
+
+        llvm::legacy::FunctionPassManager passes(module.get());
+        passes.add(llvm::createSROAPass());
+        passes.add(llvm::createEarlyCSEPass());
+        passes.add(llvm::createReassociatePass());
+        passes.add(llvm::createCFGSimplificationPass());
+        passes.add(llvm::createDeadCodeEliminationPass());
+        passes.doInitialization();
+        passes.run(*func);
+        passes.doFinalization();
+    }
+
+    // Constructs (but does not compile) a vISA kernel through the builder
+    // API, which creates the G4 IR for every appended instruction.
+    bool RunVISAWorkload()
+    {
+        VISA_WA_TABLE waTable;
+        memset(&waTable, 0, sizeof(waTable));
+
+        VISABuilder* builder = nullptr;
+        if (CreateVISABuilder(builder, vISA_3D, CM_CISA_BUILDER_GEN, GENX_SKL, 0, nullptr, &waTable) != 0)
+        {
+            return false;
+        }
+
+        VISAKernel* kernel = nullptr;
+        builder->AddKernel(kernel, "bench");
+
+        const unsigned numVars = 64;
+        std::vector<VISA_GenVar*> vars(numVars);
+        for (unsigned i = 0; i < numVars; i++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "V%u", i);
+            kernel->CreateVISAGenVar(vars[i], name, 16, ISA_TYPE_F, ALIGN_GRF);
+        }
+
+        for (unsigned i = 0; i < NumVISAInsts; i++)
+        {
+            VISA_VectorOpnd* dst = nullptr;
+            VISA_VectorOpnd* src0 = nullptr;
+            VISA_VectorOpnd* src1 = nullptr;
+            kernel->CreateVISADstOperand(dst, vars[i % numVars], 1, 0, 0);
+            kernel->CreateVISASrcOperand(src0, vars[(i + 1) % numVars], MODIFIER_NONE, 8, 8, 1, 0, 0);
+            kernel->CreateVISASrcOperand(src1, vars[(i + 7) % numVars], MODIFIER_NONE, 8, 8, 1, 0, 0);
+            kernel->AppendVISAArithmeticInst((i % 2) ? ISA_ADD : ISA_MUL, nullptr, false,
+                vISA_EMASK_M1, EXEC_SIZE_16, dst, src0, src1);
+        }
+
+        DestroyVISABuilder(builder);
+        return true;
+    }
+
+    double ElapsedSeconds(std::chrono::steady_clock::time_point start)
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned numThreads = (argc > 1) ? (unsigned)atoi(argv[1]) : 8;
+    const unsigned iterations = (argc > 2) ? (unsigned)atoi(argv[2]) : 20;
+
+#if defined(IGC_CUSTOM_MEM_ALLOCATOR)
+    printf("Allocator: CMA\n");
+#else
+    printf("Allocator: default\n");
+#endif
+
+    // Independent compiles on every thread, as in a compile farm worker
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < numThreads; t++)
+    {
+        threads.emplace_back([iterations]() {
+            for (unsigned i = 0; i < iterations; i++)
+            {
+                RunLLVMWorkload();
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    printf("LLVM IR + passes:   %8.3f s (%u threads x %u)\n", ElapsedSeconds(start), numThreads, iterations);
+
+    // The vISA builder keeps process-wide state, so it runs on one thread.
+    start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        if (!RunVISAWorkload())
+        {
+            fprintf(stderr, "Failed to create the vISA builder\n");
+            return 1;
+        }
+    }
+    printf("vISA IR building:   %8.3f s (%u kernels)\n", ElapsedSeconds(start), iterations);
+
+#if !defined(_WIN32)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("Peak RSS:           %8ld KB\n", (long)usage.ru_maxrss);
+#endif
+
+    return 0;
+}
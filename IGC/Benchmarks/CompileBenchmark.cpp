@@ -0,0 +1,894 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Corpus-level compile-time and code-quality benchmark. Every input in the
+// corpus directory is compiled for one platform through the IGC library the
+// OpenCL runtime loads:
+//   .spv, .bc, .ll   TranslateBuild, via the translation block interface
+//   .isa             vISA JITCompile, once per kernel in the file
+// For each input it reports the compile time, the peak RSS, the number of
+// kernels, Gen instructions, spill/fill information and the smallest SIMD
+// width chosen, writes them as CSV and optionally diffs them against a
+// baseline CSV written by an earlier run. Build options for an OCL input are
+// read from <input>.options when that file exists.
+//
+// On Linux every input is compiled in a forked child, so the peak RSS and
+// the cold compile time belong to that input alone. Elsewhere inputs are
+// compiled in-process and the peak RSS is that of the whole run so far.
+//
+// Usage: CompileBenchmark <corpus directory> [-platform bdw|chv|skl|kbl|bxt|glk|cnl]
+//            [-igc <IGC library>] [-options <OCL build options>]
+//            [-visa-options <JITCompile options>] [-repeat <n>] [-o <results.csv>]
+//            [-baseline <baseline.csv>] [-time-threshold <%>] [-rss-threshold <%>]
+//            [-inst-threshold <%>]
+// The exit code is 1 when a metric regressed past its threshold.
+
+#include "AdaptorOCL/TranslationBlock.h"
+#include "AdaptorOCL/GlobalData.h"
+#include "AdaptorOCL/ocl_igc_shared/executable_format/patch_shared.h"
+#include "JitterDataStruct.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Exported by the IGC library, see TranslationBlock.h and RT_Jitter_Interface.h
+    typedef TC::CTranslationBlock* (*CreateFn)(TC::STB_CreateArgs*);
+    typedef void (*DeleteFn)(TC::CTranslationBlock*);
+    typedef int (*JITCompileFn)(const char*, const void*, unsigned int, void*&, unsigned int&,
+        const char*, int, int, int, const char*[], char*, FINALIZER_INFO*);
+    typedef void (*FreeBlockFn)(void*);
+
+    struct PlatformDesc
+    {
+        const char*     name;
+        PRODUCT_FAMILY  product;
+        GFXCORE_FAMILY  core;
+        const char*     visaName;
+        unsigned        euCount;
+        unsigned        threadsPerEU;
+        unsigned        subSliceCount;
+    };
+
+    // GT2 configurations
+    const PlatformDesc Platforms[] =
+    {
+        { "bdw", IGFX_BROADWELL,   IGFX_GEN8_CORE,  "BDW", 24, 7, 3 },
+        { "chv", IGFX_CHERRYVIEW,  IGFX_GEN8_CORE,  "CHV", 16, 7, 2 },
+        { "skl", IGFX_SKYLAKE,     IGFX_GEN9_CORE,  "SKL", 24, 7, 3 },
+        { "kbl", IGFX_KABYLAKE,    IGFX_GEN9_CORE,  "SKL", 24, 7, 3 },
+        { "bxt", IGFX_BROXTON,     IGFX_GEN9_CORE,  "BXT", 18, 6, 3 },
+        { "glk", IGFX_GEMINILAKE,  IGFX_GEN9_CORE,  "BXT", 18, 6, 3 },
+        { "cnl", IGFX_CANNONLAKE,  IGFX_GEN10_CORE, "CNL", 24, 7, 3 },
+    };
+
+    struct Settings
+    {
+        std::string corpus;
+        const PlatformDesc* platform = &Platforms[2];
+        std::string library;
+        std::string options;
+        std::vector<std::string> visaOptions;
+        unsigned repeat = 3;
+        std::string output;
+        std::string baseline;
+        double timeThreshold = 10.0;
+        double rssThreshold = 10.0;
+        double instThreshold = 0.0;
+    };
+
+    enum class InputKind
+    {
+        SPIRV,
+        LLVMBinary,
+        LLVMText,
+        VISA,
+        Unsupported,
+    };
+
+    // Plain data, so a forked child can send it back through a pipe
+    struct Result
+    {
+        bool        ok;
+        unsigned    kernels;
+        unsigned    simd;           //!< Smallest SIMD width over the kernels, 0 if unknown
+        unsigned    insts;
+        int         spillFills;     //!< Weighted spill/fill count, -1 if unknown
+        unsigned    spillBytes;     //!< Per thread spill space
+        double      coldMs;         //!< First compile
+        double      timeMs;         //!< Fastest compile
+        long        peakRssKB;
+        char        error[256];
+    };
+
+    struct Library
+    {
+        CreateFn        create = nullptr;
+        DeleteFn        destroy = nullptr;
+        JITCompileFn    jitCompile = nullptr;
+        FreeBlockFn     freeBlock = nullptr;
+    };
+
+    InputKind GetInputKind(llvm::StringRef path)
+    {
+        llvm::StringRef ext = llvm::sys::path::extension(path);
+        if (ext == ".spv")
+        {
+            return InputKind::SPIRV;
+        }
+        if (ext == ".bc")
+        {
+            return InputKind::LLVMBinary;
+        }
+        if (ext == ".ll")
+        {
+            return InputKind::LLVMText;
+        }
+        if (ext == ".isa")
+        {
+            return InputKind::VISA;
+        }
+        return InputKind::Unsupported;
+    }
+
+    void SetError(Result& result, const std::string& error)
+    {
+        result.ok = false;
+        snprintf(result.error, sizeof(result.error), "%s", error.c_str());
+    }
+
+    std::string ReadOptions(const std::string& path)
+    {
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        if (!buffer)
+        {
+            return "";
+        }
+        std::string options = (*buffer)->getBuffer().str();
+        std::replace(options.begin(), options.end(), '\n', ' ');
+        std::replace(options.begin(), options.end(), '\r', ' ');
+        return options;
+    }
+
+    // Counts the instructions of a Gen kernel heap: bit 29 of the first
+    // dword marks compacted (8 byte) instructions, the others take 16 bytes.
+    unsigned CountGenInstructions(const char* heap, uint32_t size)
+    {
+        unsigned count = 0;
+        for (uint32_t offset = 0; offset + sizeof(uint32_t) <= size; count++)
+        {
+            uint32_t dw0;
+            memcpy(&dw0, heap + offset, sizeof(dw0));
+            offset += (dw0 & (1u << 29)) ? 8 : 16;
+        }
+        return count;
+    }
+
+    // Walks the kernels of an OCL program binary (see CGen8OpenCLProgram::GetProgramBinary)
+    bool ParseProgramBinary(const char* binary, uint32_t size, Result& result)
+    {
+        using namespace iOpenCL;
+
+        if (size < sizeof(SProgramBinaryHeader))
+        {
+            return false;
+        }
+        SProgramBinaryHeader header;
+        memcpy(&header, binary, sizeof(header));
+        if (header.Magic != MAGIC_CL)
+        {
+            return false;
+        }
+
+        uint64_t offset = sizeof(header) + header.PatchListSize;
+        for (uint32_t k = 0; k < header.NumberOfKernels; k++)
+        {
+            SKernelBinaryHeaderCommon kernel;
+            if (offset + sizeof(kernel) > size)
+            {
+                return false;
+            }
+            memcpy(&kernel, binary + offset, sizeof(kernel));
+            uint64_t heapOffset = offset + sizeof(kernel) + kernel.KernelNameSize;
+            uint64_t patchOffset = heapOffset + kernel.KernelHeapSize + kernel.GeneralStateHeapSize +
+                kernel.DynamicStateHeapSize + kernel.SurfaceStateHeapSize;
+            uint64_t end = patchOffset + kernel.PatchListSize;
+            if (end > size || kernel.KernelUnpaddedSize > kernel.KernelHeapSize)
+            {
+                return false;
+            }
+
+            result.kernels++;
+            result.insts += CountGenInstructions(binary + heapOffset, kernel.KernelUnpaddedSize);
+
+            unsigned simd = 0;
+            bool usesSpillFill = false;
+            unsigned scratchSpace = 0;
+            while (patchOffset + sizeof(SPatchItemHeader) <= end)
+            {
+                SPatchItemHeader item;
+                memcpy(&item, binary + patchOffset, sizeof(item));
+                if (item.Size < sizeof(item) || patchOffset + item.Size > end)
+                {
+                    return false;
+                }
+                if (item.Token == PATCH_TOKEN_EXECUTION_ENVIRONMENT && item.Size >= sizeof(SPatchExecutionEnvironment))
+                {
+                    SPatchExecutionEnvironment env;
+                    memcpy(&env, binary + patchOffset, sizeof(env));
+                    simd = env.LargestCompiledSIMDSize;
+                    usesSpillFill = env.UsesStatelessSpillFill != 0;
+                }
+                else if (item.Token == PATCH_TOKEN_MEDIA_VFE_STATE && item.Size >= sizeof(SPatchMediaVFEState))
+                {
+                    SPatchMediaVFEState vfe;
+                    memcpy(&vfe, binary + patchOffset, sizeof(vfe));
+                    scratchSpace = vfe.PerThreadScratchSpace;
+                }
+                patchOffset += item.Size;
+            }
+
+            // OCL private memory is stateless, so scratch space holds spills
+            if (usesSpillFill)
+            {
+                result.spillBytes += scratchSpace;
+            }
+            if (simd && (!result.simd || simd < result.simd))
+            {
+                result.simd = simd;
+            }
+            offset = end;
+        }
+        return true;
+    }
+
+    // Kernel names of a vISA object file (see processCommonISAHeader)
+    bool ReadVISAKernelNames(const char* isa, size_t size, int& major, int& minor, std::vector<std::string>& names)
+    {
+        size_t pos = 0;
+        auto read = [&](void* dst, size_t bytes) {
+            if (pos + bytes > size)
+            {
+                return false;
+            }
+            memcpy(dst, isa + pos, bytes);
+            pos += bytes;
+            return true;
+        };
+
+        uint32_t magic;
+        uint8_t majorVersion, minorVersion;
+        uint16_t numKernels;
+        if (!read(&magic, 4) || !read(&majorVersion, 1) || !read(&minorVersion, 1) || !read(&numKernels, 2))
+        {
+            return false;
+        }
+        major = majorVersion;
+        minor = minorVersion;
+
+        for (unsigned k = 0; k < numKernels; k++)
+        {
+            uint8_t nameLen;
+            if (!read(&nameLen, 1) || pos + nameLen > size)
+            {
+                return false;
+            }
+            names.push_back(std::string(isa + pos, nameLen));
+            pos += nameLen;
+
+            // offset, size, input offset
+            pos += 3 * sizeof(uint32_t);
+            // variable and function relocation tables
+            for (unsigned table = 0; table < 2; table++)
+            {
+                uint16_t numSyms;
+                if (!read(&numSyms, 2))
+                {
+                    return false;
+                }
+                pos += numSyms * 2 * sizeof(uint16_t);
+            }
+            uint8_t numGenBinaries;
+            if (!read(&numGenBinaries, 1))
+            {
+                return false;
+            }
+            pos += numGenBinaries * (sizeof(uint8_t) + 2 * sizeof(uint32_t));
+        }
+        return true;
+    }
+
+    double ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    void RecordTime(Result& result, unsigned iteration, double ms)
+    {
+        if (iteration == 0)
+        {
+            result.coldMs = ms;
+            result.timeMs = ms;
+        }
+        // The first compile also pays for one-time initialization, keep it apart
+        else if (iteration == 1 || ms < result.timeMs)
+        {
+            result.timeMs = ms;
+        }
+    }
+
+    void CompileOCL(const Library& lib, const Settings& settings, const std::string& path,
+        InputKind kind, const llvm::MemoryBuffer& input, Result& result)
+    {
+        PLATFORM platform;
+        memset(&platform, 0, sizeof(platform));
+        platform.eProductFamily = settings.platform->product;
+        platform.eRenderCoreFamily = settings.platform->core;
+        platform.eDisplayCoreFamily = settings.platform->core;
+
+        SKU_FEATURE_TABLE skuTable;
+        memset(&skuTable, 0, sizeof(skuTable));
+        WA_TABLE waTable;
+        memset(&waTable, 0, sizeof(waTable));
+
+        GT_SYSTEM_INFO sysInfo;
+        memset(&sysInfo, 0, sizeof(sysInfo));
+        sysInfo.EUCount = settings.platform->euCount;
+        sysInfo.ThreadCount = settings.platform->euCount * settings.platform->threadsPerEU;
+        sysInfo.SliceCount = 1;
+        sysInfo.SubSliceCount = settings.platform->subSliceCount;
+        sysInfo.MaxEuPerSubSlice = settings.platform->euCount / settings.platform->subSliceCount;
+        sysInfo.EuCountPerPoolMax = sysInfo.MaxEuPerSubSlice;
+        sysInfo.MaxSlicesSupported = 1;
+        sysInfo.MaxSubSlicesSupported = settings.platform->subSliceCount;
+
+        SGlobalData globalData = { &platform, &skuTable, &waTable, &sysInfo, 83.333f };
+
+        TC::STB_CreateArgs createArgs;
+        createArgs.TranslationCode.Type.Input =
+            (kind == InputKind::SPIRV) ? TC::TB_DATA_FORMAT_SPIR_V :
+            (kind == InputKind::LLVMBinary) ? TC::TB_DATA_FORMAT_LLVM_BINARY : TC::TB_DATA_FORMAT_LLVM_TEXT;
+        createArgs.TranslationCode.Type.Output = TC::TB_DATA_FORMAT_DEVICE_BINARY;
+        createArgs.pCreateData = &globalData;
+
+        TC::CTranslationBlock* translationBlock = lib.create(&createArgs);
+        if (!translationBlock)
+        {
+            SetError(result, "cannot create the translation block");
+            return;
+        }
+
+        std::string options = settings.options + " " + ReadOptions(path + ".options");
+        std::vector<char> source(input.getBufferStart(), input.getBufferEnd());
+        if (kind == InputKind::LLVMText)
+        {
+            source.push_back('\0');
+        }
+
+        for (unsigned i = 0; i < settings.repeat; i++)
+        {
+            TC::STB_TranslateInputArgs inputArgs;
+            inputArgs.pInput = source.data();
+            inputArgs.InputSize = (uint32_t)source.size();
+            inputArgs.pOptions = options.c_str();
+            inputArgs.OptionsSize = (uint32_t)options.size();
+            inputArgs.pInternalOptions = "";
+            inputArgs.InternalOptionsSize = 0;
+
+            TC::STB_TranslateOutputArgs outputArgs;
+            auto start = std::chrono::steady_clock::now();
+            bool success = translationBlock->Translate(&inputArgs, &outputArgs);
+            RecordTime(result, i, ElapsedMs(start));
+
+            if (i == 0)
+            {
+                if (!success)
+                {
+                    SetError(result, (outputArgs.pErrorString && outputArgs.ErrorStringSize) ?
+                        outputArgs.pErrorString : "translation failed");
+                }
+                else if (!ParseProgramBinary(outputArgs.pOutput, outputArgs.OutputSize, result))
+                {
+                    SetError(result, "malformed program binary");
+                }
+            }
+            translationBlock->FreeAllocations(&outputArgs);
+            if (!result.ok)
+            {
+                break;
+            }
+        }
+        lib.destroy(translationBlock);
+    }
+
+    void CompileVISA(const Library& lib, const Settings& settings, const llvm::MemoryBuffer& input, Result& result)
+    {
+        if (!lib.jitCompile || !lib.freeBlock)
+        {
+            SetError(result, "the IGC library does not export JITCompile");
+            return;
+        }
+
+        int major = 0, minor = 0;
+        std::vector<std::string> kernels;
+        if (!ReadVISAKernelNames(input.getBufferStart(), input.getBufferSize(), major, minor, kernels))
+        {
+            SetError(result, "malformed vISA header");
+            return;
+        }
+
+        std::vector<const char*> args;
+        for (auto& option : settings.visaOptions)
+        {
+            args.push_back(option.c_str());
+        }
+
+        for (unsigned i = 0; i < settings.repeat && result.ok; i++)
+        {
+            double ms = 0;
+            for (auto& kernel : kernels)
+            {
+                void* genBinary = nullptr;
+                unsigned int genBinarySize = 0;
+                char errorMsg[MAX_ERROR_MSG_LEN + 1] = {};
+                FINALIZER_INFO jitInfo;
+                memset(&jitInfo, 0, sizeof(jitInfo));
+
+                auto start = std::chrono::steady_clock::now();
+                int status = lib.jitCompile(kernel.c_str(), input.getBufferStart(), (unsigned int)input.getBufferSize(),
+                    genBinary, genBinarySize, settings.platform->visaName, major, minor,
+                    (int)args.size(), args.data(), errorMsg, &jitInfo);
+                ms += ElapsedMs(start);
+
+                if (status != 0)
+                {
+                    SetError(result, kernel + ": " + (errorMsg[0] ? errorMsg : "JITCompile failed"));
+                    break;
+                }
+                if (i == 0)
+                {
+                    result.kernels++;
+                    result.insts += jitInfo.numAsmCount;
+                    result.spillFills = (result.spillFills < 0 ? 0 : result.spillFills) + (int)jitInfo.numGRFSpillFill;
+                    result.spillBytes += jitInfo.isSpill ? jitInfo.spillMemUsed : 0;
+                }
+                lib.freeBlock(genBinary);
+            }
+            RecordTime(result, i, ms);
+        }
+    }
+
+    void Compile(const Library& lib, const Settings& settings, const std::string& path, Result& result)
+    {
+        memset(&result, 0, sizeof(result));
+        result.ok = true;
+        result.spillFills = -1;
+
+        auto input = llvm::MemoryBuffer::getFile(path);
+        if (!input)
+        {
+            SetError(result, "cannot read the input");
+            return;
+        }
+
+        InputKind kind = GetInputKind(path);
+        if (kind == InputKind::VISA)
+        {
+            CompileVISA(lib, settings, **input, result);
+        }
+        else
+        {
+            CompileOCL(lib, settings, path, kind, **input, result);
+        }
+    }
+
+    void Run(const Library& lib, const Settings& settings, const std::string& path, Result& result)
+    {
+#if defined(_WIN32)
+        Compile(lib, settings, path, result);
+        PROCESS_MEMORY_COUNTERS counters;
+        result.peakRssKB = GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ?
+            (long)(counters.PeakWorkingSetSize / 1024) : 0;
+#else
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            Compile(lib, settings, path, result);
+            result.peakRssKB = 0;
+            return;
+        }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            Compile(lib, settings, path, result);
+            ssize_t written = write(fds[1], &result, sizeof(result));
+            _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+        }
+        close(fds[1]);
+
+        memset(&result, 0, sizeof(result));
+        size_t received = 0;
+        while (pid > 0 && received < sizeof(result))
+        {
+            ssize_t n = read(fds[0], (char*)&result + received, sizeof(result) - received);
+            if (n <= 0)
+            {
+                break;
+            }
+            received += n;
+        }
+        close(fds[0]);
+
+        int status = 0;
+        struct rusage usage;
+        memset(&usage, 0, sizeof(usage));
+        if (pid > 0)
+        {
+            wait4(pid, &status, 0, &usage);
+        }
+        if (received != sizeof(result))
+        {
+            memset(&result, 0, sizeof(result));
+            result.spillFills = -1;
+            SetError(result, (pid > 0 && WIFSIGNALED(status)) ?
+                "compiler crashed (signal " + std::to_string(WTERMSIG(status)) + ")" : std::string("compiler process failed"));
+        }
+        result.peakRssKB = usage.ru_maxrss;
+#endif
+    }
+
+    const char* CSVHeader =
+        "input,status,kernels,simd,insts,spill fills,spill bytes,cold time (ms),time (ms),peak rss (KB)";
+
+    void WriteRow(FILE* fp, const std::string& input, const Result& result)
+    {
+        fprintf(fp, "%s,%s,%u,%u,%u,%d,%u,%.3f,%.3f,%ld\n",
+            input.c_str(), result.ok ? "ok" : "failed",
+            result.kernels, result.simd, result.insts, result.spillFills, result.spillBytes,
+            result.coldMs, result.timeMs, result.peakRssKB);
+    }
+
+    bool ReadBaseline(const std::string& fileName, std::map<std::string, Result>& baseline)
+    {
+        auto buffer = llvm::MemoryBuffer::getFile(fileName);
+        if (!buffer)
+        {
+            return false;
+        }
+        std::istringstream stream((*buffer)->getBuffer().str());
+        std::string line;
+        std::getline(stream, line);
+        while (std::getline(stream, line))
+        {
+            std::vector<std::string> fields;
+            std::istringstream lineStream(line);
+            std::string field;
+            while (std::getline(lineStream, field, ','))
+            {
+                fields.push_back(field);
+            }
+            if (fields.size() < 10)
+            {
+                continue;
+            }
+            Result result;
+            memset(&result, 0, sizeof(result));
+            result.ok = fields[1] == "ok";
+            result.kernels = (unsigned)strtoul(fields[2].c_str(), nullptr, 10);
+            result.simd = (unsigned)strtoul(fields[3].c_str(), nullptr, 10);
+            result.insts = (unsigned)strtoul(fields[4].c_str(), nullptr, 10);
+            result.spillFills = atoi(fields[5].c_str());
+            result.spillBytes = (unsigned)strtoul(fields[6].c_str(), nullptr, 10);
+            result.coldMs = atof(fields[7].c_str());
+            result.timeMs = atof(fields[8].c_str());
+            result.peakRssKB = atol(fields[9].c_str());
+            baseline[fields[0]] = result;
+        }
+        return true;
+    }
+
+    bool Exceeds(double value, double base, double thresholdPercent)
+    {
+        return value > base * (1.0 + thresholdPercent / 100.0);
+    }
+
+    // Prints every metric of the input that regressed; returns whether any did.
+    bool Diff(const Settings& settings, const std::string& input, const Result& result, const Result& base)
+    {
+        std::vector<std::string> regressions;
+        char text[256];
+        if (base.ok && !result.ok)
+        {
+            regressions.push_back("now fails");
+        }
+        if (base.ok && result.ok)
+        {
+            if (Exceeds(result.timeMs, base.timeMs, settings.timeThreshold))
+            {
+                snprintf(text, sizeof(text), "time %.3f -> %.3f ms", base.timeMs, result.timeMs);
+                regressions.push_back(text);
+            }
+            if (base.peakRssKB && Exceeds((double)result.peakRssKB, (double)base.peakRssKB, settings.rssThreshold))
+            {
+                snprintf(text, sizeof(text), "peak rss %ld -> %ld KB", base.peakRssKB, result.peakRssKB);
+                regressions.push_back(text);
+            }
+            if (Exceeds(result.insts, base.insts, settings.instThreshold))
+            {
+                snprintf(text, sizeof(text), "insts %u -> %u", base.insts, result.insts);
+                regressions.push_back(text);
+            }
+            if (result.spillFills > base.spillFills || result.spillBytes > base.spillBytes)
+            {
+                snprintf(text, sizeof(text), "spills %d/%u -> %d/%u",
+                    base.spillFills, base.spillBytes, result.spillFills, result.spillBytes);
+                regressions.push_back(text);
+            }
+            if (result.simd < base.simd)
+            {
+                snprintf(text, sizeof(text), "simd %u -> %u", base.simd, result.simd);
+                regressions.push_back(text);
+            }
+        }
+
+        for (auto& regression : regressions)
+        {
+            printf("REGRESSION %s: %s\n", input.c_str(), regression.c_str());
+        }
+        return !regressions.empty();
+    }
+
+    bool ParseArgs(int argc, char* argv[], Settings& settings)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg[0] != '-')
+            {
+                settings.corpus = arg;
+            }
+            else if (!hasValue)
+            {
+                return false;
+            }
+            else if (arg == "-platform")
+            {
+                std::string name = argv[++i];
+                settings.platform = nullptr;
+                for (auto& platform : Platforms)
+                {
+                    if (name == platform.name)
+                    {
+                        settings.platform = &platform;
+                    }
+                }
+                if (!settings.platform)
+                {
+                    return false;
+                }
+            }
+            else if (arg == "-igc")
+            {
+                settings.library = argv[++i];
+            }
+            else if (arg == "-options")
+            {
+                settings.options = argv[++i];
+            }
+            else if (arg == "-visa-options")
+            {
+                std::istringstream options(argv[++i]);
+                std::string option;
+                while (options >> option)
+                {
+                    settings.visaOptions.push_back(option);
+                }
+            }
+            else if (arg == "-repeat")
+            {
+                settings.repeat = std::max(1, atoi(argv[++i]));
+            }
+            else if (arg == "-o")
+            {
+                settings.output = argv[++i];
+            }
+            else if (arg == "-baseline")
+            {
+                settings.baseline = argv[++i];
+            }
+            else if (arg == "-time-threshold")
+            {
+                settings.timeThreshold = atof(argv[++i]);
+            }
+            else if (arg == "-rss-threshold")
+            {
+                settings.rssThreshold = atof(argv[++i]);
+            }
+            else if (arg == "-inst-threshold")
+            {
+                settings.instThreshold = atof(argv[++i]);
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return !settings.corpus.empty();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Settings settings;
+#if defined(IGC_BENCHMARK_DEFAULT_LIBRARY)
+    settings.library = IGC_BENCHMARK_DEFAULT_LIBRARY;
+#endif
+    if (!ParseArgs(argc, argv, settings))
+    {
+        fprintf(stderr, "Usage: %s <corpus directory> [-platform bdw|chv|skl|kbl|bxt|glk|cnl] [-igc <IGC library>]\n"
+            "    [-options <OCL build options>] [-visa-options <JITCompile options>] [-repeat <n>]\n"
+            "    [-o <results.csv>] [-baseline <baseline.csv>] [-time-threshold <%%>] [-rss-threshold <%%>]\n"
+            "    [-inst-threshold <%%>]\n", argv[0]);
+        return 2;
+    }
+
+    std::string error;
+    auto dll = llvm::sys::DynamicLibrary::getPermanentLibrary(settings.library.c_str(), &error);
+    if (!dll.isValid())
+    {
+        fprintf(stderr, "Cannot load %s: %s\n", settings.library.c_str(), error.c_str());
+        return 2;
+    }
+    Library lib;
+    lib.create = (CreateFn)dll.getAddressOfSymbol("Create");
+    lib.destroy = (DeleteFn)dll.getAddressOfSymbol("Delete");
+    lib.jitCompile = (JITCompileFn)dll.getAddressOfSymbol("JITCompile");
+    lib.freeBlock = (FreeBlockFn)dll.getAddressOfSymbol("freeBlock");
+    if (!lib.create || !lib.destroy)
+    {
+        fprintf(stderr, "%s does not export the translation block interface\n", settings.library.c_str());
+        return 2;
+    }
+
+    std::vector<std::string> inputs;
+    std::error_code ec;
+    for (llvm::sys::fs::recursive_directory_iterator it(settings.corpus, ec), end; it != end && !ec; it.increment(ec))
+    {
+        if (llvm::sys::fs::is_regular_file(it->path()) && GetInputKind(it->path()) != InputKind::Unsupported)
+        {
+            inputs.push_back(it->path());
+        }
+    }
+    if (ec)
+    {
+        fprintf(stderr, "Cannot read %s: %s\n", settings.corpus.c_str(), ec.message().c_str());
+        return 2;
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    std::map<std::string, Result> baseline;
+    if (!settings.baseline.empty() && !ReadBaseline(settings.baseline, baseline))
+    {
+        fprintf(stderr, "Cannot read the baseline %s\n", settings.baseline.c_str());
+        return 2;
+    }
+
+    FILE* csv = nullptr;
+    if (!settings.output.empty())
+    {
+        csv = fopen(settings.output.c_str(), "w");
+        if (!csv)
+        {
+            fprintf(stderr, "Cannot write %s\n", settings.output.c_str());
+            return 2;
+        }
+        fprintf(csv, "%s\n", CSVHeader);
+    }
+
+    printf("Platform: %s, inputs: %zu, repeat: %u\n", settings.platform->name, inputs.size(), settings.repeat);
+    printf("%-48s %7s %5s %8s %12s %10s %10s %10s\n",
+        "input", "kernels", "simd", "insts", "spills", "cold (ms)", "time (ms)", "rss (KB)");
+
+    unsigned failures = 0;
+    unsigned regressions = 0;
+    double totalMs = 0;
+    for (auto& path : inputs)
+    {
+        // Rows are keyed by the path relative to the corpus, so a baseline
+        // stays usable when the corpus moves
+        std::string input = path.substr(std::min(path.size(), settings.corpus.size()));
+        input.erase(0, input.find_first_not_of("/\\"));
+
+        Result result;
+        Run(lib, settings, path, result);
+
+        if (result.ok)
+        {
+            char spills[32];
+            snprintf(spills, sizeof(spills), "%d/%u", result.spillFills, result.spillBytes);
+            printf("%-48s %7u %5u %8u %12s %10.3f %10.3f %10ld\n", input.c_str(), result.kernels, result.simd,
+                result.insts, spills, result.coldMs, result.timeMs, result.peakRssKB);
+            totalMs += result.timeMs;
+        }
+        else
+        {
+            printf("%-48s FAILED: %s\n", input.c_str(), result.error);
+            failures++;
+        }
+        if (csv)
+        {
+            WriteRow(csv, input, result);
+        }
+
+        auto base = baseline.find(input);
+        if (base != baseline.end() && Diff(settings, input, result, base->second))
+        {
+            regressions++;
+        }
+    }
+    if (csv)
+    {
+        fclose(csv);
+    }
+
+    printf("Compiled %zu inputs (%u failed) in %.3f ms\n", inputs.size() - failures, failures, totalMs);
+    if (!baseline.empty())
+    {
+        printf("%u of %zu inputs regressed against %s\n", regressions, inputs.size(), settings.baseline.c_str());
+    }
+    return regressions ? 1 : 0;
+}
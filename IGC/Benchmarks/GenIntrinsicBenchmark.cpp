@@ -0,0 +1,152 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// GenISA intrinsic ID queries as issued by CodeGenPatternMatch and EmitPass.
+// Both passes visit every call, dyn_cast it to GenIntrinsicInst and then
+// switch on getIntrinsicID() (pattern matching asks again for each candidate
+// pattern, emission once more to pick the emitter). This replays that query
+// stream over a synthetic kernel and compares the direct-mapped ID cache in
+// LLVMContextWrapper against the llvm::ValueMap cache it replaced.
+//
+// Usage: GenIntrinsicBenchmark [calls per intrinsic] [walks]
+
+#include "Compiler/CodeGenPublic.h"
+#include "GenISAIntrinsics/GenIntrinsics.h"
+#include "GenISAIntrinsics/GenIntrinsicInst.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/ValueMap.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace
+{
+    // The number of queries one call site receives: the pattern match
+    // dispatch, two candidate patterns checking for a specific intrinsic,
+    // and the emitter dispatch.
+    const unsigned QueriesPerCall = 4;
+
+    template <typename Fn>
+    double MeasureNsPerQuery(Function* kernel, unsigned walks, Fn&& getID, unsigned& sink)
+    {
+        unsigned queries = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned walk = 0; walk < walks; walk++)
+        {
+            for (auto& BB : *kernel)
+            {
+                for (auto& I : BB)
+                {
+                    GenIntrinsicInst* GII = dyn_cast<GenIntrinsicInst>(&I);
+                    if (!GII)
+                    {
+                        continue;
+                    }
+                    for (unsigned i = 0; i < QueriesPerCall; i++)
+                    {
+                        sink += getID(GII);
+                    }
+                    queries += QueriesPerCall;
+                }
+            }
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / queries;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const unsigned callsPerIntrinsic = (argc > 1) ? (unsigned)atoi(argv[1]) : 64;
+    const unsigned walks = (argc > 2) ? (unsigned)atoi(argv[2]) : 50;
+
+    IGC::LLVMContextWrapper* context = new IGC::LLVMContextWrapper();
+    context->AddRef();
+    {
+        Module module("GenIntrinsicBenchmark", *context);
+        FunctionType* voidTy = FunctionType::get(Type::getVoidTy(*context), false);
+
+        // One declaration per intrinsic; every other one carries an overload
+        // suffix so the recognizer has to find the prefix.
+        std::vector<Function*> intrinsics;
+        for (unsigned id = GenISAIntrinsic::no_intrinsic + 1; id < GenISAIntrinsic::num_genisa_intrinsics; id++)
+        {
+            std::string name = GenISAIntrinsic::getName(static_cast<GenISAIntrinsic::ID>(id));
+            if (id % 2)
+            {
+                name += ".v4f32";
+            }
+            intrinsics.push_back(Function::Create(voidTy, GlobalValue::ExternalLinkage, name, &module));
+        }
+
+        Function* kernel = Function::Create(voidTy, GlobalValue::ExternalLinkage, "kernel", &module);
+        BasicBlock* BB = BasicBlock::Create(*context, "entry", kernel);
+        for (unsigned i = 0; i < callsPerIntrinsic; i++)
+        {
+            for (Function* F : intrinsics)
+            {
+                CallInst::Create(F, "", BB);
+            }
+        }
+        ReturnInst::Create(*context, BB);
+
+        unsigned sink = 0;
+        auto getID = [](GenIntrinsicInst* GII) { return (unsigned)GII->getIntrinsicID(); };
+
+        // First walk resolves every name once
+        double cold = MeasureNsPerQuery(kernel, 1, getID, sink);
+        double warm = MeasureNsPerQuery(kernel, walks, getID, sink);
+
+        ValueMap<const Function*, unsigned> valueMap;
+        for (Function* F : intrinsics)
+        {
+            valueMap[F] = GenISAIntrinsic::getIntrinsicID(F);
+        }
+        double baseline = MeasureNsPerQuery(kernel, walks, [&valueMap](GenIntrinsicInst* GII) {
+            return valueMap.find(GII->getCalledFunction())->second;
+        }, sink);
+
+        printf("Intrinsics: %zu, calls: %zu, walks: %u\n",
+            intrinsics.size(), intrinsics.size() * callsPerIntrinsic, walks);
+        printf("%-32s %8.2f ns/query\n", "First walk (name lookups)", cold);
+        printf("%-32s %8.2f ns/query\n", "ValueMap cache", baseline);
+        printf("%-32s %8.2f ns/query (%.1fx)\n", "Direct-mapped cache", warm, baseline / warm);
+        printf("(checksum %u)\n", sink);
+    }
+    context->Release();
+    return 0;
+}
@@ -0,0 +1,106 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// Throughput of iSTD::Hash, which AsmHashOCL historically used to hash the
+// whole input module, against iSTD::Hash128 in lanes and legacy mode.
+//
+// Usage: HashBenchmark [size in MB] [repetitions]
+
+#include <iStdLib/utility.h>
+#include <iStdLib/Hash128.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    template <typename Fn>
+    double MeasureMBPerSecond(size_t bytes, unsigned repetitions, Fn&& fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < repetitions; i++)
+        {
+            fn();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return (double)bytes * repetitions / (1024.0 * 1024.0) / elapsed.count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t sizeMB = (argc > 1) ? (size_t)atoi(argv[1]) : 32;
+    const unsigned repetitions = (argc > 2) ? (unsigned)atoi(argv[2]) : 10;
+    const size_t numDwords = sizeMB * 1024 * 1024 / sizeof(DWORD);
+
+    std::vector<DWORD> input(numDwords);
+    std::mt19937 rng(0x428a2f98);
+    for (auto& dw : input)
+    {
+        dw = rng();
+    }
+    const size_t bytes = input.size() * sizeof(DWORD);
+
+    // Keep the results live so the loops are not optimized away
+    volatile QWORD sink = 0;
+
+    double legacy = MeasureMBPerSecond(bytes, repetitions, [&]() {
+        sink = sink + iSTD::Hash(input.data(), (DWORD)input.size());
+    });
+    double legacy128 = MeasureMBPerSecond(bytes, repetitions, [&]() {
+        sink = sink + iSTD::Hash128Buffer(input.data(), bytes, iSTD::Hash128::HASH128_LEGACY).lo;
+    });
+    double lanes = MeasureMBPerSecond(bytes, repetitions, [&]() {
+        sink = sink + iSTD::Hash128Buffer(input.data(), bytes).lo;
+    });
+    // Streaming in 4KB pieces, as done when hashing several inputs into one key
+    double lanesStreaming = MeasureMBPerSecond(bytes, repetitions, [&]() {
+        iSTD::Hash128 hash;
+        const size_t chunk = 4096;
+        const char* data = reinterpret_cast<const char*>(input.data());
+        for (size_t offset = 0; offset < bytes; offset += chunk)
+        {
+            hash.Update(data + offset, (bytes - offset < chunk) ? bytes - offset : chunk);
+        }
+        sink = sink + hash.Final().lo;
+    });
+
+    bool compatible =
+        iSTD::Hash128Buffer(input.data(), bytes, iSTD::Hash128::HASH128_LEGACY).lo ==
+        iSTD::Hash(input.data(), (DWORD)input.size());
+
+    printf("Input: %zu MB x %u\n", sizeMB, repetitions);
+    printf("%-28s %10.1f MB/s\n", "iSTD::Hash", legacy);
+    printf("%-28s %10.1f MB/s\n", "Hash128 legacy", legacy128);
+    printf("%-28s %10.1f MB/s (%.1fx)\n", "Hash128 lanes", lanes, lanes / legacy);
+    printf("%-28s %10.1f MB/s (%.1fx)\n", "Hash128 lanes, 4KB updates", lanesStreaming, lanesStreaming / legacy);
+    printf("Legacy mode matches iSTD::Hash: %s\n", compatible ? "yes" : "NO");
+
+    return compatible ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
+
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CodeGenContextWrapper.hpp"
+#include "Compiler/IGCPassSupport.h"
+#include "common/igc_regkeys.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace IGC;
+
+// Register pass to igc-opt
+#define PASS_FLAG "igc-block-profile"
+#define PASS_DESCRIPTION "Annotate blocks with execution counts from a profile"
+#define PASS_CFG_ONLY true
+#define PASS_ANALYSIS false
+IGC_INITIALIZE_PASS_BEGIN(BlockProfileAnnotation, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_END(BlockProfileAnnotation, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+
+char BlockProfileAnnotation::ID = 0;
+
+static const char *BLOCK_COUNT_MD = "igc.block.count";
+
+BlockProfileAnnotation::BlockProfileAnnotation() : ModulePass(ID)
+{
+    initializeBlockProfileAnnotationPass(*PassRegistry::getPassRegistry());
+}
+
+void BlockProfileAnnotation::getAnalysisUsage(AnalysisUsage &AU) const
+{
+    AU.setPreservesCFG();
+    AU.addRequired<CodeGenContextWrapper>();
+}
+
+bool BlockProfileAnnotation::runOnModule(Module &M)
+{
+    std::ifstream profile(IGC_GET_REGKEYSTRING(BlockProfileFile));
+    if (!profile)
+    {
+        return false;
+    }
+
+    CodeGenContext *ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    uint64_t hash = ctx->hash.getAsmHash();
+
+    // function name -> block index -> count
+    std::map<std::string, std::map<unsigned, uint64_t>> counts;
+    std::string line;
+    while (std::getline(profile, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream record(line);
+        std::string kind, funcName;
+        uint64_t recordHash = 0, count = 0;
+        unsigned block = 0;
+        if (!(record >> kind >> std::hex >> recordHash >> std::dec >> funcName >> block >> count))
+        {
+            continue;
+        }
+        if (kind == "llvm" && recordHash == hash)
+        {
+            counts[funcName][block] = count;
+        }
+    }
+
+    bool changed = false;
+    Type *int64Ty = Type::getInt64Ty(M.getContext());
+    for (auto &F : M)
+    {
+        auto FI = counts.find(F.getName().str());
+        if (F.isDeclaration() || FI == counts.end())
+        {
+            continue;
+        }
+        unsigned index = 0;
+        for (auto &BB : F)
+        {
+            auto BI = FI->second.find(index++);
+            if (BI == FI->second.end())
+            {
+                continue;
+            }
+            Metadata *count = ConstantAsMetadata::get(ConstantInt::get(int64Ty, BI->second));
+            BB.getTerminator()->setMetadata(BLOCK_COUNT_MD, MDNode::get(M.getContext(), count));
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+ModulePass* IGC::createBlockProfileAnnotationPass()
+{
+    return new BlockProfileAnnotation();
+}
+
+bool IGC::isBlockProfileEnabled()
+{
+    const char *path = IGC_GET_REGKEYSTRING(BlockProfileFile);
+    return path != nullptr && path[0] != '\0';
+}
+
+bool IGC::getBlockProfileCount(const BasicBlock *BB, uint64_t &Count)
+{
+    const TerminatorInst *term = BB->getTerminator();
+    MDNode *node = term ? term->getMetadata(BLOCK_COUNT_MD) : nullptr;
+    if (!node)
+    {
+        return false;
+    }
+    Count = mdconst::extract<ConstantInt>(node->getOperand(0))->getZExtValue();
+    return true;
+}
@@ -0,0 +1,73 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include <llvm/IR/BasicBlock.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <cstdint>
+
+namespace IGC
+{
+    /// @brief  Loads a basic-block execution count profile for the current
+    /// shader and attaches the counts to the block terminators. The profile is
+    /// a text file, named by the BlockProfileFile regkey, with one record per
+    /// line:
+    ///
+    ///     <kind> <shader hash> <function> <block> <count>
+    ///
+    /// Records of kind "llvm" are consumed here; <block> is the index of the
+    /// block in the function when this pass runs. Records of kind "gen" are
+    /// consumed by vISA, where <block> is the G4 basic block id. Hashes are
+    /// the assembly hash in hex, as used in shader dump names. Lines starting
+    /// with '#' are ignored.
+    class BlockProfileAnnotation : public llvm::ModulePass
+    {
+    public:
+        static char ID;
+
+        BlockProfileAnnotation();
+
+        virtual llvm::StringRef getPassName() const override
+        {
+            return "BlockProfileAnnotation";
+        }
+
+        virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+
+        virtual bool runOnModule(llvm::Module &M) override;
+    };
+
+    llvm::ModulePass* createBlockProfileAnnotationPass();
+
+    /// Return true if a profile file is configured.
+    bool isBlockProfileEnabled();
+
+    /// Return true and set Count if the block carries a profile count.
+    bool getBlockProfileCount(const llvm::BasicBlock *BB, uint64_t &Count);
+} // namespace IGC
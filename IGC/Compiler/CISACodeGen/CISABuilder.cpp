@@ -24,6 +24,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 #include "Compiler/CISACodeGen/CISABuilder.hpp"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 #include "Compiler/CISACodeGen/PixelShaderCodeGen.hpp"
 #include "Compiler/MetaDataApi/IGCMetaDataDefs.h"
@@ -3431,6 +3432,21 @@ void CEncoder::InitEncoder( bool canAbortOnSpill )
         params.push_back(High);
     }
 
+    if (isBlockProfileEnabled())
+    {
+        // vISA picks the "gen" records of this shader to weight spill costs.
+        // As for VISAOptions above, the strings are not freed.
+        QWORD AssemblyHash = context->hash.getAsmHash();
+        char Value[20];
+        params.push_back("-blockProfile");
+        params.push_back(IGC_GET_REGKEYSTRING(BlockProfileFile));
+        params.push_back("-blockProfileHash");
+        sprintf_s(Value, sizeof(Value), "%d", (DWORD)(AssemblyHash >> 32));
+        params.push_back(_strdup(Value));
+        sprintf_s(Value, sizeof(Value), "%d", (DWORD)AssemblyHash);
+        params.push_back(_strdup(Value));
+    }
+
     SetVISAWaTable(m_program->m_Platform->getWATable());
 
     bool enableVISADump = IGC_IS_FLAG_ENABLED(EnableVISASlowpath) || IGC_IS_FLAG_ENABLED(ShaderDumpEnable);
@@ -4031,6 +4047,22 @@ bool CEncoder::AvoidRetryOnSmallSpill() const
         context->m_retryManager.IsFirstTry();
 }
 
+#if (GET_SHADER_STATS)
+// Record whether the spill prediction made before codegen, if any, matches the
+// actual result of the vISA compilation.
+static void RecordSpillPrediction(CShader* program, bool isSpill)
+{
+    if (!program->m_hasSpillPrediction)
+    {
+        return;
+    }
+    COMPILER_SHADER_STATS_SET(program->m_shaderStats,
+        program->m_spillPredicted == isSpill ? STATS_SIMD_PREDICTION_HIT : STATS_SIMD_PREDICTION_MISS, 1);
+    COMPILER_SHADER_STATS_SET(program->m_shaderStats,
+        STATS_SIMD_PREDICTION_CONFIDENCE, program->m_spillPredictionConfidence);
+}
+#endif
+
 void CEncoder::Compile()
 {
     COMPILER_TIME_START(m_program->GetContext(), TIME_CG_vISAEmitPass);
@@ -4115,6 +4147,7 @@ void CEncoder::Compile()
         {
             COMPILER_SHADER_STATS_SET(m_program->m_shaderStats, STATS_ISA_EARLYEXIT32, 1);
         }
+        RecordSpillPrediction(m_program, true);
 #endif
         return;
     }
@@ -4170,6 +4203,7 @@ void CEncoder::Compile()
         COMPILER_SHADER_STATS_SET(m_program->m_shaderStats, STATS_ISA_INST_COUNT_SIMD32, jitInfo->numAsmCount);
         COMPILER_SHADER_STATS_SET(m_program->m_shaderStats, STATS_ISA_SPILL32, (int)jitInfo->isSpill);
     }
+    RecordSpillPrediction(m_program, jitInfo->isSpill);
 #endif
 
     void* genxbin = nullptr;
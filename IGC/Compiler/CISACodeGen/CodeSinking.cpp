@@ -67,6 +67,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPop.hpp"
 
 #include "Compiler/CodeGenPublic.h"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CISACodeGen/CodeSinking.hpp"
 #include "Compiler/CISACodeGen/helper.h"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
@@ -594,8 +595,22 @@ bool CodeSinking::SinkInstruction(Instruction *inst
         if (FindLowestSinkTarget(inst, tgtBlk, usesInBlk, outerLoop))
         {
             // heuristic, avoid code-motion that does not reduce execution frequency but may increase register usage
-            if (reducePressure || 
-                (tgtBlk && (outerLoop || !PDT->dominates(tgtBlk, inst->getParent()))))
+            uint64_t curCount = 0, tgtCount = 0;
+            if (reducePressure)
+            {
+                succToSinkTo = tgtBlk;
+            }
+            else if (tgtBlk &&
+                getBlockProfileCount(inst->getParent(), curCount) &&
+                getBlockProfileCount(tgtBlk, tgtCount))
+            {
+                // measured frequencies replace the loop/post-dominance guess
+                if (tgtCount < curCount)
+                {
+                    succToSinkTo = tgtBlk;
+                }
+            }
+            else if (tgtBlk && (outerLoop || !PDT->dominates(tgtBlk, inst->getParent())))
             {
                 succToSinkTo = tgtBlk;
             }
@@ -559,6 +559,14 @@ bool CComputeShader::CompileSIMDSize(SIMDMode simdMode, EmitPass &EP, llvm::Func
         return false;
     }
 
+    // skip simd16/simd32 if it's predicted to spill and would be aborted
+    // anyway, as long as a narrower SIMD mode is compiled as well.
+    if (simdMode > ctx->GetLeastSIMDModeAllowed() && EP.m_canAbortOnSpill &&
+        EP.IsSpillPredicted(simdMode))
+    {
+        return false;
+    }
+
     // skip simd32 if simd16 spills
     if (simdMode == SIMDMode::SIMD32 && simd16Program &&
         simd16Program->m_spillSize > 0)
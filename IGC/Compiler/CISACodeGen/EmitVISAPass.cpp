@@ -252,6 +252,10 @@ void EmitPass::CreateKernelShaderMap(CodeGenContext *ctx, MetaDataUtils *pMdUtil
                 if (!isOCLKernelFunc(pMdUtils, pFunc))
                     continue;
 
+                // Skip kernels whose binary is reused from the kernel binary cache.
+                if (static_cast<OpenCLProgramContext*>(ctx)->m_cachedKernelBinaries.count(pFunc->getName().str()))
+                    continue;
+
                 if (ctx->m_retryManager.kernelSet.empty() ||
                     ctx->m_retryManager.kernelSet.count(pFunc->getName().str()))
                 {
@@ -326,6 +330,17 @@ void EmitPass::CreateKernelShaderMap(CodeGenContext *ctx, MetaDataUtils *pMdUtil
     }
 }
 
+bool EmitPass::IsSpillPredicted(SIMDMode mode) const
+{
+    auto SWP = getAnalysisIfAvailable<SimdWidthPredictionAnalysis>();
+    if (!SWP || !SWP->isConfidentSpill(mode))
+    {
+        return false;
+    }
+    COMPILER_SHADER_STATS_SET(m_currShader->m_shaderStats, STATS_SIMD_PREDICTION_SKIPPED, 1);
+    return true;
+}
+
 bool EmitPass::runOnFunction(llvm::Function &F)
 {
     CodeGenContext* ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
@@ -386,6 +401,14 @@ bool EmitPass::runOnFunction(llvm::Function &F)
         {
 			return false;
         }
+        // Keep the spill prediction, if any, to report its accuracy once vISA
+        // compilation is done.
+        if (auto SWP = getAnalysisIfAvailable<SimdWidthPredictionAnalysis>())
+        {
+            m_currShader->m_hasSpillPrediction = true;
+            m_currShader->m_spillPredicted = SWP->predictsSpill(m_SimdMode);
+            m_currShader->m_spillPredictionConfidence = SWP->getConfidence(m_SimdMode);
+        }
         // call builder after pre-analysis pass where scratchspace offset to VISA is calculated
         m_encoder->InitEncoder(m_canAbortOnSpill);
         m_currShader->PreCompile();
@@ -29,6 +29,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ShaderCodeGen.hpp"
 #include "CoalescingEngine.hpp"
 #include "Simd32Profitability.hpp"
+#include "SimdWidthPrediction.hpp"
 #include "GenCodeGenModule.h"
 #include "VariableReuseAnalysis.hpp"
 #include "Compiler/MetaDataUtilsWrapper.h"
@@ -431,6 +432,10 @@ public:
     /// return true if succeeds, false otherwise.
     bool setCurrentShader(llvm::Function *F);
 
+    /// return true if SIMD width prediction is enabled and it predicts the
+    /// given SIMD mode to spill with enough confidence.
+    bool IsSpillPredicted(SIMDMode mode) const;
+
     // Arithmetic operations with constant folding
     // Src0 and Src1 are the input operands
     // DstPrototype is a prototype of the result of operation and may be used for cloning to a new variable
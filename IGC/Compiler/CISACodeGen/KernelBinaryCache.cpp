@@ -0,0 +1,664 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/KernelBinaryCache.hpp"
+
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CISACodeGen/helper.h"
+#include "common/igc_regkeys.hpp"
+#include "common/MDFrameWork.h"
+#include "AdaptorOCL/ocl_igc_shared/executable_format/patch_g7.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/InlineAsm.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <iStdLib/Hash128.h>
+#include <iStdLib/utility.h>
+
+#include <cstring>
+#include <type_traits>
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+KernelBinaryCache& KernelBinaryCache::getInstance()
+{
+    static KernelBinaryCache cache;
+    return cache;
+}
+
+bool KernelBinaryCache::lookup(const KernelCacheKey& key, std::vector<char>& binary)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return false;
+    }
+    binary = it->second;
+    return true;
+}
+
+void KernelBinaryCache::insert(const KernelCacheKey& key, const char* binary, size_t size, size_t capacity)
+{
+    if (size > capacity)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (m_entries.count(key))
+    {
+        return;
+    }
+    while (m_size + size > capacity)
+    {
+        auto oldest = m_entries.find(m_order.front());
+        m_size -= oldest->second.size();
+        m_entries.erase(oldest);
+        m_order.pop_front();
+    }
+    m_entries[key].assign(binary, binary + size);
+    m_order.push_back(key);
+    m_size += size;
+}
+
+namespace
+{
+    typedef DenseMap<const Function*, SmallVector<const MDNode*, 2>> FunctionMDMap;
+
+    /// Hashes IR and metadata by structure rather than by printed form, so the
+    /// result does not depend on the module-wide numbering of metadata or on
+    /// the names of local values. Functions reached through calls or constant
+    /// uses are collected so the caller can hash the transitive closure.
+    class KernelHasher
+    {
+    public:
+        KernelHasher(iSTD::Hash128& hash, const FunctionMDMap& funcMD) :
+            m_hash(hash), m_funcMD(funcMD) {}
+
+        void hashClosure(const Function* kernel);
+        void hashGlobal(const GlobalVariable& GV);
+        void hashMetadata(const Metadata* MD);
+        void hashString(StringRef str);
+        template<typename T> void hashValue(const T& value) { m_hash.UpdateValue(value); }
+
+        SmallVector<const Function*, 8> m_worklist;
+
+    private:
+        enum OperandTag : unsigned char
+        {
+            TAG_NULL,
+            TAG_LOCAL,
+            TAG_GLOBAL,
+            TAG_CONSTANT,
+            TAG_ASM,
+            TAG_METADATA,
+            TAG_MDSTRING,
+            TAG_MDNODE,
+            TAG_MDVISITED,
+        };
+
+        void hashFunction(const Function& F);
+        void hashInstruction(const Instruction& I);
+        void hashOperand(const Value* V);
+        void hashConstant(const Constant* C);
+        void collectFunctions(const Constant* C);
+        void hashType(Type* T);
+        void hashAttributes(AttributeSet attrs, unsigned numArgs);
+
+        iSTD::Hash128& m_hash;
+        const FunctionMDMap& m_funcMD;
+        DenseMap<const Value*, unsigned> m_localIds;
+        DenseMap<const Metadata*, unsigned> m_visitedMD;
+        SmallVector<StringRef, 32> m_kindNames;
+    };
+
+    void KernelHasher::hashString(StringRef str)
+    {
+        hashValue((uint64_t)str.size());
+        m_hash.Update(str.data(), str.size());
+    }
+
+    void KernelHasher::hashType(Type* T)
+    {
+        std::string str;
+        raw_string_ostream os(str);
+        T->print(os);
+        hashString(os.str());
+    }
+
+    void KernelHasher::hashAttributes(AttributeSet attrs, unsigned numArgs)
+    {
+        hashString(attrs.getAsString(AttributeSet::FunctionIndex));
+        hashString(attrs.getAsString(AttributeSet::ReturnIndex));
+        for (unsigned i = 1; i <= numArgs; ++i)
+        {
+            hashString(attrs.getAsString(i));
+        }
+    }
+
+    void KernelHasher::hashConstant(const Constant* C)
+    {
+        if (auto GV = dyn_cast<GlobalValue>(C))
+        {
+            hashValue(TAG_GLOBAL);
+            hashString(GV->getName());
+            hashType(GV->getType());
+            auto F = dyn_cast<Function>(GV);
+            if (F && !F->isDeclaration())
+            {
+                m_worklist.push_back(F);
+            }
+            return;
+        }
+
+        hashValue(TAG_CONSTANT);
+        std::string str;
+        raw_string_ostream os(str);
+        C->print(os);
+        hashString(os.str());
+        collectFunctions(C);
+    }
+
+    // Constant expressions and aggregates may refer to functions, e.g. device
+    // enqueue blocks; their bodies are part of the closure.
+    void KernelHasher::collectFunctions(const Constant* C)
+    {
+        for (const Use& U : C->operands())
+        {
+            auto F = dyn_cast<Function>(U.get());
+            if (F && !F->isDeclaration())
+            {
+                m_worklist.push_back(F);
+            }
+            else if (isa<ConstantExpr>(U.get()) || isa<ConstantAggregate>(U.get()))
+            {
+                collectFunctions(cast<Constant>(U.get()));
+            }
+        }
+    }
+
+    void KernelHasher::hashMetadata(const Metadata* MD)
+    {
+        if (MD == nullptr)
+        {
+            hashValue(TAG_NULL);
+            return;
+        }
+        auto visited = m_visitedMD.find(MD);
+        if (visited != m_visitedMD.end())
+        {
+            hashValue(TAG_MDVISITED);
+            hashValue(visited->second);
+            return;
+        }
+
+        if (auto S = dyn_cast<MDString>(MD))
+        {
+            hashValue(TAG_MDSTRING);
+            hashString(S->getString());
+        }
+        else if (auto V = dyn_cast<ValueAsMetadata>(MD))
+        {
+            // Functions referred to by metadata are not part of the closure.
+            hashValue(TAG_METADATA);
+            hashType(V->getValue()->getType());
+            if (auto GV = dyn_cast<GlobalValue>(V->getValue()))
+            {
+                hashString(GV->getName());
+            }
+            else if (isa<ConstantAsMetadata>(MD))
+            {
+                std::string str;
+                raw_string_ostream os(str);
+                V->getValue()->print(os);
+                hashString(os.str());
+            }
+        }
+        else if (auto N = dyn_cast<MDNode>(MD))
+        {
+            unsigned id = m_visitedMD.size();
+            m_visitedMD[MD] = id;
+            hashValue(TAG_MDNODE);
+            hashValue(N->getMetadataID());
+            hashValue(N->getNumOperands());
+            for (const MDOperand& op : N->operands())
+            {
+                hashMetadata(op.get());
+            }
+        }
+    }
+
+    void KernelHasher::hashOperand(const Value* V)
+    {
+        if (V == nullptr)
+        {
+            hashValue(TAG_NULL);
+            return;
+        }
+        auto local = m_localIds.find(V);
+        if (local != m_localIds.end())
+        {
+            hashValue(TAG_LOCAL);
+            hashValue(local->second);
+        }
+        else if (auto C = dyn_cast<Constant>(V))
+        {
+            hashConstant(C);
+        }
+        else if (auto IA = dyn_cast<InlineAsm>(V))
+        {
+            hashValue(TAG_ASM);
+            hashString(IA->getAsmString());
+            hashString(IA->getConstraintString());
+            hashValue(IA->hasSideEffects());
+        }
+        else if (auto MV = dyn_cast<MetadataAsValue>(V))
+        {
+            hashMetadata(MV->getMetadata());
+        }
+    }
+
+    void KernelHasher::hashInstruction(const Instruction& I)
+    {
+        hashValue(I.getOpcode());
+        hashType(I.getType());
+        hashValue(I.getRawSubclassOptionalData());
+        hashValue(I.getNumOperands());
+        for (const Use& U : I.operands())
+        {
+            hashOperand(U.get());
+        }
+
+        // State that is not an operand.
+        if (auto CI = dyn_cast<CmpInst>(&I))
+        {
+            hashValue(CI->getPredicate());
+        }
+        else if (auto PN = dyn_cast<PHINode>(&I))
+        {
+            for (unsigned i = 0, e = PN->getNumIncomingValues(); i < e; ++i)
+            {
+                hashOperand(PN->getIncomingBlock(i));
+            }
+        }
+        else if (auto AI = dyn_cast<AllocaInst>(&I))
+        {
+            hashValue(AI->getAlignment());
+            hashType(AI->getAllocatedType());
+        }
+        else if (auto LI = dyn_cast<LoadInst>(&I))
+        {
+            hashValue(LI->getAlignment());
+            hashValue(LI->isVolatile());
+            hashValue(LI->getOrdering());
+            hashValue(LI->getSynchScope());
+        }
+        else if (auto SI = dyn_cast<StoreInst>(&I))
+        {
+            hashValue(SI->getAlignment());
+            hashValue(SI->isVolatile());
+            hashValue(SI->getOrdering());
+            hashValue(SI->getSynchScope());
+        }
+        else if (auto RMW = dyn_cast<AtomicRMWInst>(&I))
+        {
+            hashValue(RMW->getOperation());
+            hashValue(RMW->isVolatile());
+            hashValue(RMW->getOrdering());
+            hashValue(RMW->getSynchScope());
+        }
+        else if (auto CX = dyn_cast<AtomicCmpXchgInst>(&I))
+        {
+            hashValue(CX->isVolatile());
+            hashValue(CX->isWeak());
+            hashValue(CX->getSuccessOrdering());
+            hashValue(CX->getFailureOrdering());
+            hashValue(CX->getSynchScope());
+        }
+        else if (auto FI = dyn_cast<FenceInst>(&I))
+        {
+            hashValue(FI->getOrdering());
+            hashValue(FI->getSynchScope());
+        }
+        else if (auto Call = dyn_cast<CallInst>(&I))
+        {
+            hashValue(Call->getCallingConv());
+            hashValue(Call->getTailCallKind());
+            hashAttributes(Call->getAttributes(), Call->getNumArgOperands());
+        }
+        else if (auto GEP = dyn_cast<GetElementPtrInst>(&I))
+        {
+            hashType(GEP->getSourceElementType());
+        }
+        else if (auto EV = dyn_cast<ExtractValueInst>(&I))
+        {
+            for (unsigned idx : EV->indices())
+                hashValue(idx);
+        }
+        else if (auto IV = dyn_cast<InsertValueInst>(&I))
+        {
+            for (unsigned idx : IV->indices())
+                hashValue(idx);
+        }
+
+        SmallVector<std::pair<unsigned, MDNode*>, 4> MDs;
+        I.getAllMetadataOtherThanDebugLoc(MDs);
+        if (!MDs.empty() && m_kindNames.empty())
+        {
+            I.getContext().getMDKindNames(m_kindNames);
+        }
+        for (auto& MD : MDs)
+        {
+            hashString(m_kindNames[MD.first]);
+            hashMetadata(MD.second);
+        }
+    }
+
+    void KernelHasher::hashFunction(const Function& F)
+    {
+        // Number the arguments, blocks and instructions up front so forward
+        // references (phi operands, branch targets) get stable ids.
+        m_localIds.clear();
+        unsigned id = 0;
+        for (const Argument& arg : F.args())
+        {
+            m_localIds[&arg] = id++;
+        }
+        for (const BasicBlock& BB : F)
+        {
+            m_localIds[&BB] = id++;
+            for (const Instruction& I : BB)
+            {
+                m_localIds[&I] = id++;
+            }
+        }
+
+        hashString(F.getName());
+        hashType(F.getFunctionType());
+        hashValue(F.getCallingConv());
+        hashValue(F.getLinkage());
+        hashAttributes(F.getAttributes(), F.arg_size());
+
+        auto funcMD = m_funcMD.find(&F);
+        if (funcMD != m_funcMD.end())
+        {
+            for (const MDNode* node : funcMD->second)
+            {
+                hashMetadata(node);
+            }
+        }
+
+        for (const BasicBlock& BB : F)
+        {
+            hashValue(BB.size());
+            for (const Instruction& I : BB)
+            {
+                hashInstruction(I);
+            }
+        }
+    }
+
+    void KernelHasher::hashClosure(const Function* kernel)
+    {
+        SmallPtrSet<const Function*, 16> visited;
+        m_worklist.push_back(kernel);
+        while (!m_worklist.empty())
+        {
+            const Function* F = m_worklist.pop_back_val();
+            if (visited.insert(F).second)
+            {
+                hashFunction(*F);
+            }
+        }
+    }
+
+    void KernelHasher::hashGlobal(const GlobalVariable& GV)
+    {
+        hashString(GV.getName());
+        hashType(GV.getType());
+        hashValue(GV.getLinkage());
+        hashValue(GV.getAlignment());
+        hashValue(GV.isConstant());
+        hashValue(GV.getThreadLocalMode());
+        if (GV.hasInitializer())
+        {
+            hashConstant(GV.getInitializer());
+        }
+    }
+
+    /// Split the module metadata into the nodes that describe one function and
+    /// the remaining, module-wide ones. Per function nodes are the fields of
+    /// the FuncMD entries of ModuleMetaData and the operands of named metadata
+    /// that start with the function (e.g. igc.functions).
+    void CollectFunctionMD(
+        const Module& M,
+        FunctionMDMap& funcMD,
+        SmallVectorImpl<const MDNode*>& moduleMD)
+    {
+        for (const NamedMDNode& named : M.named_metadata())
+        {
+            if (named.getName() == "IGCMetadata")
+            {
+                continue;
+            }
+            for (const MDNode* node : named.operands())
+            {
+                const Function* F = nullptr;
+                if (node->getNumOperands() > 0)
+                {
+                    if (auto V = dyn_cast_or_null<ValueAsMetadata>(node->getOperand(0).get()))
+                        F = dyn_cast<Function>(V->getValue());
+                }
+                if (F)
+                    funcMD[F].push_back(node);
+                else
+                    moduleMD.push_back(node);
+            }
+        }
+
+        // ModuleMD is { name, field... } and its FuncMD field is
+        // { name, { key name, F }, { value name, field... }, ... }. The key and
+        // value names hold the index of the entry, so they are left out.
+        const NamedMDNode* root = M.getNamedMetadata("IGCMetadata");
+        if (root == nullptr || root->getNumOperands() == 0)
+        {
+            return;
+        }
+        const MDNode* moduleRoot = root->getOperand(0);
+        for (const MDOperand& op : moduleRoot->operands())
+        {
+            auto field = dyn_cast_or_null<MDNode>(op.get());
+            MDString* name = field && field->getNumOperands() > 0 ?
+                dyn_cast_or_null<MDString>(field->getOperand(0).get()) : nullptr;
+            if (name == nullptr || name->getString() != "FuncMD")
+            {
+                if (field)
+                    moduleMD.push_back(field);
+                continue;
+            }
+            for (unsigned i = 1; i + 1 < field->getNumOperands(); i += 2)
+            {
+                auto key = cast<MDNode>(field->getOperand(i));
+                auto V = dyn_cast_or_null<ValueAsMetadata>(key->getOperand(1).get());
+                const Function* F = V ? dyn_cast<Function>(V->getValue()) : nullptr;
+                auto value = cast<MDNode>(field->getOperand(i + 1));
+                for (unsigned j = 1; F && j < value->getNumOperands(); ++j)
+                {
+                    if (auto valueField = dyn_cast_or_null<MDNode>(value->getOperand(j).get()))
+                        funcMD[F].push_back(valueField);
+                }
+            }
+        }
+    }
+}
+
+// A cached binary carries the hash of the program that produced it; give it
+// the hash of the program it is added to and recompute its checksum.
+static void SetKernelBinaryShaderHash(std::vector<char>& binary, QWORD shaderHash)
+{
+    iOpenCL::SKernelBinaryHeaderGen7 header;
+    if (binary.size() < sizeof(header))
+    {
+        return;
+    }
+    memcpy(&header, binary.data(), sizeof(header));
+    header.ShaderHashCode = shaderHash;
+
+    const DWORD* body = (const DWORD*)(binary.data() + sizeof(header));
+    DWORD bodySize = (DWORD)(binary.size() - sizeof(header));
+    header.CheckSum = iSTD::Hash(body, bodySize / sizeof(DWORD)) & 0xFFFFFFFF;
+    memcpy(binary.data(), &header, sizeof(header));
+}
+
+void IGC::LookupCachedKernels(OpenCLProgramContext* ctx, const TC::STB_TranslateInputArgs* pInputArgs)
+{
+    ctx->m_kernelCacheKeys.clear();
+    ctx->m_cachedKernelBinaries.clear();
+
+    Module* M = ctx->getModule();
+    // Debug data and per SIMD mode binaries are not cached.
+    if (M->getNamedMetadata("llvm.dbg.cu") ||
+        ctx->m_InternalOptions.KernelDebugEnable ||
+        ctx->m_DriverInfo.sendMultipleSIMDModes())
+    {
+        return;
+    }
+
+    MetaDataUtils* pMdUtils = ctx->getMetaDataUtils();
+    pMdUtils->save(toLLVMContext(*ctx));
+    serialize(*ctx->getModuleMetaData(), M);
+
+    FunctionMDMap funcMD;
+    SmallVector<const MDNode*, 16> moduleMD;
+    CollectFunctionMD(*M, funcMD, moduleMD);
+
+    // Everything the kernels share: options, platform, regkeys and the
+    // module-wide IR. Any global variable is part of it since the program
+    // scope buffers, and so the offsets kernels use, depend on all of them.
+    iSTD::Hash128 common;
+    {
+        KernelHasher hasher(common, funcMD);
+        if (pInputArgs && pInputArgs->pOptions)
+            hasher.hashString(StringRef(pInputArgs->pOptions, strnlen(pInputArgs->pOptions, pInputArgs->OptionsSize)));
+        if (pInputArgs && pInputArgs->pInternalOptions)
+            hasher.hashString(StringRef(pInputArgs->pInternalOptions, strnlen(pInputArgs->pInternalOptions, pInputArgs->InternalOptionsSize)));
+        hasher.hashValue(ctx->platform.getPlatformInfo());
+        hasher.hashValue(ctx->platform.getWATable());
+        hasher.hashValue(ctx->platform.getSkuTable());
+        hasher.hashValue(ctx->platform.GetGTSystemInfo());
+#if defined(IGC_DEBUG_VARIABLES)
+        hasher.hashValue(ctx->getRegKeys());
+        // The snapshot only holds the first bytes of string regkeys.
+#define DECLARE_IGC_REGKEY(dataType, regkeyName, defaultValue, description)         \
+        if (std::is_same<dataType, debugString>::value)                             \
+        {                                                                           \
+            const char* str = g_RegKeyList.regkeyName.m_string;                     \
+            hasher.hashString(StringRef(str, strnlen(str, sizeof(debugString))));   \
+        }
+#include "common/igc_regkeys.def"
+#undef DECLARE_IGC_REGKEY
+#endif
+        hasher.hashValue(ctx->isSPIRV());
+        hasher.hashValue(ctx->m_ProfilingTimerResolution);
+        hasher.hashValue(ctx->m_ShouldUseNonCoherentStatelessBTI);
+        hasher.hashValue(ctx->m_EnableReRA);
+        hasher.hashValue(ctx->m_EnableGetFreeGRFInfo);
+        hasher.hashValue(ctx->m_EnableSrclineMapping);
+
+        hasher.hashString(M->getDataLayoutStr());
+        hasher.hashString(M->getTargetTriple());
+        for (const MDNode* node : moduleMD)
+        {
+            hasher.hashMetadata(node);
+        }
+        for (const GlobalVariable& GV : M->globals())
+        {
+            hasher.hashGlobal(GV);
+        }
+        // Functions whose address is stored in a global may be called from any kernel.
+        while (!hasher.m_worklist.empty())
+        {
+            hasher.hashClosure(hasher.m_worklist.pop_back_val());
+        }
+    }
+
+    KernelBinaryCache& cache = KernelBinaryCache::getInstance();
+    for (auto i = pMdUtils->begin_FunctionsInfo(), e = pMdUtils->end_FunctionsInfo(); i != e; ++i)
+    {
+        Function* pFunc = i->first;
+        if (!isOCLKernelFunc(pMdUtils, pFunc))
+        {
+            continue;
+        }
+
+        iSTD::Hash128 hash = common;
+        KernelHasher hasher(hash, funcMD);
+        hasher.hashClosure(pFunc);
+        iSTD::Hash128Value value = hash.Final();
+
+        const std::string name = pFunc->getName().str();
+        KernelCacheKey key = { value.lo, value.hi };
+        ctx->m_kernelCacheKeys[name] = key;
+
+        std::vector<char> binary;
+        if (cache.lookup(key, binary))
+        {
+            SetKernelBinaryShaderHash(binary, ctx->hash.getAsmHash());
+            ctx->m_cachedKernelBinaries[name].swap(binary);
+        }
+    }
+}
+
+void IGC::CacheKernelBinary(OpenCLProgramContext* ctx, const std::string& kernelName)
+{
+    auto key = ctx->m_kernelCacheKeys.find(kernelName);
+    if (key == ctx->m_kernelCacheKeys.end())
+    {
+        return;
+    }
+
+    Util::BinaryStream* binary = ctx->m_programOutput.GetLastKernelBinary();
+    if (binary == nullptr || binary->Size() == 0)
+    {
+        return;
+    }
+
+    size_t capacity = size_t(IGC_GET_FLAG_VALUE_CTX(ctx, KernelBinaryCacheSizeMB)) << 20;
+    KernelBinaryCache::getInstance().insert(
+        key->second, binary->GetLinearPointer(), (size_t)binary->Size(), capacity);
+}
@@ -0,0 +1,95 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace TC
+{
+    struct STB_TranslateInputArgs;
+}
+
+namespace IGC
+{
+    class OpenCLProgramContext;
+
+    /// @brief  Key of a kernel in the KernelBinaryCache: a 128-bit hash of the
+    /// kernel after unification, of its transitive callees and of the module
+    /// state, options and platform that code generation depends on.
+    struct KernelCacheKey
+    {
+        uint64_t lo;
+        uint64_t hi;
+
+        bool operator<(const KernelCacheKey& other) const
+        {
+            return hi != other.hi ? hi < other.hi : lo < other.lo;
+        }
+    };
+
+    /// @brief  Process-wide cache of OCL kernel binaries, i.e. the per-kernel
+    /// streams (kernel header, heaps and patch list) that CGen8OpenCLProgram
+    /// concatenates into the program binary. When a program is rebuilt after
+    /// a small edit, kernels whose key did not change skip code generation
+    /// and their cached stream is added to the program output instead.
+    /// Entries are evicted oldest first once the cache exceeds its capacity.
+    class KernelBinaryCache
+    {
+    public:
+        static KernelBinaryCache& getInstance();
+
+        /// Copy the binary cached for the key into binary; return false on a miss.
+        bool lookup(const KernelCacheKey& key, std::vector<char>& binary);
+
+        /// Cache a kernel binary, evicting the oldest entries above capacity bytes.
+        void insert(const KernelCacheKey& key, const char* binary, size_t size, size_t capacity);
+
+    private:
+        KernelBinaryCache() : m_size(0) {}
+
+        std::mutex m_lock;
+        std::map<KernelCacheKey, std::vector<char>> m_entries;
+        /// Keys in insertion order, oldest first.
+        std::list<KernelCacheKey> m_order;
+        size_t m_size;
+    };
+
+    /// Compute the cache key of every kernel of the unified module and fetch
+    /// the binaries of the kernels found in the cache. Must run on the first
+    /// try, before IR optimization; code generation skips the kernels listed
+    /// in ctx->m_cachedKernelBinaries.
+    void LookupCachedKernels(OpenCLProgramContext* ctx, const TC::STB_TranslateInputArgs* pInputArgs);
+
+    /// Cache the binary just added to the program output for the kernel.
+    void CacheKernelBinary(OpenCLProgramContext* ctx, const std::string& kernelName);
+
+} // namespace IGC
@@ -0,0 +1,84 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/LLVMContextPool.hpp"
+
+#include "Compiler/CodeGenPublic.h"
+#include "common/igc_regkeys.hpp"
+
+#include <memory>
+
+namespace IGC
+{
+    namespace
+    {
+        /// The idle context of the calling thread, deleted when the thread exits.
+        thread_local std::unique_ptr<LLVMContextWrapper> t_idleContext;
+    }
+
+    LLVMContextWrapper* LLVMContextPool::acquire()
+    {
+        return acquire(IGC_IS_FLAG_ENABLED(EnableLLVMContextPool));
+    }
+
+    LLVMContextWrapper* LLVMContextPool::acquire(bool pooled)
+    {
+        if (!pooled)
+        {
+            return new LLVMContextWrapper();
+        }
+
+        LLVMContextWrapper* context = t_idleContext.release();
+        if (context == nullptr)
+        {
+            context = new LLVMContextWrapper();
+            context->m_pooled = true;
+        }
+        context->m_compileCount++;
+        return context;
+    }
+
+    void LLVMContextPool::recycle(LLVMContextWrapper* context)
+    {
+        if (t_idleContext ||
+            context->m_compileCount >= IGC_GET_FLAG_VALUE(LLVMContextReuseLimit))
+        {
+            delete context;
+            return;
+        }
+
+        // Free the names of the earlier modules' struct types. A type created
+        // later with the same name would otherwise get a numeric suffix, and
+        // passes match OCL builtin types by their exact name.
+        for (llvm::StructType* type : context->m_retiredStructTypes)
+        {
+            type->setName("");
+        }
+        context->m_retiredStructTypes.clear();
+        t_idleContext.reset(context);
+    }
+
+} // namespace IGC
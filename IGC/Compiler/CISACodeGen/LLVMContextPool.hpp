@@ -0,0 +1,62 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#pragma once
+
+namespace llvm
+{
+    class Module;
+}
+
+namespace IGC
+{
+    class LLVMContextWrapper;
+
+    /// @brief  Per-thread pool of LLVM contexts reused across compilations.
+    /// A reused context keeps its uniqued types, constants and metadata, so
+    /// later compilations on the same thread do not rebuild them. Before a
+    /// context is reused, the named struct types of its earlier modules are
+    /// renamed away so that the types of the next module keep their original
+    /// names. Each thread keeps at most one idle context and a context is
+    /// dropped after LLVMContextReuseLimit compilations. LLVMContext does not
+    /// report how much memory it holds, so this count of compilations is what
+    /// bounds the memory a context accumulates.
+    class LLVMContextPool
+    {
+    public:
+        /// Return an idle context of the calling thread, or a new one. Returns
+        /// a plain, unpooled context if EnableLLVMContextPool is not set.
+        static LLVMContextWrapper* acquire();
+
+        /// As above, with the pool enabled or not regardless of the regkey.
+        static LLVMContextWrapper* acquire(bool pooled);
+
+        /// Called once the last reference to a pooled context is released:
+        /// keep it for the next compilation on this thread or delete it.
+        static void recycle(LLVMContextWrapper* context);
+    };
+
+} // namespace IGC
@@ -24,6 +24,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 #include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/Hashing.h>
 #include <llvm/ADT/STLExtras.h>
 #include <llvm/Analysis/AliasAnalysis.h>
 #include <llvm/Analysis/InstructionSimplify.h>
@@ -40,6 +41,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/Transforms/Utils/Local.h>
 #include "common/LLVMWarningsPop.hpp"
 
+#include <unordered_map>
+
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 #include "Compiler/IGCPassSupport.h"
 #include "Compiler/MetaDataUtilsWrapper.h"
@@ -81,10 +84,37 @@ namespace {
     typedef std::vector<std::pair<Instruction *, unsigned> > MemRefListTy;
     typedef std::vector<Instruction *> TrivialMemRefListTy;
 
+    // Per-BB index of memory references, built for BBs whose memory
+    // references span beyond the linear scan window. References are grouped
+    // by their symbolic base, i.e. the pointer modulo its constant offset, so
+    // that merge candidates far away from the leading load/store are found by
+    // binary search. Positions refer to the entries in MemRefListTy.
+    typedef std::vector<unsigned> MemRefPosListTy;
+    struct MemRefIndexTy {
+      // Symbolic base key of each memory reference. 0 if not indexed.
+      std::vector<size_t> Keys;
+      // Positions of memory references grouped by symbolic base key.
+      std::unordered_map<size_t, MemRefPosListTy> Groups;
+      // Positions of memory references which may write memory. They are the
+      // alias barriers for merging loads.
+      MemRefPosListTy Writers;
+
+      void clear() {
+        Keys.clear();
+        Groups.clear();
+        Writers.clear();
+      }
+    };
+    MemRefIndexTy MemRefIndex;
+
+    // Limit of indexed candidates visited beyond the linear scan window.
+    unsigned IndexedLookupLimit;
+
   public:
     static char ID;
 
-    MemOpt() : FunctionPass(ID), DL(nullptr), AA(nullptr), SE(nullptr), CGC(nullptr) {
+    MemOpt() : FunctionPass(ID), DL(nullptr), AA(nullptr), SE(nullptr), CGC(nullptr),
+               IndexedLookupLimit(0) {
       initializeMemOptPass(*PassRegistry::getPassRegistry());
     }
 
@@ -102,6 +132,13 @@ namespace {
 
     void buildProfitVectorLengths(Function &F);
 
+    void buildMemRefIndex(const MemRefListTy &MemRefs);
+    size_t getSymbolicBaseKey(const Instruction *I) const;
+    bool skipToIndexedCandidate(unsigned LeadingPos, MemRefListTy::iterator &MI,
+                                MemRefListTy &MemRefs, bool WritersOnly,
+                                SmallVectorImpl<Instruction*> &CheckList,
+                                unsigned &NumBarriers) const;
+
     bool mergeLoad(LoadInst *LeadingLoad, MemRefListTy::iterator MI,
                    MemRefListTy &MemRefs, TrivialMemRefListTy &ToOpt);
     bool mergeStore(StoreInst *LeadingStore, MemRefListTy::iterator MI,
@@ -180,7 +217,8 @@ namespace {
 
       // Need to skip private pointers if tranposing on private memory is
       // turned on.
-      return CGC->m_DriverInfo.SupportTransposeLayoutForPrivateMemory();
+      return CGC->m_DriverInfo.SupportTransposeLayoutForPrivateMemory() ||
+             IGC_IS_FLAG_ENABLED(EnablePrivateMemoryLayoutSelection);
     }
 
     /// Skip irrelevant instructions.
@@ -323,6 +361,11 @@ char MemOpt::ID = 0;
 // Limit for the number of instructions to scan from the leading load/store.
 static const unsigned MaxScanLimit = 150;
 
+// Limit for the number of alias barriers, i.e. memory references in the check
+// list that may alias with the ones merged, accumulated when looking up indexed
+// candidates beyond the linear scan window.
+static const unsigned MaxAliasBarriers = 64;
+
 void MemOpt::buildProfitVectorLengths(Function &F) {
   ProfitVectorLengths.clear();
 
@@ -366,6 +409,8 @@ bool MemOpt::runOnFunction(Function &F) {
   if (ProfitVectorLengths.empty())
     buildProfitVectorLengths(F);
 
+  IndexedLookupLimit = IGC_GET_FLAG_VALUE(MemOptIndexedLookupLimit);
+
   bool Changed = false;
 
   for (Function::iterator BB = F.begin(), BBE = F.end(); BB != BBE; ++BB) {
@@ -374,6 +419,7 @@ bool MemOpt::runOnFunction(Function &F) {
     MemRefListTy MemRefs;
     TrivialMemRefListTy MemRefsToOptimize;
     unsigned Distance = 0;
+    unsigned TotalDistance = 0;
     bool FirstMemRef = true;
     for (auto BI = BB->begin(), BE = BB->end(); BI != BE; ++BI) {
       Instruction *I = &(*BI);
@@ -382,6 +428,7 @@ bool MemOpt::runOnFunction(Function &F) {
       if (shouldSkip(I))
         continue;
       MemRefs.push_back(std::make_pair(I, Distance));
+      TotalDistance += Distance;
       Distance = 0;
       FirstMemRef = false;
     }
@@ -395,6 +442,12 @@ bool MemOpt::runOnFunction(Function &F) {
     for (auto &M : MemRefs)
       Changed |= canonicalizeGEP64(M.first);
 
+    // Index memory references by their symbolic bases if some of them could
+    // not be reached through the linear scan.
+    MemRefIndex.clear();
+    if (IndexedLookupLimit && TotalDistance > MaxScanLimit)
+      buildMemRefIndex(MemRefs);
+
     for (auto MI = MemRefs.begin(), ME = MemRefs.end(); MI != ME; ++MI) {
       Instruction *I = MI->first;
 
@@ -414,6 +467,7 @@ bool MemOpt::runOnFunction(Function &F) {
       Changed |= optimizeGEP64(I);
   }
 
+  MemRefIndex.clear();
   DL = nullptr;
   AA = nullptr;
   SE = nullptr;
@@ -489,13 +543,26 @@ bool MemOpt::mergeLoad(LoadInst *LeadingLoad,
 
   // List of instructions need dependency check.
   SmallVector<Instruction*, 8> CheckList;
+  // Number of instructions in the check list writing memory. Only those are
+  // checked against loads.
+  unsigned NumBarriers = 0;
 
   unsigned Limit = MaxScanLimit;
+  unsigned LeadingPos = unsigned(MI - MemRefs.begin());
+  unsigned NumIndexed = 0;
   auto ME = MemRefs.end();
-  for (++MI; Limit != 0 && MI != ME; Limit -= MI->second, ++MI) {
-    // Bail out if the limit is reached.
-    if (Limit < MI->second)
-      break;
+  for (++MI; MI != ME; ++MI) {
+    if (Limit != 0 && Limit >= MI->second)
+      Limit -= MI->second;
+    else {
+      // Beyond the linear scan window, only visit loads/stores sharing the
+      // symbolic base with the leading load. Bail out if there's no more.
+      Limit = 0;
+      if (NumIndexed++ == IndexedLookupLimit ||
+          !skipToIndexedCandidate(LeadingPos, MI, MemRefs, true, CheckList,
+                                  NumBarriers))
+        break;
+    }
 
     Instruction *NextMemRef = MI->first;
 
@@ -504,6 +571,8 @@ bool MemOpt::mergeLoad(LoadInst *LeadingLoad,
       continue;
 
     CheckList.push_back(NextMemRef);
+    if (NextMemRef->mayWriteToMemory())
+      ++NumBarriers;
 
     LoadInst *NextLoad = dyn_cast<LoadInst>(NextMemRef);
 
@@ -808,13 +877,26 @@ bool MemOpt::mergeStore(StoreInst *LeadingStore,
 
   // List of instructions need dependency check.
   SmallVector<Instruction*, 8> CheckList;
+  // Every instruction in the check list is checked against stores.
+  unsigned NumBarriers = 0;
 
   unsigned Limit = MaxScanLimit;
+  unsigned LeadingPos = unsigned(MI - MemRefs.begin());
+  unsigned NumIndexed = 0;
   auto ME = MemRefs.end();
-  for (++MI; Limit != 0 && MI != ME; Limit -= MI->second, ++MI) {
-    // Bail out if the limit is reached.
-    if (Limit < MI->second)
-      break;
+  for (++MI; MI != ME; ++MI) {
+    if (Limit != 0 && Limit >= MI->second)
+      Limit -= MI->second;
+    else {
+      // Beyond the linear scan window, only visit loads/stores sharing the
+      // symbolic base with the leading store. Bail out if there's no more.
+      Limit = 0;
+      NumBarriers = unsigned(CheckList.size());
+      if (NumIndexed++ == IndexedLookupLimit ||
+          !skipToIndexedCandidate(LeadingPos, MI, MemRefs, false, CheckList,
+                                  NumBarriers))
+        break;
+    }
 
     Instruction *NextMemRef = MI->first;
 
@@ -1042,6 +1124,123 @@ bool MemOpt::mergeStore(StoreInst *LeadingStore,
   return true;
 }
 
+/// getSymbolicBaseKey() - returns the key of the symbolic base of the pointer
+/// accessed by the given load/store, i.e. the hash of its address space, base
+/// pointer and symbolic terms. Pointers with the same symbolic base differ
+/// only in their constant offsets. 0 is returned if the pointer cannot be
+/// decomposed.
+size_t MemOpt::getSymbolicBaseKey(const Instruction *I) const {
+  const Value *Ptr = nullptr;
+  if (auto LD = dyn_cast<LoadInst>(I))
+    Ptr = LD->getPointerOperand();
+  else if (auto ST = dyn_cast<StoreInst>(I))
+    Ptr = ST->getPointerOperand();
+  if (!Ptr)
+    return 0;
+
+  SymbolicPointer SymPtr;
+  if (SymbolicPointer::decomposePointer(Ptr, SymPtr, CGC) || !SymPtr.BasePtr)
+    return 0;
+
+  // Terms are compared as a set in getConstantOffset(). Combine their hashes
+  // in an order-independent way.
+  size_t TermsHash = 0;
+  for (auto &T : SymPtr.Terms)
+    TermsHash += hash_combine(T.Idx.getOpaqueValue(), T.Scale);
+
+  // All null-based pointers share the same base.
+  const Value *Base = SymPtr.BasePtr;
+  if (isa<ConstantPointerNull>(Base))
+    Base = nullptr;
+
+  size_t Key = hash_combine(Ptr->getType()->getPointerAddressSpace(), Base,
+                            TermsHash);
+  return Key ? Key : 1;
+}
+
+/// buildMemRefIndex() - builds the per-BB index of the given memory
+/// references.
+void MemOpt::buildMemRefIndex(const MemRefListTy &MemRefs) {
+  MemRefIndex.Keys.resize(MemRefs.size(), 0);
+  for (unsigned Pos = 0, E = unsigned(MemRefs.size()); Pos != E; ++Pos) {
+    Instruction *I = MemRefs[Pos].first;
+    if (I->mayWriteToMemory())
+      MemRefIndex.Writers.push_back(Pos);
+    if (size_t Key = getSymbolicBaseKey(I)) {
+      MemRefIndex.Keys[Pos] = Key;
+      MemRefIndex.Groups[Key].push_back(Pos);
+    }
+  }
+}
+
+/// skipToIndexedCandidate() - advances MI (already beyond the linear scan
+/// window) to the next memory reference sharing the symbolic base with the
+/// leading one at LeadingPos. Memory references skipped over, which may
+/// alias with the merged ones, are appended into the check list and counted
+/// in NumBarriers. For merging loads, only references writing memory are
+/// considered. Return false if there's no more candidate, a non-simple memory
+/// reference is crossed or more than MaxAliasBarriers would be accumulated.
+bool MemOpt::skipToIndexedCandidate(unsigned LeadingPos,
+                                    MemRefListTy::iterator &MI,
+                                    MemRefListTy &MemRefs, bool WritersOnly,
+                                    SmallVectorImpl<Instruction*> &CheckList,
+                                    unsigned &NumBarriers) const {
+  if (LeadingPos >= MemRefIndex.Keys.size())
+    return false;
+
+  size_t Key = MemRefIndex.Keys[LeadingPos];
+  if (!Key)
+    return false;
+
+  auto GI = MemRefIndex.Groups.find(Key);
+  if (GI == MemRefIndex.Groups.end())
+    return false;
+
+  const MemRefPosListTy &Group = GI->second;
+  unsigned Pos = unsigned(MI - MemRefs.begin());
+  auto CI = std::lower_bound(Group.begin(), Group.end(), Pos);
+  if (CI == Group.end())
+    return false;
+  unsigned CandPos = *CI;
+
+  auto addBarrier = [&](Instruction *I) {
+    if (NumBarriers >= MaxAliasBarriers)
+      return false;
+    if (auto LD = dyn_cast<LoadInst>(I))
+      if (!LD->isSimple() || !LD->isUnordered())
+        return false;
+    if (auto ST = dyn_cast<StoreInst>(I))
+      if (!ST->isSimple() || !ST->isUnordered())
+        return false;
+    CheckList.push_back(I);
+    ++NumBarriers;
+    return true;
+  };
+
+  if (WritersOnly) {
+    const MemRefPosListTy &Writers = MemRefIndex.Writers;
+    for (auto WI = std::lower_bound(Writers.begin(), Writers.end(), Pos),
+              WE = Writers.end(); WI != WE && *WI < CandPos; ++WI) {
+      Instruction *I = MemRefs[*WI].first;
+      if (I && !addBarrier(I))
+        return false;
+    }
+  } else {
+    // Every reference skipped over is a barrier for stores. Bail out before
+    // walking a range that cannot fit.
+    if (CandPos - Pos > MaxAliasBarriers - std::min(NumBarriers, MaxAliasBarriers))
+      return false;
+    for (; Pos != CandPos; ++Pos) {
+      Instruction *I = MemRefs[Pos].first;
+      if (I && !addBarrier(I))
+        return false;
+    }
+  }
+
+  MI = MemRefs.begin() + CandPos;
+  return true;
+}
+
 /// isSafeToMergeLoad() - checks whether there is any alias from the specified
 /// load to any one in the check list, which may write to that location.
 bool MemOpt::isSafeToMergeLoad(const LoadInst *Ld,
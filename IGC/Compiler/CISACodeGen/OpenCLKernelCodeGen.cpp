@@ -1669,6 +1669,7 @@ void GatherDataForDriver(OpenCLProgramContext* ctx, COpenCLKernel* pShader, CSha
             ctx->btiLayout,
             pSystemThreadKernelOutput,
             pOutput->m_unpaddedProgramSize);
+        CacheKernelBinary(ctx, pShader->m_kernelInfo.m_kernelName);
 
         COMPILER_SHADER_STATS_PRINT(pKernel->m_shaderStats, ShaderType::OPENCL_SHADER, ctx->hash, ctx->GetStr(pFunc));
         COMPILER_SHADER_STATS_SUM(ctx->m_sumShaderStats, pKernel->m_shaderStats, ShaderType::OPENCL_SHADER);
@@ -1736,11 +1737,43 @@ void CodeGen(OpenCLProgramContext* ctx)
         }
     }
 
+    // On the first try, the binaries reused from the kernel binary cache are
+    // added among the code generated kernels in module order, so the program
+    // binary lists its kernels in the same order as an uncached build.
+    std::vector<Function*> kernelOrder;
+    if (ctx->m_retryManager.IsFirstTry() && !ctx->m_cachedKernelBinaries.empty())
+    {
+        for (auto i = pMdUtils->begin_FunctionsInfo(), e = pMdUtils->end_FunctionsInfo(); i != e; ++i)
+        {
+            if (isOCLKernelFunc(pMdUtils, i->first))
+            {
+                kernelOrder.push_back(i->first);
+            }
+        }
+    }
+    auto nextKernel = kernelOrder.begin();
+    auto addCachedKernelsBefore = [&](Function* pFunc)
+    {
+        for (; nextKernel != kernelOrder.end() && *nextKernel != pFunc; ++nextKernel)
+        {
+            auto cached = ctx->m_cachedKernelBinaries.find((*nextKernel)->getName().str());
+            if (cached != ctx->m_cachedKernelBinaries.end())
+            {
+                ctx->m_programOutput.AddKernelBinary(cached->second.data(), cached->second.size());
+            }
+        }
+        if (nextKernel != kernelOrder.end())
+        {
+            ++nextKernel;
+        }
+    };
+
     ctx->m_retryManager.kernelSet.clear();
     // gather data to send back to the driver
     for (auto k : kernels)
     {
         Function* pFunc = k.first;
+        addCachedKernelsBefore(pFunc);
         CShaderProgram *pKernel = static_cast<CShaderProgram*>(k.second);
         COpenCLKernel* simd8Shader = static_cast<COpenCLKernel*>(pKernel->GetShader(SIMDMode::SIMD8));
         COpenCLKernel* simd16Shader = static_cast<COpenCLKernel*>(pKernel->GetShader(SIMDMode::SIMD16));
@@ -1811,6 +1844,7 @@ void CodeGen(OpenCLProgramContext* ctx)
         }
         delete pKernel;
     }
+    addCachedKernelsBefore(nullptr);
 
     delete pSystemThreadKernelOutput;
 }
@@ -1954,6 +1988,13 @@ bool COpenCLKernel::CompileThisSIMD(SIMDMode simdMode, EmitPass &EP, llvm::Funct
             {
                 return false;
             }
+
+            // bail out of SIMD16 if it's predicted to spill, as it would be
+            // aborted anyway.
+            if (EP.m_canAbortOnSpill && EP.IsSpillPredicted(simdMode))
+            {
+                return false;
+            }
         }
         if (simdMode == SIMDMode::SIMD32)
         {
@@ -1974,6 +2015,13 @@ bool COpenCLKernel::CompileThisSIMD(SIMDMode simdMode, EmitPass &EP, llvm::Funct
             {
                 return false;
             }
+
+            // bail out of SIMD32 if it's predicted to spill, as it would be
+            // aborted anyway.
+            if (EP.m_canAbortOnSpill && EP.IsSpillPredicted(simdMode))
+            {
+                return false;
+            }
         }
     }
 
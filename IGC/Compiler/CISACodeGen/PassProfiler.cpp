@@ -0,0 +1,292 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/PassProfiler.hpp"
+
+#include "common/Stats.hpp"
+#include "common/debug/Dump.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <cstdio>
+#include <map>
+#include <tuple>
+
+using namespace llvm;
+using namespace IGC;
+
+char ModulePassProfiler::ID = 0;
+char FunctionPassProfiler::ID = 0;
+
+namespace
+{
+    void allocationCounters(int& allocations, int& heapUsed)
+    {
+#if GET_MEM_STATS
+        allocations = (int)g_MemoryReport.m_Stat.NumAllocations;
+        heapUsed = g_MemoryReport.m_Stat.HeapUsed;
+#else
+        allocations = 0;
+        heapUsed = 0;
+#endif
+    }
+
+    std::string escapeJSON(const std::string& str)
+    {
+        std::string escaped;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if ((unsigned char)c < 0x20)
+            {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", c);
+                escaped += code;
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+}
+
+unsigned PassProfile::countInstructions(const Function& F)
+{
+    unsigned count = 0;
+    for (const BasicBlock& BB : F)
+    {
+        count += BB.size();
+    }
+    return count;
+}
+
+unsigned PassProfile::countInstructions(const Module& M)
+{
+    unsigned count = 0;
+    for (const Function& F : M)
+    {
+        count += countInstructions(F);
+    }
+    return count;
+}
+
+bool ModulePassProfiler::runOnModule(Module &M)
+{
+    if (m_isStart)
+    {
+        m_scope->record = m_scope->profile->begin(
+            m_scope->pipeline, m_scope->pass, nullptr, m_scope->simd, PassProfile::countInstructions(M));
+    }
+    else
+    {
+        m_scope->profile->end(m_scope->record, PassProfile::countInstructions(M));
+    }
+    return false;
+}
+
+bool FunctionPassProfiler::runOnFunction(Function &F)
+{
+    if (m_isStart)
+    {
+        m_scope->record = m_scope->profile->begin(
+            m_scope->pipeline, m_scope->pass, &F, m_scope->simd, PassProfile::countInstructions(F));
+    }
+    else
+    {
+        m_scope->profile->end(m_scope->record, PassProfile::countInstructions(F));
+    }
+    return false;
+}
+
+uint64_t PassProfile::now() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_origin).count();
+}
+
+size_t PassProfile::begin(const std::string& pipeline, const std::string& pass,
+    const Function* F, unsigned simd, unsigned numInsts)
+{
+    Record record;
+    record.pipeline = pipeline;
+    record.pass = pass;
+    record.function = F ? F->getName().str() : "";
+    record.simd = simd;
+    record.durationUs = 0;
+    record.instsBefore = numInsts;
+    record.instsAfter = numInsts;
+
+    // Hold the counters at begin, end() turns them into deltas.
+    int heapUsed;
+    allocationCounters(record.allocations, heapUsed);
+    record.heapDelta = heapUsed;
+
+    m_records.push_back(record);
+    m_records.back().startUs = now();
+    return m_records.size() - 1;
+}
+
+void PassProfile::end(size_t index, unsigned numInsts)
+{
+    Record& record = m_records[index];
+    record.durationUs = now() - record.startUs;
+    record.instsAfter = numInsts;
+
+    int allocations, heapUsed;
+    allocationCounters(allocations, heapUsed);
+    record.allocations = allocations - record.allocations;
+    record.heapDelta = heapUsed - record.heapDelta;
+}
+
+void PassProfile::print(ShaderType type, ShaderHash hash) const
+{
+    auto name =
+        IGC::Debug::DumpName(IGC::Debug::GetShaderOutputName())
+        .Type(type)
+        .Hash(hash)
+        .PostFix("passprofile")
+        .Extension("json");
+    printTrace(name.str());
+    printSumCSV(std::string(IGC::Debug::GetShaderOutputFolder()) + "passProfileSum.csv", hash);
+}
+
+// Complete ("X") events of a single thread; the viewer nests them by time,
+// so function passes show under the pass manager run that contains them.
+void PassProfile::printTrace(const std::string& fileName) const
+{
+    FILE* fp = fopen(fileName.c_str(), "w");
+    if (!fp)
+    {
+        return;
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < m_records.size(); ++i)
+    {
+        const Record& record = m_records[i];
+        fprintf(fp,
+            "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":0,\"tid\":0,"
+            "\"args\":{\"function\":\"%s\",\"simd\":%u,\"instsBefore\":%u,\"instsAfter\":%u,"
+            "\"allocations\":%d,\"heapDelta\":%d}}%s\n",
+            escapeJSON(record.pass.empty() ? record.pipeline : record.pass).c_str(),
+            escapeJSON(record.pipeline).c_str(),
+            (unsigned long long)record.startUs,
+            (unsigned long long)record.durationUs,
+            escapeJSON(record.function).c_str(),
+            record.simd,
+            record.instsBefore,
+            record.instsAfter,
+            record.allocations,
+            record.heapDelta,
+            i + 1 < m_records.size() ? "," : "");
+    }
+    fprintf(fp, "]}\n");
+    fclose(fp);
+}
+
+// One row per pipeline, pass, function and SIMD width, so files appended by
+// every shader of a corpus can be summed by any of these columns.
+void PassProfile::printSumCSV(const std::string& fileName, ShaderHash hash) const
+{
+    typedef std::tuple<std::string, std::string, std::string, unsigned> Key;
+    struct Sum
+    {
+        unsigned hit;
+        uint64_t durationUs;
+        unsigned instsBefore;
+        unsigned instsAfter;
+        int allocations;
+        int heapDelta;
+    };
+    std::map<Key, size_t> rowIndex;
+    std::vector<std::pair<Key, Sum>> rows;
+    for (const Record& record : m_records)
+    {
+        Key key(record.pipeline, record.pass, record.function, record.simd);
+        auto it = rowIndex.find(key);
+        if (it == rowIndex.end())
+        {
+            rowIndex[key] = rows.size();
+            Sum sum = { 1, record.durationUs, record.instsBefore, record.instsAfter, record.allocations, record.heapDelta };
+            rows.push_back(std::make_pair(key, sum));
+            continue;
+        }
+        Sum& sum = rows[it->second].second;
+        sum.hit++;
+        sum.durationUs += record.durationUs;
+        sum.instsAfter = record.instsAfter;
+        sum.allocations += record.allocations;
+        sum.heapDelta += record.heapDelta;
+    }
+
+    bool fileExist = false;
+    FILE* fp = fopen(fileName.c_str(), "r");
+    if (fp)
+    {
+        fileExist = true;
+        fclose(fp);
+    }
+
+    fp = fopen(fileName.c_str(), "a");
+    if (!fp)
+    {
+        return;
+    }
+
+    if (!fileExist)
+    {
+        fprintf(fp, "corpus name,shader hash,pipeline,pass,function,simd,hit,us,insts before,insts after,allocations,heap delta\n");
+    }
+
+    for (auto& row : rows)
+    {
+        const Key& key = row.first;
+        const Sum& sum = row.second;
+        fprintf(fp, "%s,%016llx,%s,%s,%s,%u,%u,%llu,%u,%u,%d,%d\n",
+            IGC::Debug::GetShaderCorpusName(),
+            (unsigned long long)hash.getAsmHash(),
+            std::get<0>(key).c_str(),
+            std::get<1>(key).empty() ? "total" : std::get<1>(key).c_str(),
+            std::get<2>(key).c_str(),
+            std::get<3>(key),
+            sum.hit,
+            (unsigned long long)sum.durationUs,
+            sum.instsBefore,
+            sum.instsAfter,
+            sum.allocations,
+            sum.heapDelta);
+    }
+    fclose(fp);
+}
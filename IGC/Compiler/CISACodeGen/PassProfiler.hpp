@@ -0,0 +1,151 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "common/Types.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace IGC
+{
+    /// @brief  Per pass compile-time profile of one shader, collected by the
+    /// marker passes IGCPassManager adds around every pass when
+    /// EnablePassProfile is set. Function passes are recorded once per
+    /// function, so the records break down by kernel; code generation passes
+    /// carry the SIMD width they are compiled for.
+    class PassProfile
+    {
+    public:
+        struct Record
+        {
+            std::string pipeline;       //!< Name of the IGCPassManager, e.g. "OPT" or "CG"
+            std::string pass;           //!< Pass name, empty for the whole pipeline run
+            std::string function;       //!< Function the pass ran on, empty for module passes
+            unsigned simd;              //!< SIMD width of the code generation passes, 0 otherwise
+            uint64_t startUs;           //!< Start time, in us since the profile was created
+            uint64_t durationUs;
+            unsigned instsBefore;
+            unsigned instsAfter;
+            int allocations;            //!< Allocations made during the pass (GET_MEM_STATS builds)
+            int heapDelta;              //!< Change of the heap usage in bytes (GET_MEM_STATS builds)
+        };
+
+        PassProfile() : m_origin(std::chrono::steady_clock::now()) {}
+
+        /// Open a record for a pass starting now; return its index.
+        size_t begin(const std::string& pipeline, const std::string& pass,
+            const llvm::Function* F, unsigned simd, unsigned numInsts);
+        /// Close the record opened by begin().
+        void end(size_t record, unsigned numInsts);
+
+        /// Write the Chrome trace of the shader and append its rows to
+        /// passProfileSum.csv, both in the shader dump folder.
+        void print(ShaderType type, ShaderHash hash) const;
+
+        static unsigned countInstructions(const llvm::Function& F);
+        static unsigned countInstructions(const llvm::Module& M);
+
+    private:
+        uint64_t now() const;
+        void printTrace(const std::string& fileName) const;
+        void printSumCSV(const std::string& fileName, ShaderHash hash) const;
+
+        std::chrono::steady_clock::time_point m_origin;
+        std::vector<Record> m_records;
+    };
+
+    /// State shared by the start and end markers of a profiled pass, or of a
+    /// run of loop or CGSCC passes profiled as one.
+    struct PassProfileScope
+    {
+        PassProfile* profile;
+        std::string pipeline;
+        std::string pass;
+        unsigned simd;
+        size_t record;
+    };
+
+    /// Marker wrapping module passes and CGSCC pass runs.
+    class ModulePassProfiler : public llvm::ModulePass
+    {
+    public:
+        ModulePassProfiler(std::shared_ptr<PassProfileScope> scope, bool isStart) :
+            llvm::ModulePass(ID), m_scope(scope), m_isStart(isStart) {}
+
+        virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override
+        {
+            AU.setPreservesAll();
+        }
+
+        virtual bool runOnModule(llvm::Module &M) override;
+
+        virtual llvm::StringRef getPassName() const override
+        {
+            return "PassProfiler";
+        }
+
+        static char ID;
+
+    private:
+        std::shared_ptr<PassProfileScope> m_scope;
+        bool m_isStart;
+    };
+
+    /// Marker wrapping function passes and loop, region or basic block pass
+    /// runs. It runs for each function, right before and after the wrapped passes.
+    class FunctionPassProfiler : public llvm::FunctionPass
+    {
+    public:
+        FunctionPassProfiler(std::shared_ptr<PassProfileScope> scope, bool isStart) :
+            llvm::FunctionPass(ID), m_scope(scope), m_isStart(isStart) {}
+
+        virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override
+        {
+            AU.setPreservesAll();
+        }
+
+        virtual bool runOnFunction(llvm::Function &F) override;
+
+        virtual llvm::StringRef getPassName() const override
+        {
+            return "PassProfiler";
+        }
+
+        static char ID;
+
+    private:
+        std::shared_ptr<PassProfileScope> m_scope;
+        bool m_isStart;
+    };
+
+} // namespace IGC
@@ -39,6 +39,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/PullConstantHeuristics.hpp"
 #include "Compiler/CISACodeGen/PushAnalysis.hpp"
 #include "Compiler/CISACodeGen/ScalarizerCodeGen.hpp"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CISACodeGen/CodeSinking.hpp"
 #include "Compiler/CISACodeGen/CodeHoisting.hpp"
 #include "Compiler/CISACodeGen/ConstantCoalescing.hpp"
@@ -60,6 +61,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/ResolveGAS.h"
 #include "Compiler/CISACodeGen/ResolvePredefinedConstant.h"
 #include "Compiler/CISACodeGen/Simd32Profitability.hpp"
+#include "Compiler/CISACodeGen/SimdWidthPrediction.hpp"
 #include "Compiler/CISACodeGen/SimplifyConstant.h"
 #include "Compiler/CISACodeGen/TypeDemote.h"
 #include "Compiler/Optimizer/LinkMultiRateShaders.hpp"
@@ -228,6 +230,13 @@ inline void AddAnalysisPasses(CodeGenContext &ctx, const CShaderProgram::KernelS
     TODO("remove the following once all IGC passes are registered to PassRegistery in their constructor")
     initializeLoopInfoWrapperPassPass(*PassRegistry::getPassRegistry());
 
+    // Attach profiled block counts before any pass below changes the CFG, so
+    // block indices match the ones the profile was collected with.
+    if (isBlockProfileEnabled())
+    {
+        mpm.add(createBlockProfileAnnotationPass());
+    }
+
     // transform pull constants and inputs into push constants and inputs
     mpm.add(new PushAnalysis());
     mpm.add(CreateSampleCmpToDiscardPass());
@@ -575,6 +584,14 @@ inline void AddLegalizationPasses(CodeGenContext &ctx, const CShaderProgram::Ker
 
 inline void AddCodeGenPasses(CodeGenContext &ctx, CShaderProgram::KernelShaderMap &shaders, IGCPassManager& Passes, SIMDMode simdMode, bool canAbortOnSpill, ShaderDispatchMode shaderMode = ShaderDispatchMode::NOT_APPLICABLE, PSSignature* pSignature = nullptr)
 {
+    Passes.setSIMDWidth(numLanes(simdMode));
+
+    if (IGC_IS_FLAG_ENABLED_CTX(&ctx, EnableSimdWidthPrediction) &&
+        (ctx.type == ShaderType::OPENCL_SHADER || ctx.type == ShaderType::COMPUTE_SHADER))
+    {
+        Passes.add(createSimdWidthPredictionPass());
+    }
+
     // Generate CISA
     Passes.add(new EmitPass(shaders, simdMode, canAbortOnSpill, shaderMode, pSignature));
 }
@@ -618,8 +635,8 @@ void PSCodeGen(PixelShaderContext* ctx, CShaderProgram::KernelShaderMap &shaders
     AddAnalysisPasses(*ctx, shaders, PassMgr);
 
     bool useRegKeySimd = false;
-    uint32_t pixelShaderSIMDMode = IGC_GET_FLAG_VALUE(ForcePixelShaderSIMDMode);
-    bool earlyExit = IGC_IS_FLAG_DISABLED(PixelShaderDoNotAbortOnSpill) ? true : false;
+    uint32_t pixelShaderSIMDMode = IGC_GET_FLAG_VALUE_CTX(ctx, ForcePixelShaderSIMDMode);
+    bool earlyExit = IGC_IS_FLAG_DISABLED_CTX(ctx, PixelShaderDoNotAbortOnSpill) ? true : false;
 
 
     if (pixelShaderSIMDMode & FLAG_PS_SIMD_MODE_FORCE_SIMD8)
@@ -666,7 +683,7 @@ void PSCodeGen(PixelShaderContext* ctx, CShaderProgram::KernelShaderMap &shaders
         bool earlyExit16 = psInfo.hasVersionedLoop ? false : earlyExit;
         AddCodeGenPasses(*ctx, shaders, PassMgr, SIMDMode::SIMD8, !ctx->m_retryManager.IsLastTry(), ShaderDispatchMode::NOT_APPLICABLE, pSignature);
 
-        if (enableSimd32 || IGC_GET_FLAG_VALUE(SkipTREarlyExitCheck))
+        if (enableSimd32 || IGC_GET_FLAG_VALUE_CTX(ctx, SkipTREarlyExitCheck))
         {
             AddCodeGenPasses(*ctx, shaders, PassMgr, SIMDMode::SIMD16, earlyExit16, ShaderDispatchMode::NOT_APPLICABLE, pSignature);
             AddCodeGenPasses(*ctx, shaders, PassMgr, SIMDMode::SIMD32, earlyExit, ShaderDispatchMode::NOT_APPLICABLE, pSignature);
@@ -696,16 +713,16 @@ void CodeGen(ComputeShaderContext* ctx, CShaderProgram::KernelShaderMap &shaders
     SIMDMode maxSimdMode = ctx->GetMaxSIMDMode();
     unsigned int waveSize = ctx->getModuleMetaData()->csInfo.waveSize;
 
-    if (IGC_IS_FLAG_ENABLED(ForceCSSIMD32) || waveSize == 32)
+    if (IGC_IS_FLAG_ENABLED_CTX(ctx, ForceCSSIMD32) || waveSize == 32)
     {
         AddCodeGenPasses(*ctx, shaders, PassMgr, SIMDMode::SIMD32, false);
     }
-    else if(((IGC_IS_FLAG_ENABLED(ForceCSSIMD16)) && simdModeAllowed <= SIMDMode::SIMD16) || 
+    else if(((IGC_IS_FLAG_ENABLED_CTX(ctx, ForceCSSIMD16)) && simdModeAllowed <= SIMDMode::SIMD16) || 
         waveSize == 16)
     {
         AddCodeGenPasses(*ctx, shaders, PassMgr, SIMDMode::SIMD16, false);
     }
-    else if (IGC_IS_FLAG_ENABLED(ForceCSLeastSIMD))
+    else if (IGC_IS_FLAG_ENABLED_CTX(ctx, ForceCSLeastSIMD))
     {
         AddCodeGenPasses(*ctx, shaders, PassMgr, simdModeAllowed, false);
     }
@@ -735,7 +752,7 @@ void CodeGen(ComputeShaderContext* ctx, CShaderProgram::KernelShaderMap &shaders
                     }
                 }
 
-                if (IGC_GET_FLAG_VALUE(CSSpillThresholdNoSLM) > 0)
+                if (IGC_GET_FLAG_VALUE_CTX(ctx, CSSpillThresholdNoSLM) > 0)
                 {
                     allowSpill = true;
                 }
@@ -837,8 +854,8 @@ void CodeGen(OpenCLProgramContext *ctx, CShaderProgram::KernelShaderMap &kernels
     AddAnalysisPasses(*ctx, kernels, Passes);
 
     // The order in which we call AddCodeGenPasses matters, please to not change order
-    AddCodeGenPasses(*ctx, kernels, Passes, SIMDMode::SIMD32, (IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth) != 32));
-    AddCodeGenPasses(*ctx, kernels, Passes, SIMDMode::SIMD16, (IGC_GET_FLAG_VALUE(ForceOCLSIMDWidth) != 16));
+    AddCodeGenPasses(*ctx, kernels, Passes, SIMDMode::SIMD32, (IGC_GET_FLAG_VALUE_CTX(ctx, ForceOCLSIMDWidth) != 32));
+    AddCodeGenPasses(*ctx, kernels, Passes, SIMDMode::SIMD16, (IGC_GET_FLAG_VALUE_CTX(ctx, ForceOCLSIMDWidth) != 16));
     AddCodeGenPasses(*ctx, kernels, Passes, SIMDMode::SIMD8, false);
 
     Passes.run(*(ctx->getModule()));
@@ -1034,7 +1051,7 @@ void OptimizeIR(CodeGenContext* pContext)
         }
 
         //enable this only when Pooled EU is not supported
-        if (IGC_IS_FLAG_ENABLED(EnableThreadCombiningOpt) &&
+        if (IGC_IS_FLAG_ENABLED_CTX(pContext, EnableThreadCombiningOpt) &&
             (pContext->type == ShaderType::COMPUTE_SHADER)&&
             !pContext->platform.supportPooledEU())
         {
@@ -1044,7 +1061,7 @@ void OptimizeIR(CodeGenContext* pContext)
             mpm.add(createPromoteMemoryToRegisterPass());
         }
 
-        if (IGC_IS_FLAG_ENABLED(EnableSLMConstProp) &&
+        if (IGC_IS_FLAG_ENABLED_CTX(pContext, EnableSLMConstProp) &&
             pContext->type == ShaderType::COMPUTE_SHADER)
         {
             mpm.add(createSLMConstPropPass());
@@ -1080,7 +1097,7 @@ void OptimizeIR(CodeGenContext* pContext)
             mpm.add(new CustomUnsafeOptPass());
         }
 
-        if (IGC_IS_FLAG_ENABLED(EmulateFDIV))
+        if (IGC_IS_FLAG_ENABLED_CTX(pContext, EmulateFDIV))
         {
             mpm.add(createGenFDIVEmulation());
         }
@@ -1100,12 +1117,12 @@ void OptimizeIR(CodeGenContext* pContext)
                 mpm.add(llvm::createLCSSAPass());
                 mpm.add(llvm::createLoopSimplifyPass());
 
-                if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
+                if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED_CTX(pContext, allowLICM))
                 {
                     mpm.add(llvm::createLICMPass());
                 }
 
-                if (IGC_IS_FLAG_ENABLED(EnableCustomLoopVersioning) &&
+                if (IGC_IS_FLAG_ENABLED_CTX(pContext, EnableCustomLoopVersioning) &&
                     pContext->type == ShaderType::PIXEL_SHADER &&
                     pContext->m_retryManager.AllowUnroll())
                 {
@@ -1116,7 +1133,7 @@ void OptimizeIR(CodeGenContext* pContext)
                 if (pContext->m_DriverInfo.NeedSampleWorkaround() && 
                     pContext->type == ShaderType::PIXEL_SHADER && 
                     pContext->platform.needSampleLWA() &&
-                    IGC_IS_FLAG_ENABLED(EnableSampleLWa))
+                    IGC_IS_FLAG_ENABLED_CTX(pContext, EnableSampleLWa))
                 {
                     mpm.add(new CustomLoopInfo());
                 }
@@ -1125,12 +1142,12 @@ void OptimizeIR(CodeGenContext* pContext)
                 int LoopUnrollThreshold = pContext->m_DriverInfo.GetLoopUnrollThreshold();
 
                 // override the LoopUnrollThreshold if the registry key is set
-                if (IGC_GET_FLAG_VALUE(SetLoopUnrollThreshold) != 0)
+                if (IGC_GET_FLAG_VALUE_CTX(pContext, SetLoopUnrollThreshold) != 0)
                 {
-                    LoopUnrollThreshold = IGC_GET_FLAG_VALUE(SetLoopUnrollThreshold);
+                    LoopUnrollThreshold = IGC_GET_FLAG_VALUE_CTX(pContext, SetLoopUnrollThreshold);
                 }
 
-                if (LoopUnrollThreshold > 0 && pContext->m_retryManager.AllowUnroll() && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
+                if (LoopUnrollThreshold > 0 && pContext->m_retryManager.AllowUnroll() && !IGC_IS_FLAG_ENABLED_CTX(pContext, DisableLoopUnroll))
                 {
                     mpm.add(createLoopUnrollPass());
                 }
@@ -1139,7 +1156,7 @@ void OptimizeIR(CodeGenContext* pContext)
                 // LoopUnroll and LICM.
                 mpm.add(createBarrierNoopPass());
 
-                if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED(allowLICM))
+                if (pContext->m_retryManager.AllowLICM() && IGC_IS_FLAG_ENABLED_CTX(pContext, allowLICM))
                 {
                     mpm.add(llvm::createLICMPass());
                 }
@@ -1147,7 +1164,7 @@ void OptimizeIR(CodeGenContext* pContext)
                 // Second unrolling with the same threshold.
                 if (LoopUnrollThreshold > 0 &&
                     pContext->m_retryManager.AllowUnroll() &&
-                    !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
+                    !IGC_IS_FLAG_ENABLED_CTX(pContext, DisableLoopUnroll))
                 {
                     mpm.add(createLoopUnrollPass());
                 }
@@ -1163,7 +1180,7 @@ void OptimizeIR(CodeGenContext* pContext)
               //
               // Do not apply reordering on VS as CustomUnsafeOptPass does.
               //
-              if (IGC_IS_FLAG_ENABLED(EnableReasso) && (pContext->type != ShaderType::VERTEX_SHADER))
+              if (IGC_IS_FLAG_ENABLED_CTX(pContext, EnableReasso) && (pContext->type != ShaderType::VERTEX_SHADER))
               {
                   mpm.add(createReassociatePass());
               }
@@ -1175,14 +1192,14 @@ void OptimizeIR(CodeGenContext* pContext)
             mpm.add(llvm::createSCCPPass());
 
             mpm.add(llvm::createDeadCodeEliminationPass());
-            mpm.add(new IGCConstProp(!pContext->m_DriverInfo.SupportsPreciseMath(), IGC_IS_FLAG_ENABLED(EnableSimplifyGEP)));
+            mpm.add(new IGCConstProp(!pContext->m_DriverInfo.SupportsPreciseMath(), IGC_IS_FLAG_ENABLED_CTX(pContext, EnableSimplifyGEP)));
 
-            if (IGC_IS_FLAG_DISABLED(DisableImmConstantOpt))
+            if (IGC_IS_FLAG_DISABLED_CTX(pContext, DisableImmConstantOpt))
             {
                 mpm.add(createIGCIndirectICBPropagaionPass());
             }
 
-            if (pContext->m_DriverInfo.AllowGenUpdateCB() && IGC_IS_FLAG_ENABLED(EnableGenUpdateCB))
+            if (pContext->m_DriverInfo.AllowGenUpdateCB() && IGC_IS_FLAG_ENABLED_CTX(pContext, EnableGenUpdateCB))
             {
                 mpm.add(new GenUpdateCB());
             }
@@ -1204,7 +1221,7 @@ void OptimizeIR(CodeGenContext* pContext)
             // Use CFGSimplification to do clean-up. Needs to be invoked before lowerSwitch.
             mpm.add(llvm::createCFGSimplificationPass());
 
-            if (IGC_IS_FLAG_DISABLED(DisableFlattenSmallSwitch))
+            if (IGC_IS_FLAG_DISABLED_CTX(pContext, DisableFlattenSmallSwitch))
             {
                 mpm.add(createFlattenSmallSwitchPass());
             }
@@ -1245,7 +1262,7 @@ void OptimizeIR(CodeGenContext* pContext)
             mpm.add(createGenOptLegalizer());
         }
 
-        if (IGC_GET_FLAG_VALUE(FunctionControl) == FLAG_FCALL_DEFAULT)
+        if (IGC_GET_FLAG_VALUE_CTX(pContext, FunctionControl) == FLAG_FCALL_DEFAULT)
         {
             if (pContext->m_enableSubroutine)
             {
@@ -1278,12 +1295,12 @@ void OptimizeIR(CodeGenContext* pContext)
 
         mpm.add(CreateGatingSimilarSamples());
 
-        if (IGC_GET_FLAG_VALUE(FunctionControl) != FLAG_FCALL_FORCE_INLINE)
+        if (IGC_GET_FLAG_VALUE_CTX(pContext, FunctionControl) != FLAG_FCALL_FORCE_INLINE)
         {
             mpm.add(new PurgeMetaDataUtils());
         }
 
-        if (!IGC_IS_FLAG_ENABLED(DisableDynamicConstantFolding))
+        if (!IGC_IS_FLAG_ENABLED_CTX(pContext, DisableDynamicConstantFolding))
         {
             mpm.add(new FindInterestingConstants());
         }
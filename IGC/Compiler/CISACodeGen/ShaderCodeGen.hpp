@@ -244,6 +244,10 @@ public:
     uint m_staticCycle;
     unsigned m_spillSize = 0;
     float m_spillCost = 0;          // num weighted spill inst / total inst
+    // Spill prediction made before codegen, see SimdWidthPredictionAnalysis.
+    bool m_hasSpillPrediction = false;
+    bool m_spillPredicted = false;
+    unsigned m_spillPredictionConfidence = 0;
 
 	std::vector<llvm::Value*> m_argListCache;
 
@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include "Compiler/CISACodeGen/Simd32Profitability.hpp"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/IGCPassSupport.h"
@@ -464,9 +465,37 @@ unsigned Simd32ProfitabilityAnalysis::estimateLoopCount_CASE2(Loop *L) {
     return LOOPCOUNT_UNKNOWN;
 }
 
+/// Measured trip count: header executions per entry into the loop.
+unsigned Simd32ProfitabilityAnalysis::estimateLoopCount_PROFILE(Loop *L) {
+    BasicBlock *Header = L->getHeader();
+    uint64_t HeaderCount = 0;
+    if (!getBlockProfileCount(Header, HeaderCount))
+        return LOOPCOUNT_UNKNOWN;
+
+    uint64_t EntryCount = 0;
+    for (auto PI = pred_begin(Header), PE = pred_end(Header); PI != PE; ++PI) {
+        if (L->contains(*PI))
+            continue;
+        uint64_t Count = 0;
+        if (!getBlockProfileCount(*PI, Count))
+            return LOOPCOUNT_UNKNOWN;
+        EntryCount += Count;
+    }
+    if (EntryCount == 0)
+        return LOOPCOUNT_UNKNOWN;
+
+    if (HeaderCount / EntryCount < 100)
+        return LOOPCOUNT_LIKELY_SMALL;
+    return LOOPCOUNT_LIKELY_LARGE;
+}
+
 unsigned Simd32ProfitabilityAnalysis::estimateLoopCount(Loop *L) {
     unsigned Ret;
 
+    Ret = estimateLoopCount_PROFILE(L);
+    if (Ret != LOOPCOUNT_UNKNOWN)
+        return Ret;
+
     Ret = estimateLoopCount_CASE1(L);
     if (Ret != LOOPCOUNT_UNKNOWN)
         return Ret;
@@ -0,0 +1,176 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "Compiler/CISACodeGen/SimdWidthPrediction.hpp"
+
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "common/igc_regkeys.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/Function.h>
+#include "common/LLVMWarningsPop.hpp"
+
+using namespace llvm;
+using namespace IGC;
+
+// Register pass to igc-opt
+#define PASS_FLAG "simd-width-predict"
+#define PASS_DESCRIPTION "Predict SIMD width from register pressure estimate"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS true
+IGC_INITIALIZE_PASS_BEGIN(SimdWidthPredictionAnalysis, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(RegisterEstimator)
+IGC_INITIALIZE_PASS_DEPENDENCY(Simd32ProfitabilityAnalysis)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_END(SimdWidthPredictionAnalysis, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+
+char SimdWidthPredictionAnalysis::ID = 0;
+
+// GRFs reserved for r0, the thread payload and the spill/fill headers.
+const unsigned FIXED_OVERHEAD_GRF = 8;
+// Per SIMD8 lanes, GRFs needed for the payload of sampler messages.
+const unsigned SAMPLE_PAYLOAD_GRF = 4;
+// Base margin, in percent of the estimated GRFs, to account for values
+// RegisterEstimator does not see (e.g. temporaries created by EmitPass).
+const unsigned BASE_UNCERTAINTY = 10;
+
+SimdWidthPredictionAnalysis::SimdWidthPredictionAnalysis()
+    : FunctionPass(ID), m_predictedMode(SIMDMode::SIMD8)
+{
+    initializeSimdWidthPredictionAnalysisPass(*PassRegistry::getPassRegistry());
+}
+
+FunctionPass *IGC::createSimdWidthPredictionPass()
+{
+    return new SimdWidthPredictionAnalysis();
+}
+
+const SimdWidthPredictionAnalysis::Prediction &
+SimdWidthPredictionAnalysis::getPrediction(SIMDMode mode) const
+{
+    switch (mode)
+    {
+    case SIMDMode::SIMD32:
+        return m_predictions[2];
+    case SIMDMode::SIMD16:
+        return m_predictions[1];
+    default:
+        return m_predictions[0];
+    }
+}
+
+bool SimdWidthPredictionAnalysis::isConfidentSpill(SIMDMode mode) const
+{
+    return predictsSpill(mode) &&
+        getConfidence(mode) >= IGC_GET_FLAG_VALUE(SimdWidthPredictionConfidence);
+}
+
+unsigned SimdWidthPredictionAnalysis::getMaxLiveGRF(Function &F, RegisterEstimator &RPE, uint16_t simdsize)
+{
+    // No need to calculate RPE if the pressure is low even when all values are
+    // assumed to be live all the time.
+    if (RPE.hasNoGRFPressure())
+    {
+        return GRF_NUM_THRESHOLD * simdsize / 16;
+    }
+
+    RPE.calculate();
+
+    unsigned maxLive = 0;
+    for (auto &BB : F)
+    {
+        maxLive = std::max(maxLive, RPE.getMaxLiveGRFAtBB(&BB, simdsize));
+    }
+    return maxLive;
+}
+
+unsigned SimdWidthPredictionAnalysis::getOverheadGRF(const SInstrTypes &instrTypes, uint16_t simdsize) const
+{
+    unsigned overhead = FIXED_OVERHEAD_GRF;
+
+    // Sampler payloads are assembled in GRFs right before the send and are not
+    // visible to RegisterEstimator.
+    if (instrTypes.numSample > 0)
+    {
+        overhead += SAMPLE_PAYLOAD_GRF * simdsize / 8;
+    }
+    return overhead;
+}
+
+unsigned SimdWidthPredictionAnalysis::getUncertaintyGRF(const SInstrTypes &instrTypes, unsigned numGRF) const
+{
+    unsigned percent = BASE_UNCERTAINTY;
+
+    // Loops extend live ranges in a way the estimate captures poorly, and
+    // calls/indirect operands add registers that depend on the final codegen.
+    if (instrTypes.hasLoop)
+    {
+        percent += 5;
+    }
+    if (instrTypes.hasSubroutines || instrTypes.mayHaveIndirectOperands)
+    {
+        percent += 5;
+    }
+    return std::max(1u, numGRF * percent / 100);
+}
+
+bool SimdWidthPredictionAnalysis::runOnFunction(Function &F)
+{
+    CodeGenContext *pCtx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    RegisterEstimator &RPE = getAnalysis<RegisterEstimator>();
+    Simd32ProfitabilityAnalysis &PA = getAnalysis<Simd32ProfitabilityAnalysis>();
+    const SInstrTypes &instrTypes = pCtx->m_instrTypes;
+
+    m_predictedMode = SIMDMode::SIMD8;
+
+    const SIMDMode modes[] = { SIMDMode::SIMD8, SIMDMode::SIMD16, SIMDMode::SIMD32 };
+    for (SIMDMode mode : modes)
+    {
+        uint16_t simdsize = numLanes(mode);
+        Prediction &P = getPrediction(mode);
+
+        P.numGRF = getMaxLiveGRF(F, RPE, simdsize) + getOverheadGRF(instrTypes, simdsize);
+        P.fits = P.numGRF <= GRF_TOTAL_NUM;
+
+        // The confidence grows with the distance between the estimate and the
+        // GRF budget, relative to how much the estimate could be off.
+        unsigned distance = P.fits ? GRF_TOTAL_NUM - P.numGRF : P.numGRF - GRF_TOTAL_NUM;
+        unsigned uncertainty = getUncertaintyGRF(instrTypes, P.numGRF);
+        P.confidence = std::min(100u, 50 + 50 * distance / uncertainty);
+
+        bool profitable =
+            mode == SIMDMode::SIMD8 ||
+            (mode == SIMDMode::SIMD16 && PA.isSimd16Profitable()) ||
+            (mode == SIMDMode::SIMD32 && PA.isSimd32Profitable());
+        if (P.fits && profitable)
+        {
+            m_predictedMode = mode;
+        }
+    }
+
+    return false;
+}
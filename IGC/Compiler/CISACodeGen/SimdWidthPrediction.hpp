@@ -0,0 +1,111 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/Pass.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CodeGenContextWrapper.hpp"
+#include "Compiler/CISACodeGen/RegisterEstimator.hpp"
+#include "Compiler/CISACodeGen/Simd32Profitability.hpp"
+
+namespace IGC
+{
+    /// @brief  This pass predicts, before codegen, which SIMD widths could be
+    /// compiled without spill. The prediction is based on the register pressure
+    /// estimated by RegisterEstimator, the SIMD16/SIMD32 profitability and the
+    /// instruction mix collected in SInstrTypes. Widths predicted to spill with
+    /// enough confidence are skipped instead of being compiled and aborted.
+    class SimdWidthPredictionAnalysis : public llvm::FunctionPass
+    {
+    public:
+        static char ID;
+
+        SimdWidthPredictionAnalysis();
+
+        ~SimdWidthPredictionAnalysis() {}
+
+        virtual llvm::StringRef getPassName() const override
+        {
+            return "SimdWidthPrediction";
+        }
+
+        virtual bool runOnFunction(llvm::Function &F) override;
+
+        virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override
+        {
+            AU.setPreservesAll();
+            AU.addRequired<RegisterEstimator>();
+            AU.addRequired<Simd32ProfitabilityAnalysis>();
+            AU.addRequired<CodeGenContextWrapper>();
+        }
+
+        /// Return the widest SIMD mode predicted to compile without spill.
+        SIMDMode getPredictedSimdMode() const { return m_predictedMode; }
+
+        /// Return true if the given SIMD mode is predicted to spill.
+        bool predictsSpill(SIMDMode mode) const { return !getPrediction(mode).fits; }
+
+        /// Return the confidence, in percent, of the prediction on the given
+        /// SIMD mode.
+        unsigned getConfidence(SIMDMode mode) const { return getPrediction(mode).confidence; }
+
+        /// Return the number of GRFs estimated for the given SIMD mode.
+        unsigned getEstimatedGRF(SIMDMode mode) const { return getPrediction(mode).numGRF; }
+
+        /// Return true if the given SIMD mode is predicted to spill with a
+        /// confidence no less than the SimdWidthPredictionConfidence regkey.
+        bool isConfidentSpill(SIMDMode mode) const;
+
+    private:
+        struct Prediction
+        {
+            unsigned numGRF = 0;
+            unsigned confidence = 0;
+            bool fits = true;
+        };
+
+        // Predictions for SIMD8, SIMD16 and SIMD32.
+        Prediction m_predictions[3];
+        SIMDMode m_predictedMode;
+
+        const Prediction &getPrediction(SIMDMode mode) const;
+        Prediction &getPrediction(SIMDMode mode)
+        {
+            return const_cast<Prediction &>(
+                static_cast<const SimdWidthPredictionAnalysis *>(this)->getPrediction(mode));
+        }
+
+        unsigned getMaxLiveGRF(llvm::Function &F, RegisterEstimator &RPE, uint16_t simdsize);
+        unsigned getOverheadGRF(const SInstrTypes &instrTypes, uint16_t simdsize) const;
+        unsigned getUncertaintyGRF(const SInstrTypes &instrTypes, unsigned numGRF) const;
+    };
+
+    llvm::FunctionPass *createSimdWidthPredictionPass();
+
+} // namespace IGC
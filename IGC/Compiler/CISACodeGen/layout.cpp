@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 
 #include "Compiler/CISACodeGen/layout.hpp"
+#include "Compiler/CISACodeGen/BlockProfile.hpp"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
 #include "Compiler/IGCPassSupport.h"
 
@@ -33,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/MemStats.h"
 #include "common/LLVMUtils.h"
 
+#include <algorithm>
 #include <vector>
 #include <set>
 
@@ -45,9 +47,7 @@ using namespace IGC;
 #define SUCCANYLOOP   (true)
 
 #define PUSHSUCC(BLK, C1, C2) \
-        for(succ_iterator succIter = succ_begin(BLK), succEnd = succ_end(BLK); \
-            succIter!=succEnd; ++succIter) {                                   \
-            llvm::BasicBlock *succ = *succIter;                                \
+        for(llvm::BasicBlock *succ : getVisitOrder(BLK)) {                     \
             if (!visitSet.count(succ) && C1 && C2) {                           \
                 visitVec.push_back(succ);                                      \
                 visitSet.insert(succ);                                         \
@@ -55,6 +55,38 @@ using namespace IGC;
             }                                                                  \
         }
 
+// Successors in DFS visit order. Blocks are placed in reverse post-order, so
+// the successor visited last ends up right after its predecessor. With a
+// block profile, visit the coldest successor first so the hottest one falls
+// through.
+static llvm::SmallVector<llvm::BasicBlock*, 4> getVisitOrder(llvm::BasicBlock *blk)
+{
+    llvm::SmallVector<llvm::BasicBlock*, 4> succs(succ_begin(blk), succ_end(blk));
+    llvm::SmallVector<uint64_t, 4> counts;
+    for (auto succ : succs)
+    {
+        uint64_t count = 0;
+        if (!getBlockProfileCount(succ, count))
+        {
+            return succs;
+        }
+        counts.push_back(count);
+    }
+    llvm::SmallVector<unsigned, 4> order;
+    for (unsigned i = 0; i < succs.size(); ++i)
+    {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&](unsigned a, unsigned b) { return counts[a] < counts[b]; });
+    llvm::SmallVector<llvm::BasicBlock*, 4> sorted;
+    for (unsigned i : order)
+    {
+        sorted.push_back(succs[i]);
+    }
+    return sorted;
+}
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-layout"
 #define PASS_DESCRIPTION "Layout blocks"
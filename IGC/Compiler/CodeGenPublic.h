@@ -35,11 +35,15 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/debug/Debug.hpp"
 #include "common/debug/Dump.hpp"
 #include <set>
+#include <memory>
 #include <string.h>
 #include "Compiler/CISACodeGen/ShaderUnits.hpp"
 #include "Compiler/CISACodeGen/Platform.hpp"
 #include "Compiler/CISACodeGen/DriverInfo.hpp"
 #include "Compiler/CISACodeGen/helper.h"
+#include "Compiler/CISACodeGen/KernelBinaryCache.hpp"
+#include "Compiler/CISACodeGen/LLVMContextPool.hpp"
+#include "Compiler/CISACodeGen/PassProfiler.hpp"
 #include "Compiler/MetaDataApi/MetaDataApi.h"
 #include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
 #include "Compiler/CodeGenContextWrapper.hpp"
@@ -54,6 +58,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/ADT/StringMap.h>
 #include <llvm/IR/IRBuilder.h>
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
 #include "llvm/IR/ValueMap.h"
 #include "common/LLVMWarningsPop.hpp"
 
@@ -82,6 +87,7 @@ namespace IGC
     class CodeGenContext;
     class PixelShaderContext;
     class ComputeShaderContext;
+    struct DwarfModuleInfo;
 
     struct SProgramOutput
     {
@@ -553,7 +559,7 @@ namespace IGC
         ~RetryManager();
 
         bool AdvanceState() {
-            if (!enabled || IGC_IS_FLAG_ENABLED(DisableRecompilation))
+            if (!enabled || disableRecompilation)
             {
                 return false;
             }
@@ -590,13 +596,20 @@ namespace IGC
         }
         bool IsLastTry() {
             return (!enabled ||
-                IGC_IS_FLAG_ENABLED(DisableRecompilation) ||
-                IGC_IS_FLAG_ENABLED(ForceOCLSIMDWidth) ||
+                disableRecompilation ||
+                forceSIMDWidth ||
                 (stateId < getStateCnt() &&
                 RetryTable[stateId].nextState >= getStateCnt()));
         }
 
-        void Enable() { enabled = true; }
+        /// The regkeys are resolved here so IsLastTry() and AdvanceState()
+        /// do not look them up on every query.
+        void Enable(const SRegKeyValues& regKeys)
+        {
+            enabled = true;
+            disableRecompilation = IGC_IS_FLAG_ENABLED_IN(regKeys, DisableRecompilation);
+            forceSIMDWidth = IGC_IS_FLAG_ENABLED_IN(regKeys, ForceOCLSIMDWidth);
+        }
         void Disable() { enabled = false; }
         
         void SetSpillSize(unsigned int spillSize) { lastSpillSize = spillSize; }
@@ -644,6 +657,8 @@ namespace IGC
 
         /// internal knob to disable retry manager.
         bool enabled;
+        bool disableRecompilation = false;
+        bool forceSIMDWidth = false;
 
         unsigned lastSpillSize = 0;
 
@@ -668,16 +683,143 @@ namespace IGC
         LLVMContextWrapper() {}
         /// ref count the LLVMContext as now CodeGenContext owns it
         unsigned int refCount = 0;
+        /// the context came from the LLVMContextPool and returns to it once released
+        bool m_pooled = false;
+        /// number of compilations that used this context
+        unsigned int m_compileCount = 0;
+        /// named struct types of the modules compiled in this context, renamed
+        /// away when the context is recycled
+        std::vector<llvm::StructType*> m_retiredStructTypes;
+        /// Record the named struct types of a module compiled in this context.
+        void retireStructTypes(const llvm::Module& M)
+        {
+            if (m_pooled)
+            {
+                std::vector<llvm::StructType*> types = M.getIdentifiedStructTypes();
+                m_retiredStructTypes.insert(m_retiredStructTypes.end(), types.begin(), types.end());
+            }
+        }
         /// IntrinsicIDCache - Cache of intrinsic pointer to numeric ID mappings
-        /// requested in this context
-        typedef llvm::ValueMap<const llvm::Function*, unsigned> SafeIntrinsicIDCacheTy;
-        SafeIntrinsicIDCacheTy m_SafeIntrinsicIDCache;
+        /// requested in this context. It is open-addressed on the function
+        /// address and a lookup only touches the dense key array; a value
+        /// handle per entry turns the key into a tombstone when its function
+        /// is deleted, so a recycled address never returns a stale ID.
+        class IntrinsicIDCache
+        {
+        public:
+            const unsigned* find(const llvm::Function* F) const
+            {
+                const size_t mask = m_keys.size() - 1;
+                for (size_t slot = hash(F) & mask; !m_keys.empty(); slot = (slot + 1) & mask)
+                {
+                    if (m_keys[slot] == F)
+                    {
+                        return &m_ids[slot];
+                    }
+                    if (m_keys[slot] == nullptr)
+                    {
+                        break;
+                    }
+                }
+                return nullptr;
+            }
+
+            void insert(const llvm::Function* F, unsigned id)
+            {
+                // keep the load factor, tombstones included, at or below 1/2
+                if ((m_handles.size() + 1) * 2 > m_keys.size())
+                {
+                    rehash();
+                }
+                m_handles.emplace_back(new Handle(this, F));
+                place(m_handles.back().get(), id);
+            }
+
+        private:
+            class Handle : public llvm::CallbackVH
+            {
+            public:
+                Handle(IntrinsicIDCache* cache, const llvm::Function* F) :
+                    llvm::CallbackVH(const_cast<llvm::Function*>(F)), m_cache(cache) {}
+                const llvm::Function* getFunction() const
+                {
+                    return static_cast<const llvm::Function*>(static_cast<llvm::Value*>(*this));
+                }
+                void deleted() override
+                {
+                    m_cache->m_keys[m_slot] = Tombstone();
+                    setValPtr(nullptr);
+                }
+                IntrinsicIDCache* m_cache;
+                size_t m_slot = 0;
+            };
+
+            static const llvm::Function* Tombstone()
+            {
+                return reinterpret_cast<const llvm::Function*>(~uintptr_t(0));
+            }
+            static size_t hash(const llvm::Function* F)
+            {
+                uintptr_t key = reinterpret_cast<uintptr_t>(F);
+                return (key >> 4) ^ (key >> 9);
+            }
+
+            void place(Handle* handle, unsigned id)
+            {
+                const size_t mask = m_keys.size() - 1;
+                size_t slot = hash(handle->getFunction()) & mask;
+                while (m_keys[slot] != nullptr)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                m_keys[slot] = handle->getFunction();
+                m_ids[slot] = id;
+                handle->m_slot = slot;
+            }
+
+            // Drops the entries of deleted functions and grows the table
+            // if the live ones still fill more than a quarter of it.
+            void rehash()
+            {
+                std::vector<unsigned> ids(m_ids);
+                std::vector<std::unique_ptr<Handle>> live;
+                for (auto& handle : m_handles)
+                {
+                    if (handle->getFunction() != nullptr)
+                    {
+                        live.push_back(std::move(handle));
+                    }
+                }
+                size_t size = m_keys.empty() ? 64 : m_keys.size();
+                while ((live.size() + 1) * 4 > size)
+                {
+                    size *= 2;
+                }
+                m_keys.assign(size, nullptr);
+                m_ids.assign(size, 0);
+                for (auto& handle : live)
+                {
+                    place(handle.get(), ids[handle->m_slot]);
+                }
+                m_handles.swap(live);
+            }
+
+            std::vector<const llvm::Function*> m_keys;
+            std::vector<unsigned> m_ids;
+            std::vector<std::unique_ptr<Handle>> m_handles;
+        };
+        IntrinsicIDCache m_IntrinsicIDCache;
         void AddRef() { refCount++; }
         void Release() 
         { 
             refCount--; 
             if (refCount == 0)
             {
+                if (m_pooled)
+                {
+                    LLVMContextPool::recycle(this);
+                    return;
+                }
                 delete this;
             }
         }
@@ -698,6 +840,8 @@ namespace IGC
         /// output: driver instrumentation
         TimeStats       *m_compilerTimeStats = nullptr;
         ShaderStats     *m_sumShaderStats = nullptr;
+        /// output: per pass profile, collected when EnablePassProfile is set
+        PassProfile     *m_passProfile = nullptr;
         // float 16, float32 and float64 denorm mode
         Float_DenormMode    m_floatDenormMode16 = FLOAT_DENORM_FLUSH_TO_ZERO;
         Float_DenormMode    m_floatDenormMode32 = FLOAT_DENORM_FLUSH_TO_ZERO;
@@ -740,6 +884,14 @@ namespace IGC
         bool m_EnableGetFreeGRFInfo = false;
         bool m_EnableSrclineMapping = false;
 
+        /// Debug info metadata gathered once from the module and shared by the
+        /// debug emitters of all kernels compiled from it.
+        std::shared_ptr<DwarfModuleInfo> m_dwarfModuleInfo;
+
+        /// Regkey values resolved for this shader's hash; see getRegKeys().
+        std::unique_ptr<const SRegKeyValues> m_regKeys;
+        unsigned long long m_regKeysHash = 0;
+
     protected:
         // Objects pointed to by these pointers are owned by this class.
         LLVMContextWrapper *llvmCtxWrapper;
@@ -770,9 +922,9 @@ namespace IGC
             m_indexableTempSize.resize(64);
         }
 
-        void initLLVMContextWrapper()
+        void initLLVMContextWrapper(LLVMContextWrapper* LLVMContext = nullptr)
         {
-            llvmCtxWrapper = new LLVMContextWrapper();
+            llvmCtxWrapper = LLVMContext ? LLVMContext : new LLVMContextWrapper();
             llvmCtxWrapper->AddRef();
         }
 
@@ -780,6 +932,10 @@ namespace IGC
             return llvmCtxWrapper;
         } 
 
+        LLVMContextWrapper* getLLVMContextWrapper() {
+            return llvmCtxWrapper;
+        }
+
         IGC::IGCMD::MetaDataUtils* getMetaDataUtils()
         {
             assert(m_pMdUtils && "Metadata Utils is not initialized");
@@ -788,8 +944,23 @@ namespace IGC
 
         llvm::Module* getModule() const { return module; }
 
+        /// Snapshot of the regkeys for this compilation, read through the
+        /// IGC_*_FLAG_*_CTX macros. The hash is assigned after construction,
+        /// so the snapshot is taken on first use and retaken only if the hash
+        /// changes; reads do not touch the process-wide regkey state.
+        const SRegKeyValues& getRegKeys()
+        {
+            if (!m_regKeys || m_regKeysHash != hash.asmHash.value)
+            {
+                m_regKeysHash = hash.asmHash.value;
+                m_regKeys.reset(new SRegKeyValues(m_regKeysHash));
+            }
+            return *m_regKeys;
+        }
+
         void setModule(llvm::Module *m)
         {
+            m_dwarfModuleInfo.reset();
             module = m;
             m_pMdUtils = new IGC::IGCMD::MetaDataUtils(m);
             modMD = new IGC::ModuleMetaData();
@@ -801,6 +972,7 @@ namespace IGC
         // delete in order to prevent deleting dangling pointers happening.
         void deleteModule()
         {
+            m_dwarfModuleInfo.reset();
             delete m_pMdUtils;
             delete modMD;
             delete module;
@@ -831,17 +1003,23 @@ namespace IGC
 
         virtual ~CodeGenContext()
         {
+            delete m_passProfile;
             clear();
         }
 
 
         void clear()
         {
+            m_dwarfModuleInfo.reset();
             delete modMD;
             delete m_pMdUtils;
             modMD = nullptr;
             m_pMdUtils = nullptr;
 
+            if (module)
+            {
+                llvmCtxWrapper->retireStructTypes(*module);
+            }
             delete module;
             llvmCtxWrapper->Release();
             module = nullptr;
@@ -1197,6 +1375,11 @@ namespace IGC
         bool isSpirV;
         float m_ProfilingTimerResolution;
         bool m_ShouldUseNonCoherentStatelessBTI;
+        // Incremental rebuilds (EnableKernelBinaryCache): the cache key of each
+        // kernel and the binaries of the kernels found in the cache, which are
+        // not code generated.
+        std::map<std::string, KernelCacheKey> m_kernelCacheKeys;
+        std::map<std::string, std::vector<char>> m_cachedKernelBinaries;
 
 		OpenCLProgramContext(
 			const COCLBTILayout& btiLayout,
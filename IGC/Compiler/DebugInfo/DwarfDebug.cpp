@@ -761,7 +761,7 @@ void DwarfDebug::beginModule()
         // Assume all functions belong to same Compile Unit
         // With LLVM 4.0 DISubprogram nodes are no longer
         // present in DICompileUnit node.
-        for (auto& DISP : DISubprogramNodes)
+        for (auto& DISP : ModuleInfo->DISubprogramNodes)
         {
             constructSubprogramDIE(CU, DISP);
         }
@@ -814,7 +814,7 @@ void DwarfDebug::collectDeadVariables()
     {
         DICompileUnit* TheCU = cast<DICompileUnit>(CU_Nodes->getOperand(i));
 
-        for(auto& SP : DISubprogramNodes)
+        for(auto& SP : ModuleInfo->DISubprogramNodes)
         {
             if (!SP)
                 continue;
@@ -2001,11 +2001,26 @@ void DwarfDebug::gatherDISubprogramNodes()
     // iterates over all instructions to find unique DISubprogram
     // nodes and stores them in an std::set for other functions
     // to iterate over.
+    // Every kernel compiled from the module needs the same nodes, so
+    // the walk is done only once per CodeGenContext.
 
-    DISubprogramNodes.clear();
-    DISPToFunction.clear();
+    const Module* M = m_pModule->GetModule();
+    std::shared_ptr<DwarfModuleInfo>& cachedInfo =
+        m_pModule->m_pShader->GetContext()->m_dwarfModuleInfo;
 
-    for (auto& F : *m_pModule->GetModule())
+    if (cachedInfo && cachedInfo->M == M)
+    {
+        ModuleInfo = cachedInfo;
+        m_pModule->setDISPToFuncMap(&ModuleInfo->DISPToFunction);
+        return;
+    }
+
+    ModuleInfo = std::make_shared<DwarfModuleInfo>();
+    ModuleInfo->M = M;
+    auto& DISubprogramNodes = ModuleInfo->DISubprogramNodes;
+    auto& DISPToFunction = ModuleInfo->DISPToFunction;
+
+    for (auto& F : *M)
     {
         for (auto& bb : F)
         {
@@ -2035,6 +2050,7 @@ void DwarfDebug::gatherDISubprogramNodes()
         }
     }
 
+    cachedInfo = ModuleInfo;
     m_pModule->setDISPToFuncMap(&DISPToFunction);
 }
 
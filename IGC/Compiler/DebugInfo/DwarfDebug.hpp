@@ -60,6 +60,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/DebugInfo/LexicalScopes.hpp"
 
 #include <set>
+#include <map>
+#include <memory>
 
 namespace llvm
 {
@@ -214,6 +216,17 @@ namespace IGC
         CompileUnit *CU;
     };
 
+    /// \brief DISubprogram nodes of an LLVM IR module as they are no longer
+    /// available in DICompileUnit. Finding them requires a walk over every
+    /// instruction of the module, so the result is cached in the
+    /// CodeGenContext and reused by the DwarfDebug instance of each kernel.
+    struct DwarfModuleInfo
+    {
+        const llvm::Module* M = nullptr;
+        std::set<llvm::DISubprogram*> DISubprogramNodes;
+        std::map<llvm::DISubprogram*, const llvm::Function*> DISPToFunction;
+    };
+
     /// \brief Collects and handles llvm::dwarf debug information.
     class DwarfDebug
     {
@@ -550,10 +563,9 @@ namespace IGC
 
         //Following added during LLVM 4.0 upgrade
     private:
-        // Store all DISubprogram nodes from LLVM IR as they are no longer available
-        // in DICompileUnit
-        std::set<llvm::DISubprogram*> DISubprogramNodes;
-        std::map<llvm::DISubprogram*, const llvm::Function*> DISPToFunction;
+        // DISubprogram nodes gathered from the whole LLVM IR module, shared
+        // with the other kernels compiled from the same module.
+        std::shared_ptr<DwarfModuleInfo> ModuleInfo;
 
         void gatherDISubprogramNodes();
     };
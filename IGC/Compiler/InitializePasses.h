@@ -37,6 +37,7 @@ void initializeAlignmentAnalysisPass(llvm::PassRegistry&);
 void initializePreBIImportAnalysisPass(llvm::PassRegistry&);
 void initializeBIImportPass(llvm::PassRegistry&);
 void initializeBlockCoalescingPass( llvm::PassRegistry& );
+void initializeBlockProfileAnnotationPass(llvm::PassRegistry&);
 void initializeBreakConstantExprPass(llvm::PassRegistry&);
 void initializeBuiltinCallGraphAnalysisPass(llvm::PassRegistry&);
 void initializeBuiltinsConverterPass(llvm::PassRegistry&);
@@ -101,6 +102,7 @@ void initializeResolveOCLAtomicsPass(llvm::PassRegistry&);
 void initializeResourceAllocatorPass(llvm::PassRegistry&);
 void initializeScalarizeFunctionPass(llvm::PassRegistry&);
 void initializeSimd32ProfitabilityAnalysisPass(llvm::PassRegistry&);
+void initializeSimdWidthPredictionAnalysisPass(llvm::PassRegistry&);
 void initializeSetFastMathFlagsPass(llvm::PassRegistry&);
 void initializeSPIRMetaDataTranslationPass(llvm::PassRegistry&);
 void initializeSubGroupFuncsResolutionPass(llvm::PassRegistry&);
@@ -349,12 +349,19 @@ bool BIImport::runOnModule(Module &M)
         }
     };
 
+    // The types of the builtins are only complete once materialized. A pooled
+    // LLVM context must free their names too, including the names of types
+    // that are not linked in or that later passes remove.
+    LLVMContextWrapper* pCtxWrapper =
+        getAnalysis<CodeGenContextWrapper>().getCodeGenContext()->getLLVMContextWrapper();
+
     CleanUnused(m_GenericModule.get());
     Linker ld(M);
 
     if (Error err = m_GenericModule->materializeAll()) {
         assert(0 && "materializeAll failed for generic builtin module");
     }
+    pCtxWrapper->retireStructTypes(*m_GenericModule);
 
     if (ld.linkInModule(std::move(m_GenericModule)))
     {
@@ -368,6 +375,7 @@ bool BIImport::runOnModule(Module &M)
         {
             assert(0 && "materializeAll failed for size_t builtin module");
         }
+        pCtxWrapper->retireStructTypes(*m_SizeModule);
 
         if (ld.linkInModule(std::move(m_SizeModule)))
         {
@@ -375,6 +383,8 @@ bool BIImport::runOnModule(Module &M)
         }
     }
 
+    pCtxWrapper->retireStructTypes(M);
+
     InitializeBIFlags(M);
     removeFunctionBitcasts(M);
 
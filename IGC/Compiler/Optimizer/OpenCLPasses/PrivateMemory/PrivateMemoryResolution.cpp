@@ -32,8 +32,12 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Compiler/CISACodeGen/GenCodeGenModule.h"
 
 #include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/CFG.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Dominators.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "common/LLVMWarningsPop.hpp"
 
 using namespace llvm;
@@ -46,8 +50,9 @@ namespace IGC {
 class ModuleAllocaInfo {
 public:
   ModuleAllocaInfo(Module *M, const DataLayout *DL,
-                   GenXFunctionGroupAnalysis *FGA = nullptr)
-      : M(M), DL(DL), FGA(FGA) {
+                   GenXFunctionGroupAnalysis *FGA = nullptr,
+                   bool ColorSlots = false)
+      : M(M), DL(DL), FGA(FGA), ColorSlots(ColorSlots) {
     analyze();
   }
 
@@ -92,6 +97,9 @@ private:
   /// \brief The optional function group analysis.
   GenXFunctionGroupAnalysis *FGA;
 
+  /// \brief Whether allocas with disjoint lifetimes may share buffer space.
+  bool ColorSlots;
+
   struct FunctionAllocaInfo {
     FunctionAllocaInfo() : TotalSize(0) {}
 
@@ -136,6 +144,13 @@ private:
   /// \brief Analyze individual functions.
   void analyze(Function *F, unsigned &gOffset, unsigned &gAlignment);
 
+  /// \brief Try to overlap allocas whose lifetimes do not interfere. On
+  /// success, Offsets and End are updated with the smaller layout.
+  bool colorAllocas(Function *F, ArrayRef<AllocaInst *> Allocas,
+                    ArrayRef<unsigned> Sizes, ArrayRef<unsigned> Alignments,
+                    unsigned StartOffset, SmallVectorImpl<unsigned> &Offsets,
+                    unsigned &End);
+
   /// \brief Each function has an entry that describes its private memory
   /// usage information.
   DenseMap<Function *, FunctionAllocaInfo *> InfoMap;
@@ -227,10 +242,14 @@ void ModuleAllocaInfo::analyze(Function *F, unsigned &Offset,
     return getAlignment(AI1) < getAlignment(AI2);
   });
 
+  SmallVector<unsigned, 8> Sizes;
+  SmallVector<unsigned, 8> Alignments;
+  SmallVector<unsigned, 8> Offsets;
+  unsigned End = Offset;
   for (auto AI : Allocas) {
     // Align alloca offset.
     unsigned Alignment = getAlignment(AI);
-    Offset = iSTD::Align(Offset, Alignment);
+    End = iSTD::Align(End, Alignment);
 
     // Keep track of the maximal alignment seen so far.
     if (Alignment > MaxAlignment)
@@ -241,16 +260,201 @@ void ModuleAllocaInfo::analyze(Function *F, unsigned &Offset,
     ConstantInt *SizeVal = cast<ConstantInt>(AI->getArraySize());
     unsigned CurSize = (unsigned)(SizeVal->getZExtValue() *
                                   DL->getTypeAllocSize(AI->getAllocatedType()));
-    AllocaInfo->setAllocaDesc(AI, Offset, CurSize);
+    Sizes.push_back(CurSize);
+    Alignments.push_back(Alignment);
+    Offsets.push_back(End);
 
     // Increment the current offset for the next alloca.
-    Offset += CurSize;
+    End += CurSize;
   }
 
+  // Let allocas with disjoint lifetimes share space when that shrinks the
+  // buffer; otherwise keep them packed back to back.
+  if (ColorSlots && Allocas.size() > 1)
+    colorAllocas(F, Allocas, Sizes, Alignments, Offset, Offsets, End);
+
+  for (unsigned i = 0, e = Allocas.size(); i != e; ++i)
+    AllocaInfo->setAllocaDesc(Allocas[i], Offsets[i], Sizes[i]);
+  Offset = End;
+
   // Update collected allocas into the function alloca info object.
   AllocaInfo->Allocas.swap(Allocas);
 }
 
+// Stack slot coloring for private buffers. Each alloca marked with
+// llvm.lifetime.start/end gets a set of live ranges over a linear numbering of
+// the function's instructions, computed from a block-level may-be-live
+// dataflow. Allocas without complete markers are live everywhere. Slots are
+// then placed largest first at the lowest aligned offset that does not
+// overlap a slot with an interfering range.
+bool ModuleAllocaInfo::colorAllocas(Function *F,
+                                    ArrayRef<AllocaInst *> Allocas,
+                                    ArrayRef<unsigned> Sizes,
+                                    ArrayRef<unsigned> Alignments,
+                                    unsigned StartOffset,
+                                    SmallVectorImpl<unsigned> &Offsets,
+                                    unsigned &End) {
+  unsigned NumSlots = Allocas.size();
+  DenseMap<AllocaInst *, unsigned> SlotMap;
+  for (unsigned i = 0; i != NumSlots; ++i)
+    SlotMap[Allocas[i]] = i;
+
+  // Collect lifetime markers. A marker that covers only part of an alloca, or
+  // that is placed on a derived pointer, makes the alloca uncolorable.
+  BitVector HasStart(NumSlots), HasEnd(NumSlots), Invalid(NumSlots);
+  DenseMap<Instruction *, std::pair<unsigned, bool>> Markers;
+  for (auto &BB : *F) {
+    for (auto &I : BB) {
+      auto II = dyn_cast<IntrinsicInst>(&I);
+      if (!II || (II->getIntrinsicID() != Intrinsic::lifetime_start &&
+                  II->getIntrinsicID() != Intrinsic::lifetime_end))
+        continue;
+      Value *Ptr = II->getArgOperand(1);
+      auto AI = dyn_cast<AllocaInst>(Ptr->stripPointerCasts());
+      if (!AI) {
+        auto UO = dyn_cast<AllocaInst>(GetUnderlyingObject(Ptr, *DL));
+        if (UO && SlotMap.count(UO))
+          Invalid.set(SlotMap[UO]);
+        continue;
+      }
+      auto SI = SlotMap.find(AI);
+      if (SI == SlotMap.end())
+        continue;
+      unsigned Slot = SI->second;
+      auto Size = cast<ConstantInt>(II->getArgOperand(0));
+      if (!Size->isMinusOne() && Size->getZExtValue() < Sizes[Slot])
+        Invalid.set(Slot);
+      bool IsStart = II->getIntrinsicID() == Intrinsic::lifetime_start;
+      if (IsStart)
+        HasStart.set(Slot);
+      else
+        HasEnd.set(Slot);
+      Markers[II] = std::make_pair(Slot, IsStart);
+    }
+  }
+
+  BitVector Tracked = HasStart;
+  Tracked &= HasEnd;
+  Tracked.reset(Invalid);
+  if (Tracked.count() < 2)
+    return false;
+
+  // Per-block summary: slots whose last marker in the block is a start (Gen)
+  // or an end (Kill).
+  DenseMap<BasicBlock *, BitVector> Gen, Kill, LiveIn, LiveOut;
+  for (auto &BB : *F) {
+    BitVector G(NumSlots), K(NumSlots);
+    for (auto &I : BB) {
+      auto MI = Markers.find(&I);
+      if (MI == Markers.end())
+        continue;
+      unsigned Slot = MI->second.first;
+      if (MI->second.second) {
+        G.set(Slot);
+        K.reset(Slot);
+      } else {
+        K.set(Slot);
+        G.reset(Slot);
+      }
+    }
+    Gen[&BB] = G;
+    Kill[&BB] = K;
+    LiveIn[&BB] = BitVector(NumSlots);
+    LiveOut[&BB] = G;
+  }
+
+  for (bool Changed = true; Changed;) {
+    Changed = false;
+    for (auto &BB : *F) {
+      BitVector In(NumSlots);
+      for (auto PI = pred_begin(&BB), PE = pred_end(&BB); PI != PE; ++PI)
+        In |= LiveOut[*PI];
+      BitVector Out = In;
+      Out.reset(Kill[&BB]);
+      Out |= Gen[&BB];
+      if (In != LiveIn[&BB] || Out != LiveOut[&BB]) {
+        LiveIn[&BB] = In;
+        LiveOut[&BB] = Out;
+        Changed = true;
+      }
+    }
+  }
+
+  // Turn liveness into half-open ranges of instruction numbers.
+  SmallVector<SmallVector<std::pair<unsigned, unsigned>, 4>, 8> Ranges(NumSlots);
+  SmallVector<unsigned, 8> Open(NumSlots, ~0U);
+  unsigned Idx = 0;
+  for (auto &BB : *F) {
+    unsigned BlockStart = Idx;
+    BitVector &In = LiveIn[&BB];
+    for (unsigned Slot = 0; Slot != NumSlots; ++Slot)
+      Open[Slot] = In.test(Slot) ? BlockStart : ~0U;
+    for (auto &I : BB) {
+      ++Idx;
+      auto MI = Markers.find(&I);
+      if (MI == Markers.end())
+        continue;
+      unsigned Slot = MI->second.first;
+      if (MI->second.second) {
+        if (Open[Slot] == ~0U)
+          Open[Slot] = Idx;
+      } else if (Open[Slot] != ~0U) {
+        Ranges[Slot].push_back(std::make_pair(Open[Slot], Idx + 1));
+        Open[Slot] = ~0U;
+      }
+    }
+    for (unsigned Slot = 0; Slot != NumSlots; ++Slot)
+      if (Open[Slot] != ~0U)
+        Ranges[Slot].push_back(std::make_pair(Open[Slot], Idx + 1));
+  }
+
+  auto interfere = [&](unsigned A, unsigned B) {
+    if (!Tracked.test(A) || !Tracked.test(B))
+      return true;
+    for (auto &RA : Ranges[A])
+      for (auto &RB : Ranges[B])
+        if (RA.first < RB.second && RB.first < RA.second)
+          return true;
+    return false;
+  };
+
+  SmallVector<unsigned, 8> Order;
+  for (unsigned Slot = 0; Slot != NumSlots; ++Slot)
+    Order.push_back(Slot);
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return Sizes[A] > Sizes[B];
+  });
+
+  SmallVector<unsigned, 8> NewOffsets(NumSlots, 0);
+  SmallVector<unsigned, 8> Placed;
+  unsigned NewEnd = StartOffset;
+  for (unsigned Slot : Order) {
+    unsigned Candidate = iSTD::Align(StartOffset, Alignments[Slot]);
+    for (bool Moved = true; Moved;) {
+      Moved = false;
+      for (unsigned Other : Placed) {
+        unsigned OtherEnd = NewOffsets[Other] + Sizes[Other];
+        if (Candidate < OtherEnd &&
+            NewOffsets[Other] < Candidate + Sizes[Slot] &&
+            interfere(Slot, Other)) {
+          Candidate = iSTD::Align(OtherEnd, Alignments[Slot]);
+          Moved = true;
+        }
+      }
+    }
+    NewOffsets[Slot] = Candidate;
+    NewEnd = std::max(NewEnd, Candidate + Sizes[Slot]);
+    Placed.push_back(Slot);
+  }
+
+  if (NewEnd >= End)
+    return false;
+
+  Offsets.assign(NewOffsets.begin(), NewOffsets.end());
+  End = NewEnd;
+  return true;
+}
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-private-mem-resolution"
 #define PASS_DESCRIPTION "Resolves private memory allocation"
@@ -409,11 +613,16 @@ bool PrivateMemoryResolution::runOnModule(llvm::Module &M)
     auto *FGA = getAnalysisIfAvailable<GenXFunctionGroupAnalysis>();
     bool changed = false;
 
-    ModuleAllocaInfo MemInfo(&M, DL, FGA);
-    m_ModAllocaInfo = &MemInfo;
-
     ModuleMetaData &modMD = *getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
 
+    // Sharing buffer space between allocas would make variables with ended
+    // lifetimes show garbage in the debugger, so keep the plain layout when
+    // optimizations are disabled.
+    bool colorSlots = IGC_IS_FLAG_ENABLED(EnablePrivateMemorySlotColoring) &&
+                      !modMD.compOpt.OptDisable;
+    ModuleAllocaInfo MemInfo(&M, DL, FGA, colorSlots);
+    m_ModAllocaInfo = &MemInfo;
+
     // This is the only place to initialize and define UseScratchSpacePrivateMemory.
     // we do not use scratch-space if any kernel uses stack-call because,
     // in order to use scratch-space, we change data-layout for the module,
@@ -670,8 +879,11 @@ bool PrivateMemoryResolution::resolveAllocaInstuctions(bool stackCall)
             // Cases to be handled here need to skip memopt to avoid merging load/store.
             bool TransposeMemLayout = false;
             Type* pTypeOfAccessedObject = nullptr;
+            bool selectLayoutPerBuffer =
+                !Ctx.m_DriverInfo.SupportTransposeLayoutForPrivateMemory() &&
+                IGC_IS_FLAG_ENABLED(EnablePrivateMemoryLayoutSelection);
 
-            if (Ctx.m_DriverInfo.SupportTransposeLayoutForPrivateMemory())
+            if (Ctx.m_DriverInfo.SupportTransposeLayoutForPrivateMemory() || selectLayoutPerBuffer)
             {
                 TransposeMemLayout = true;
 
@@ -719,6 +931,19 @@ bool PrivateMemoryResolution::resolveAllocaInstuctions(bool stackCall)
                         TransposeMemLayout = false;
                     }
                 }
+
+                if (TransposeMemLayout && selectLayoutPerBuffer)
+                {
+                    // Scratch messages move whole dwords per lane. SoA puts
+                    // the same element of adjacent lanes next to each other,
+                    // so one message covers full lines only when elements are
+                    // dword multiples. Byte and word elements stay AoS.
+                    auto DL = &m_currFunction->getParent()->getDataLayout();
+                    if (DL->getTypeAllocSize(pTypeOfAccessedObject) % 4 != 0)
+                    {
+                        TransposeMemLayout = false;
+                    }
+                }
             }
             unsigned int bufferSize = 0;
             if (TransposeMemLayout)
@@ -36,6 +36,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
 #include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Support/CommandLine.h>
 #include "common/LLVMWarningsPop.hpp"
 
 #include <string>
@@ -44,6 +45,15 @@ using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
 
+static cl::opt<bool> IndVarOverride(
+    "igc-stateless-to-statefull-indvar", cl::init(false), cl::Hidden,
+    cl::desc("Promote loop-indexed accesses as if EnableStatelessToStatefullIndVar were set"));
+
+static bool isIndVarEnabled()
+{
+    return IndVarOverride || IGC_IS_FLAG_ENABLED(EnableStatelessToStatefullIndVar);
+}
+
 // Register pass to igc-opt
 #define PASS_FLAG "igc-stateless-to-statefull-resolution"
 #define PASS_DESCRIPTION "Tries to convert stateless to statefull accesses"
@@ -173,6 +183,7 @@ bool StatelessToStatefull::runOnFunction(llvm::Function &F)
     visit(F);
 
 	finalizeArgInitialValue(&F);
+    m_phiOffsets.clear();
     delete m_pImplicitArgs;
 	delete m_pKernelArgs;
     return m_changed;
@@ -210,29 +221,50 @@ bool StatelessToStatefull::getOffsetFromGEP(
     Function* F, SmallVector<GetElementPtrInst*, 4> GEPs,
     uint32_t argNumber, bool isImplicitArg, Value*& offset)
 {
-    Module* M = F->getParent();
-    const DataLayout* DL = &M->getDataLayout();
-    Type* int32Ty = Type::getInt32Ty(M->getContext());
+    Value *PointerValue = getBaseOffset(F, argNumber, isImplicitArg);
+    if (PointerValue == nullptr)
+    {
+        // Sanity check
+        return false;
+    }
+
+    addGEPOffsets(F, GEPs, PointerValue);
+    offset = PointerValue;
+    return true;
+}
+
+//
+// Return the offset of the kernel argument itself within its surface.
+//
+Value* StatelessToStatefull::getBaseOffset(Function* F, uint32_t argNumber, bool isImplicitArg)
+{
+    Type* int32Ty = Type::getInt32Ty(F->getContext());
 
-    Value *PointerValue;
     // When SToSProducesPositivePointer is set, BUFFER_OFFSET are assumed to be zero,
     // so is that for any implicit argument 
     if (m_hasBufferOffsetArg && !isImplicitArg &&
         IGC_IS_FLAG_DISABLED(SToSProducesPositivePointer))
     {
-        PointerValue = getBufferOffsetArg(F, argNumber);
-        if (PointerValue == nullptr)
-        {
-            // Sanity check
-            return false;
-        }
-    }
-    else
-    {
-        // BUFFER_OFFSET are zero.
-        PointerValue = ConstantInt::get(int32Ty, 0);
+        return getBufferOffsetArg(F, argNumber);
     }
 
+    // BUFFER_OFFSET are zero.
+    return ConstantInt::get(int32Ty, 0);
+}
+
+//
+// Add the byte offsets of GEPs to 'offset'. The address computation for each
+// GEP is inserted right before it.
+//
+void StatelessToStatefull::addGEPOffsets(
+    Function* F, SmallVector<GetElementPtrInst*, 4>& GEPs, Value*& offset)
+{
+    Module* M = F->getParent();
+    const DataLayout* DL = &M->getDataLayout();
+    Type* int32Ty = Type::getInt32Ty(M->getContext());
+
+    Value *PointerValue = offset;
+
     const int nGEPs = GEPs.size();
 
     // GEPs is in the reverse order of execution! The last GEP is the first
@@ -301,9 +333,208 @@ bool StatelessToStatefull::getOffsetFromGEP(
         }
     }
     offset = PointerValue;
+}
+
+//
+// Strip pointer casts and GEPs off V, collecting the GEPs in reverse order of
+// execution like pointerIsPositiveOffsetFromKernelArgument does. Returns
+// nullptr if any GEP is in a different address space.
+//
+Value* StatelessToStatefull::stripGEPs(
+    Value* V, unsigned AS, SmallVector<GetElementPtrInst*, 4>& GEPs)
+{
+    Value* base = V->stripPointerCasts();
+    while (GetElementPtrInst* gep = dyn_cast<GetElementPtrInst>(base))
+    {
+        if (gep->getAddressSpace() != AS)
+        {
+            return nullptr;
+        }
+        GEPs.push_back(gep);
+        base = gep->getPointerOperand()->stripPointerCasts();
+    }
+    return base;
+}
+
+//
+// Value-range check for GEP indices. On top of known bits, this follows
+// extensions, no-signed-wrap arithmetic and selects, and handles induction
+// variables: a phi already being visited is assumed to be non-negative, which
+// holds by induction if every incoming value is non-negative under that
+// assumption.
+//
+bool StatelessToStatefull::isNonNegativeIndex(
+    Value* V, const DataLayout* DL, SmallPtrSetImpl<PHINode*>& visiting, unsigned depth)
+{
+    if (valueIsPositive(V, DL))
+    {
+        return true;
+    }
+    if (!isIndVarEnabled() || depth > 8)
+    {
+        return false;
+    }
+
+    if (isa<ZExtInst>(V))
+    {
+        return true;
+    }
+    if (SExtInst* SE = dyn_cast<SExtInst>(V))
+    {
+        return isNonNegativeIndex(SE->getOperand(0), DL, visiting, depth + 1);
+    }
+    if (SelectInst* SI = dyn_cast<SelectInst>(V))
+    {
+        return isNonNegativeIndex(SI->getTrueValue(), DL, visiting, depth + 1) &&
+               isNonNegativeIndex(SI->getFalseValue(), DL, visiting, depth + 1);
+    }
+    if (PHINode* PN = dyn_cast<PHINode>(V))
+    {
+        if (!visiting.insert(PN).second)
+        {
+            return true;
+        }
+        bool isNonNegative = true;
+        for (Value* incoming : PN->incoming_values())
+        {
+            if (!isNonNegativeIndex(incoming, DL, visiting, depth + 1))
+            {
+                isNonNegative = false;
+                break;
+            }
+        }
+        visiting.erase(PN);
+        return isNonNegative;
+    }
+    if (BinaryOperator* BO = dyn_cast<BinaryOperator>(V))
+    {
+        Value* Op0 = BO->getOperand(0);
+        Value* Op1 = BO->getOperand(1);
+        switch (BO->getOpcode())
+        {
+        case Instruction::Add:
+        case Instruction::Mul:
+        case Instruction::Shl:
+            return BO->hasNoSignedWrap() &&
+                   isNonNegativeIndex(Op0, DL, visiting, depth + 1) &&
+                   isNonNegativeIndex(Op1, DL, visiting, depth + 1);
+        case Instruction::SDiv:
+            return isNonNegativeIndex(Op0, DL, visiting, depth + 1) &&
+                   isNonNegativeIndex(Op1, DL, visiting, depth + 1);
+        case Instruction::UDiv:
+        case Instruction::SRem:
+        case Instruction::URem:
+            return isNonNegativeIndex(Op0, DL, visiting, depth + 1);
+        case Instruction::And:
+            return isNonNegativeIndex(Op0, DL, visiting, depth + 1) ||
+                   isNonNegativeIndex(Op1, DL, visiting, depth + 1);
+        case Instruction::LShr:
+            if (ConstantInt* CI = dyn_cast<ConstantInt>(Op1))
+            {
+                if (!CI->isZero())
+                {
+                    return true;
+                }
+            }
+            return isNonNegativeIndex(Op0, DL, visiting, depth + 1);
+        default:
+            break;
+        }
+    }
+    return false;
+}
+
+bool StatelessToStatefull::indicesAreNonNegative(
+    SmallVector<GetElementPtrInst*, 4>& GEPs, const DataLayout* DL)
+{
+    SmallPtrSet<PHINode*, 8> visiting;
+    for (GetElementPtrInst* gep : GEPs)
+    {
+        for (auto U = gep->idx_begin(), E = gep->idx_end(); U != E; ++U)
+        {
+            if (!isNonNegativeIndex(U->get(), DL, visiting))
+            {
+                return false;
+            }
+        }
+    }
     return true;
 }
 
+//
+// If every incoming value of the pointer phi PN is either a kernel argument
+// or PN itself, each possibly offset by GEPs, return that kernel argument.
+// isPositive is set to whether all of those GEP indices are non-negative.
+//
+Value* StatelessToStatefull::getPointerPhiBase(PHINode* PN, unsigned AS, bool& isPositive)
+{
+    const DataLayout* DL = &PN->getModule()->getDataLayout();
+    Value* argBase = nullptr;
+    isPositive = true;
+    for (Value* incoming : PN->incoming_values())
+    {
+        SmallVector<GetElementPtrInst*, 4> GEPs;
+        Value* base = stripGEPs(incoming, AS, GEPs);
+        if (base == nullptr)
+        {
+            return nullptr;
+        }
+        if (base != PN)
+        {
+            if (isa<Instruction>(base) || !getKernelArg(base) ||
+                (argBase && argBase != base))
+            {
+                return nullptr;
+            }
+            argBase = base;
+        }
+        isPositive &= indicesAreNonNegative(GEPs, DL);
+    }
+    return argBase;
+}
+
+//
+// Create (once per phi) the i32 offset phi that mirrors the pointer phi PN.
+//
+Value* StatelessToStatefull::getPointerPhiOffset(
+    Function* F, PHINode* PN, uint32_t argNumber, bool isImplicitArg)
+{
+    auto I = m_phiOffsets.find(PN);
+    if (I != m_phiOffsets.end())
+    {
+        return I->second;
+    }
+
+    Value* baseOffset = getBaseOffset(F, argNumber, isImplicitArg);
+    if (baseOffset == nullptr)
+    {
+        return nullptr;
+    }
+
+    unsigned AS = PN->getType()->getPointerAddressSpace();
+    PHINode* offsetPhi = PHINode::Create(
+        Type::getInt32Ty(F->getContext()), PN->getNumIncomingValues(),
+        "", PN);
+    // A predecessor listed more than once (e.g. several switch cases) must
+    // get the same incoming offset each time.
+    SmallDenseMap<BasicBlock*, Value*, 4> blockOffsets;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+    {
+        BasicBlock* incomingBB = PN->getIncomingBlock(i);
+        Value*& offset = blockOffsets[incomingBB];
+        if (offset == nullptr)
+        {
+            SmallVector<GetElementPtrInst*, 4> GEPs;
+            Value* base = stripGEPs(PN->getIncomingValue(i), AS, GEPs);
+            offset = (base == PN) ? offsetPhi : baseOffset;
+            addGEPOffsets(F, GEPs, offset);
+        }
+        offsetPhi->addIncoming(offset, incomingBB);
+    }
+    m_phiOffsets[PN] = offsetPhi;
+    return offsetPhi;
+}
+
 bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
     Function* F,Value* V, Value*& offset, unsigned int& argNumber)
 {
@@ -327,9 +558,28 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
         base = gep->getPointerOperand()->stripPointerCasts();
     }
 
+    // A pointer induction variable, e.g. "p = phi [arg, ...], [p + i, ...]",
+    // is rewritten into an offset phi when it only ever moves forward from a
+    // single kernel argument.
+    PHINode* ptrPhi = nullptr;
+    bool phiProducesPositivePointer = true;
+    if (isIndVarEnabled() &&
+        (!gep || gep->getAddressSpace() == ptrAS))
+    {
+        PHINode* PN = dyn_cast<PHINode>(base);
+        if (PN && PN->getType()->getPointerAddressSpace() == ptrAS)
+        {
+            if (Value* phiBase = getPointerPhiBase(PN, ptrAS, phiProducesPositivePointer))
+            {
+                ptrPhi = PN;
+                base = phiBase;
+            }
+        }
+    }
+
     // stripPointerCasts might skip addrSpaceCast, thus check if AS is still
     // the original one. Also, if base is still instruction, skip.
-    if ((gep && gep->getAddressSpace() == ptrAS) && !isa<Instruction>(base))
+    if (((gep && gep->getAddressSpace() == ptrAS) || ptrPhi) && !isa<Instruction>(base))
     {
         if (const KernelArg* arg = getKernelArg(base))
         {
@@ -349,16 +599,9 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
                 // [This is conservative path]
                 // Need to verify if there is a negative offset,
                 // If so, no stateful message is generated.
-                for (int i=0, sz = GEPs.size(); i < sz; ++i)
-                {
-                    GetElementPtrInst* tgep = GEPs[i];
-                    for (auto U = tgep->idx_begin(), E = tgep->idx_end(); U != E; ++U)
-                    {
-                        Value *Idx = U->get();
-                        gepProducesPositivePointer &=
-                            valueIsPositive(Idx, &(F->getParent()->getDataLayout()));
-                    }
-                }
+                gepProducesPositivePointer =
+                    indicesAreNonNegative(GEPs, &(F->getParent()->getDataLayout())) &&
+                    phiProducesPositivePointer;
 
 				if (IGC_IS_FLAG_ENABLED(EnableOptionalBufferOffset) &&
 					m_hasBufferOffsetArg)
@@ -366,7 +609,16 @@ bool StatelessToStatefull::pointerIsPositiveOffsetFromKernelArgument(
 					updateArgInfo(arg, gepProducesPositivePointer);
 				}
             }
-            if (gepProducesPositivePointer &&
+            if (gepProducesPositivePointer && ptrPhi)
+            {
+                offset = getPointerPhiOffset(F, ptrPhi, argNumber, arg->isImplicitArg());
+                if (offset)
+                {
+                    addGEPOffsets(F, GEPs, offset);
+                    return true;
+                }
+            }
+            else if (gepProducesPositivePointer &&
                 getOffsetFromGEP(F, GEPs, argNumber, arg->isImplicitArg(), offset))
             {
                 return true;
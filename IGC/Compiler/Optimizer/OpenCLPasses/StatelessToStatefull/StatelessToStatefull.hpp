@@ -73,6 +73,22 @@ namespace IGC
         bool getOffsetFromGEP(
             llvm::Function* F, llvm::SmallVector<llvm::GetElementPtrInst*, 4> GEPs,
             uint32_t argNumber, bool isImplicitArg, llvm::Value*& offset);
+        llvm::Value* getBaseOffset(llvm::Function* F, uint32_t argNumber, bool isImplicitArg);
+        void addGEPOffsets(
+            llvm::Function* F, llvm::SmallVector<llvm::GetElementPtrInst*, 4>& GEPs,
+            llvm::Value*& offset);
+
+        // Range and induction analysis used to promote loop-indexed accesses.
+        llvm::Value* stripGEPs(
+            llvm::Value* V, unsigned AS, llvm::SmallVector<llvm::GetElementPtrInst*, 4>& GEPs);
+        bool isNonNegativeIndex(
+            llvm::Value* V, const llvm::DataLayout* DL,
+            llvm::SmallPtrSetImpl<llvm::PHINode*>& visiting, unsigned depth = 0);
+        bool indicesAreNonNegative(
+            llvm::SmallVector<llvm::GetElementPtrInst*, 4>& GEPs, const llvm::DataLayout* DL);
+        llvm::Value* getPointerPhiBase(llvm::PHINode* PN, unsigned AS, bool& isPositive);
+        llvm::Value* getPointerPhiOffset(
+            llvm::Function* F, llvm::PHINode* PN, uint32_t argNumber, bool isImplicitArg);
         llvm::Argument* getBufferOffsetArg(llvm::Function* F, uint32_t ArgNumber);
         void setPointerSizeTo32bit(int32_t AddrSpace, llvm::Module* M);
 
@@ -107,6 +123,8 @@ namespace IGC
         ImplicitArgs *m_pImplicitArgs;
 		KernelArgs   *m_pKernelArgs;
 		ArgInfoMap   m_argsInfo;
+        // i32 offset phi created for each promoted pointer phi.
+        llvm::DenseMap<llvm::PHINode*, llvm::Value*> m_phiOffsets;
         bool m_changed;
     };
 
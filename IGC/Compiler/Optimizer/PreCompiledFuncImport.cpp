@@ -45,9 +45,15 @@ const unsigned char igcbuiltin_emu_sp_div[] = {0};
 
 #include "common/LLVMWarningsPush.hpp"
 #include "llvm/ADT/SmallSet.h"
+#include <llvm/ADT/SmallPtrSet.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/InstIterator.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Transforms/Scalar.h>
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/GenericDomTree.h>
 #include <llvm/Bitcode/BitcodeReader.h>
@@ -57,8 +63,20 @@ const unsigned char igcbuiltin_emu_sp_div[] = {0};
 #include <llvm/IRReader/IRReader.h>
 #include "common/LLVMWarningsPop.hpp"
 
+#include <map>
+#include <mutex>
+#include <string>
+
 using namespace llvm;
 using namespace IGC;
+
+static cl::opt<unsigned> EmuKindOverride(
+    "igc-precompiled-import-emu-kind", cl::init(0), cl::Hidden,
+    cl::desc("EmuKind bits to emulate in addition to the ones requested (default 0)"));
+
+static cl::opt<std::string> EmuLibraryOverride(
+    "igc-precompiled-import-lib", cl::init(""), cl::Hidden,
+    cl::desc("Bitcode file that stands in for every emulation library"));
     // Register pass to igc-opt
 #define PASS_FLAG "igc-precompiled-import"
 #define PASS_DESCRIPTION "PreCompiledFuncImport"
@@ -73,7 +91,7 @@ char PreCompiledFuncImport::ID = 0;
 
 PreCompiledFuncImport::PreCompiledFuncImport(uint32_t TheEmuKind) :
     ModulePass(ID),
-    m_emuKind(TheEmuKind)
+    m_emuKind(TheEmuKind | EmuKindOverride)
 {
     initializePreCompiledFuncImportPass(*PassRegistry::getPassRegistry());
 }
@@ -120,20 +138,21 @@ const char* PreCompiledFuncImport::m_sFunctionNames[NUM_FUNCTIONS][NUM_TYPES] =
 
 const PreCompiledFuncInfo PreCompiledFuncImport::m_functionInfos[NUM_FUNCTION_IDS] =
 {
-    { "__igcbuiltin_dp_add",        LIBMOD_DP_ADD_SUB },
-    { "__igcbuiltin_dp_sub",        LIBMOD_DP_ADD_SUB },
-    { "__igcbuiltin_dp_fma",        LIBMOD_DP_FMA_MUL },
-    { "__igcbuiltin_dp_mul",        LIBMOD_DP_FMA_MUL },
-    { "__igcbuiltin_dp_div",        LIBMOD_DP_DIV },
-    { "__igcbuiltin_dp_cmp",        LIBMOD_DP_CMP },
-    { "__igcbuiltin_dp_to_int32",   LIBMOD_DP_CONV_I32 },
-    { "__igcbuiltin_dp_to_uint32",  LIBMOD_DP_CONV_I32 },
-    { "__igcbuiltin_int32_to_dp",   LIBMOD_DP_CONV_I32 },
-    { "__igcbuiltin_uint32_to_dp",  LIBMOD_DP_CONV_I32 },
-    { "__igcbuiltin_dp_to_sp",      LIBMOD_DP_CONV_SP },  
-    { "__igcbuiltin_sp_to_dp",      LIBMOD_DP_CONV_SP },
-    { "__igcbuiltin_dp_sqrt",       LIBMOD_DP_SQRT },
-	{ "__igcbuiltin_sp_div",        LIBMOD_SP_DIV }
+    // ModeArgMask bits follow the argument lists in getOrCreateFunction()
+    { "__igcbuiltin_dp_add",        LIBMOD_DP_ADD_SUB,  0x1C },  // rmode, ftz, daz
+    { "__igcbuiltin_dp_sub",        LIBMOD_DP_ADD_SUB,  0x1C },
+    { "__igcbuiltin_dp_fma",        LIBMOD_DP_FMA_MUL,  0x38 },
+    { "__igcbuiltin_dp_mul",        LIBMOD_DP_FMA_MUL,  0x1C },
+    { "__igcbuiltin_dp_div",        LIBMOD_DP_DIV,      0x1C },
+    { "__igcbuiltin_dp_cmp",        LIBMOD_DP_CMP,      0x04 },  // daz
+    { "__igcbuiltin_dp_to_int32",   LIBMOD_DP_CONV_I32, 0x06 },  // rmode, daz
+    { "__igcbuiltin_dp_to_uint32",  LIBMOD_DP_CONV_I32, 0x06 },
+    { "__igcbuiltin_int32_to_dp",   LIBMOD_DP_CONV_I32, 0x00 },
+    { "__igcbuiltin_uint32_to_dp",  LIBMOD_DP_CONV_I32, 0x00 },
+    { "__igcbuiltin_dp_to_sp",      LIBMOD_DP_CONV_SP,  0x0E },  // rmode, ftz, daz
+    { "__igcbuiltin_sp_to_dp",      LIBMOD_DP_CONV_SP,  0x02 },  // daz
+    { "__igcbuiltin_dp_sqrt",       LIBMOD_DP_SQRT,     0x0E },  // rmode, ftz, daz
+	{ "__igcbuiltin_sp_div",        LIBMOD_SP_DIV,      0x00 }
 };
 
 const LibraryModuleInfo PreCompiledFuncImport::m_libModInfos[NUM_LIBMODS] =
@@ -149,6 +168,254 @@ const LibraryModuleInfo PreCompiledFuncImport::m_libModInfos[NUM_LIBMODS] =
 	/* LIBMOD_SP_DIV      */   { igcbuiltin_emu_sp_div, sizeof(igcbuiltin_emu_sp_div) }
 };
 
+namespace {
+
+typedef std::pair<unsigned, uint64_t> ModeArg;   // (argument number, constant value)
+
+// Name of the variant of an emulation function specialized on 'modeArgs'.
+std::string getSpecializedName(StringRef funcName, ArrayRef<ModeArg> modeArgs)
+{
+    std::string name = funcName.str() + ".spec";
+    for (const ModeArg& MA : modeArgs)
+    {
+        name += "." + std::to_string(MA.first) + "_" + std::to_string(MA.second);
+    }
+    return name;
+}
+
+// Process-wide cache of the emulation functions imported by PreCompiledFuncImport.
+//
+// Each library module is parsed once, into a context owned by the cache. What a
+// shader imports is a slice of a library: one root function with the functions and
+// globals reachable from it, specialized on the mode arguments (rounding mode, ftz,
+// daz) that are the same constant at all of the shader's calls. Slices are kept as
+// bitcode so that any compilation can parse them into its own context, and a miss
+// is cached too, so names not defined by a library are only looked up once.
+class EmulationFunctionCache
+{
+public:
+    static EmulationFunctionCache& get()
+    {
+        // Never deleted, the cache lives until the process exits.
+        static EmulationFunctionCache* cache = new EmulationFunctionCache();
+        return *cache;
+    }
+
+    // Returns false if library 'libID' does not define 'funcName'.
+    bool getSlice(int libID, const LibraryModuleInfo& libInfo,
+        StringRef funcName, ArrayRef<ModeArg> modeArgs,
+        const DataLayout& DL, std::string& bitcode);
+
+private:
+    EmulationFunctionCache() = default;
+
+    Module* getLibModule(int libID, const LibraryModuleInfo& libInfo);
+    std::unique_ptr<Module> buildSlice(const Module& libMod, const Function* root);
+    void specialize(Module& slice, Function* root, ArrayRef<ModeArg> modeArgs);
+
+    std::mutex m_mutex;
+    LLVMContext m_context;
+    std::unique_ptr<Module> m_libModules[PreCompiledFuncImport::NUM_LIBMODS];
+    bool m_libParsed[PreCompiledFuncImport::NUM_LIBMODS] = {};
+    // Empty bitcode records that the library does not define the function.
+    std::map<std::string, std::string> m_slices;
+};
+
+bool EmulationFunctionCache::getSlice(int libID, const LibraryModuleInfo& libInfo,
+    StringRef funcName, ArrayRef<ModeArg> modeArgs,
+    const DataLayout& DL, std::string& bitcode)
+{
+    // Specialization folds with the data layout of the shader, so it is part of the key.
+    std::string key = std::to_string(libID) + ":" +
+        getSpecializedName(funcName, modeArgs) + ":" + DL.getStringRepresentation();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_slices.find(key);
+    if (it == m_slices.end())
+    {
+        it = m_slices.insert(std::make_pair(key, std::string())).first;
+
+        Module* libMod = getLibModule(libID, libInfo);
+        Function* root = libMod ? libMod->getFunction(funcName) : nullptr;
+        if (root && !root->isDeclaration())
+        {
+            std::unique_ptr<Module> slice = buildSlice(*libMod, root);
+            slice->setDataLayout(DL);
+            if (!modeArgs.empty())
+            {
+                specialize(*slice, slice->getFunction(funcName), modeArgs);
+            }
+
+            raw_string_ostream OS(it->second);
+            WriteBitcodeToFile(slice.get(), OS);
+            OS.flush();
+        }
+    }
+
+    bitcode = it->second;
+    return !bitcode.empty();
+}
+
+Module* EmulationFunctionCache::getLibModule(int libID, const LibraryModuleInfo& libInfo)
+{
+    if (!m_libParsed[libID])
+    {
+        m_libParsed[libID] = true;
+
+        StringRef BitRef((const char*)libInfo.Mod, libInfo.ModSize);
+        Expected<std::unique_ptr<Module>> ModuleOrErr =
+            parseBitcodeFile(MemoryBufferRef(BitRef, ""), m_context);
+        if (ModuleOrErr)
+        {
+            m_libModules[libID] = std::move(*ModuleOrErr);
+        }
+        else
+        {
+            consumeError(ModuleOrErr.takeError());
+            assert(0 && "llvm parseBitcodeFile - FAILED to parse emulation library");
+        }
+    }
+    return m_libModules[libID].get();
+}
+
+std::unique_ptr<Module> EmulationFunctionCache::buildSlice(const Module& libMod, const Function* root)
+{
+    // Collect the functions and globals reachable from the root, looking
+    // through constant expressions and global initializers.
+    SmallPtrSet<const GlobalValue*, 32> reachable;
+    SmallPtrSet<const Constant*, 32> visitedConsts;
+    SmallVector<const GlobalValue*, 32> worklist;
+    reachable.insert(root);
+    worklist.push_back(root);
+    while (!worklist.empty())
+    {
+        const GlobalValue* GV = worklist.pop_back_val();
+        SmallVector<const Value*, 64> operands;
+        if (const Function* F = dyn_cast<Function>(GV))
+        {
+            for (const Instruction& I : instructions(F))
+            {
+                operands.append(I.op_begin(), I.op_end());
+            }
+        }
+        else if (const GlobalVariable* GVar = dyn_cast<GlobalVariable>(GV))
+        {
+            if (GVar->hasInitializer())
+            {
+                operands.push_back(GVar->getInitializer());
+            }
+        }
+        else if (const GlobalAlias* GA = dyn_cast<GlobalAlias>(GV))
+        {
+            operands.push_back(GA->getAliasee());
+        }
+
+        while (!operands.empty())
+        {
+            const Value* V = operands.pop_back_val();
+            if (const GlobalValue* RefGV = dyn_cast<GlobalValue>(V))
+            {
+                if (reachable.insert(RefGV).second)
+                {
+                    worklist.push_back(RefGV);
+                }
+            }
+            else if (const Constant* C = dyn_cast<Constant>(V))
+            {
+                if (visitedConsts.insert(C).second)
+                {
+                    operands.append(C->op_begin(), C->op_end());
+                }
+            }
+        }
+    }
+
+    ValueToValueMapTy VMap;
+    std::unique_ptr<Module> slice = CloneModule(&libMod, VMap,
+        [&reachable](const GlobalValue* GV) { return reachable.count(GV) != 0; });
+
+    // Everything not reachable came over as a declaration; drop the unused ones.
+    for (auto I = slice->begin(), E = slice->end(); I != E; )
+    {
+        Function* F = &*I++;
+        if (F->isDeclaration() && F->use_empty())
+        {
+            F->eraseFromParent();
+        }
+    }
+    for (auto I = slice->global_begin(), E = slice->global_end(); I != E; )
+    {
+        GlobalVariable* GVar = &*I++;
+        if (GVar->isDeclaration() && GVar->use_empty())
+        {
+            GVar->eraseFromParent();
+        }
+    }
+
+    // Helpers shared by several slices must link into one shader only once.
+    // The root stays external so that it resolves the shader's declaration.
+    const Function* newRoot = cast<Function>(VMap[root]);
+    for (GlobalObject& GO : slice->global_objects())
+    {
+        if (&GO != newRoot && !GO.isDeclaration() && !GO.hasLocalLinkage())
+        {
+            GO.setLinkage(GlobalValue::LinkOnceODRLinkage);
+        }
+    }
+    return slice;
+}
+
+void EmulationFunctionCache::specialize(Module& slice, Function* root, ArrayRef<ModeArg> modeArgs)
+{
+    // A root also called from inside its library keeps its generic body.
+    if (!root->use_empty())
+    {
+        return;
+    }
+
+    for (const ModeArg& MA : modeArgs)
+    {
+        Argument* arg = &*std::next(root->arg_begin(), MA.first);
+        arg->replaceAllUsesWith(ConstantInt::get(arg->getType(), MA.second));
+    }
+    root->setName(getSpecializedName(root->getName(), modeArgs));
+
+    legacy::FunctionPassManager FPM(&slice);
+    FPM.add(createSCCPPass());
+    FPM.add(createInstructionCombiningPass());
+    FPM.add(createCFGSimplificationPass());
+    FPM.doInitialization();
+    FPM.run(*root);
+    FPM.doFinalization();
+
+    // Remove the helpers that only served the folded-away modes.
+    bool erased = true;
+    while (erased)
+    {
+        erased = false;
+        for (auto I = slice.begin(), E = slice.end(); I != E; )
+        {
+            Function* F = &*I++;
+            if (F != root && F->use_empty())
+            {
+                F->eraseFromParent();
+                erased = true;
+            }
+        }
+        for (auto I = slice.global_begin(), E = slice.global_end(); I != E; )
+        {
+            GlobalVariable* GVar = &*I++;
+            if (GVar->use_empty())
+            {
+                GVar->eraseFromParent();
+                erased = true;
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
 // This function scans intructions before emulation. It converts double-related
 // operations (intrinsics, instructions) into ones that can be emulated. It has:
 //   1. Intrinsics
@@ -356,41 +623,13 @@ bool PreCompiledFuncImport::runOnModule(Module &M)
 
     if (m_changed)
     {
-        llvm::Linker ld(M);
-        for (int i=0; i < NUM_LIBMODS; ++i)
+        if (IGC_IS_FLAG_ENABLED(EnableEmulationFunctionCache))
         {
-            if (!m_libModuleToBeImported[i]) {
-                continue;
-            }
-
-            const char* pLibraryModule = (const char*)m_libModInfos[i].Mod;
-            uint32_t libSize = m_libModInfos[i].ModSize;
-
-            // Load the module we want to compile and link it to existing module
-            //StringRef BitRef((char*)preCompiledFunctionLibrary, preCompiledFunctionLibrarySize);
-            StringRef BitRef(pLibraryModule, libSize);
-            //llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-            //    llvm::getLazyBitcodeModule(MemoryBufferRef(BitRef.str(), ""), M.getContext());
-            llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
-                llvm::parseBitcodeFile(MemoryBufferRef(BitRef.str(), ""), M.getContext());
-            assert(ModuleOrErr && "llvm getLazyBitcodeModule - FAILED to parse bitcode");
-            std::unique_ptr<llvm::Module> m_pBuiltinModule = std::move(*ModuleOrErr);
-            assert(m_pBuiltinModule && "llvm version mismatch - could not load llvm module");
-
-            // Set target triple and datalayout to the original module (emulation func
-            // works for both 64 & 32 bit applications).
-            m_pBuiltinModule->setDataLayout(M.getDataLayout());
-            m_pBuiltinModule->setTargetTriple(M.getTargetTriple());
-
-            // Linking the two modules
-            llvm::Linker ld(M);
-
-            if (ld.linkInModule(std::move(m_pBuiltinModule)))
-            {
-                assert(0 && "Error linking the two modules");
-            }
-
-            m_pBuiltinModule = nullptr;
+            importLibraryFunctions(M);
+        }
+        else
+        {
+            importLibraryModules(M);
         }
     }
 
@@ -434,6 +673,211 @@ bool PreCompiledFuncImport::runOnModule(Module &M)
     return m_changed;
 }
 
+// Link in every library module that has a function in use.
+void PreCompiledFuncImport::importLibraryModules(Module& M)
+{
+    for (int i=0; i < NUM_LIBMODS; ++i)
+    {
+        if (!m_libModuleToBeImported[i]) {
+            continue;
+        }
+
+        LibraryModuleInfo libInfo = getLibModInfo(i);
+        const char* pLibraryModule = (const char*)libInfo.Mod;
+        uint32_t libSize = libInfo.ModSize;
+
+        // Load the module we want to compile and link it to existing module
+        //StringRef BitRef((char*)preCompiledFunctionLibrary, preCompiledFunctionLibrarySize);
+        StringRef BitRef(pLibraryModule, libSize);
+        //llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+        //    llvm::getLazyBitcodeModule(MemoryBufferRef(BitRef.str(), ""), M.getContext());
+        llvm::Expected<std::unique_ptr<llvm::Module>> ModuleOrErr =
+            llvm::parseBitcodeFile(MemoryBufferRef(BitRef.str(), ""), M.getContext());
+        assert(ModuleOrErr && "llvm getLazyBitcodeModule - FAILED to parse bitcode");
+        std::unique_ptr<llvm::Module> m_pBuiltinModule = std::move(*ModuleOrErr);
+        assert(m_pBuiltinModule && "llvm version mismatch - could not load llvm module");
+
+        // Set target triple and datalayout to the original module (emulation func
+        // works for both 64 & 32 bit applications).
+        m_pBuiltinModule->setDataLayout(M.getDataLayout());
+        m_pBuiltinModule->setTargetTriple(M.getTargetTriple());
+
+        // Linking the two modules
+        llvm::Linker ld(M);
+
+        if (ld.linkInModule(std::move(m_pBuiltinModule)))
+        {
+            assert(0 && "Error linking the two modules");
+        }
+
+        m_pBuiltinModule = nullptr;
+    }
+}
+
+// Link in, for each emulation function in use, only the slice of its library
+// module it needs, taken from the process-wide EmulationFunctionCache. Calls whose
+// mode arguments are the same constants everywhere use a variant specialized on them.
+void PreCompiledFuncImport::importLibraryFunctions(Module& M)
+{
+    EmulationFunctionCache& cache = EmulationFunctionCache::get();
+
+    // A linked slice may declare functions another library defines.
+    bool linked = true;
+    while (linked)
+    {
+        linked = false;
+
+        // Linking erases the declarations it resolves, so keep names and look
+        // each one up again once the slices before it have been linked.
+        SmallVector<std::string, 16> declNames;
+        for (Function& F : M)
+        {
+            if (F.isDeclaration() && !F.use_empty() && isEmulationFunction(F.getName()))
+            {
+                declNames.push_back(F.getName().str());
+            }
+        }
+
+        for (const std::string& declName : declNames)
+        {
+            Function* decl = M.getFunction(declName);
+            if (!decl || !decl->isDeclaration() || decl->use_empty())
+            {
+                continue;
+            }
+
+            SmallVector<ModeArg, 4> modeArgs;
+            getModeArgValues(decl, modeArgs);
+
+            for (int i = 0; i < NUM_LIBMODS; ++i)
+            {
+                std::string bitcode;
+                if (!m_libModuleToBeImported[i] ||
+                    !cache.getSlice(i, getLibModInfo(i), declName, modeArgs,
+                                    M.getDataLayout(), bitcode))
+                {
+                    continue;
+                }
+
+                llvm::Expected<std::unique_ptr<llvm::Module>> SliceOrErr =
+                    llvm::parseBitcodeFile(MemoryBufferRef(bitcode, ""), M.getContext());
+                assert(SliceOrErr && "llvm parseBitcodeFile - FAILED to parse emulation slice");
+                std::unique_ptr<llvm::Module> slice = std::move(*SliceOrErr);
+
+                slice->setDataLayout(M.getDataLayout());
+                slice->setTargetTriple(M.getTargetTriple());
+
+                std::string specName = getSpecializedName(declName, modeArgs);
+                if (llvm::Linker::linkModules(M, std::move(slice)))
+                {
+                    assert(0 && "Error linking the two modules");
+                }
+
+                // A specialized slice defines a differently named root.
+                if (Function* specFunc = M.getFunction(specName))
+                {
+                    decl->replaceAllUsesWith(specFunc);
+                    eraseFunction(&M, decl);
+                }
+
+                linked = true;
+                break;
+            }
+        }
+    }
+}
+
+LibraryModuleInfo PreCompiledFuncImport::getLibModInfo(int libID)
+{
+    if (EmuLibraryOverride.empty())
+    {
+        return m_libModInfos[libID];
+    }
+
+    // Read once; the cache keeps what it parsed from it for the whole process.
+    static std::unique_ptr<MemoryBuffer> overrideLib;
+    if (!overrideLib)
+    {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+            MemoryBuffer::getFile(EmuLibraryOverride);
+        assert(BufOrErr && "could not read the emulation library override");
+        overrideLib = std::move(*BufOrErr);
+    }
+    LibraryModuleInfo libInfo = {
+        (const unsigned char*)overrideLib->getBufferStart(),
+        (int)overrideLib->getBufferSize() };
+    return libInfo;
+}
+
+// Whether 'name' is one of the emulation functions the libraries define. Only
+// those are looked up, so the cache does not record a miss for every other
+// function the shader declares.
+bool PreCompiledFuncImport::isEmulationFunction(StringRef name)
+{
+    for (int FID = 0; FID < NUM_FUNCTION_IDS; ++FID)
+    {
+        if (name.equals(m_functionInfos[FID].FuncName))
+        {
+            return true;
+        }
+    }
+    for (int function = 0; function < NUM_FUNCTIONS; ++function)
+    {
+        for (int type = 0; type < NUM_TYPES; ++type)
+        {
+            if (name.equals(m_sFunctionNames[function][type]))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Collect the mode arguments of emulation function F that are the same
+// constant at all of its calls.
+void PreCompiledFuncImport::getModeArgValues(
+    Function* F, SmallVectorImpl<std::pair<unsigned, uint64_t>>& modeArgs) const
+{
+    uint32_t mask = 0;
+    for (int FID = 0; FID < NUM_FUNCTION_IDS; ++FID)
+    {
+        if (F->getName().equals(m_functionInfos[FID].FuncName))
+        {
+            mask = m_functionInfos[FID].ModeArgMask;
+            break;
+        }
+    }
+
+    for (unsigned argNo = 0; mask != 0 && argNo < F->arg_size(); ++argNo)
+    {
+        if ((mask & (1u << argNo)) == 0)
+        {
+            continue;
+        }
+
+        ConstantInt* value = nullptr;
+        bool isSame = true;
+        for (User* U : F->users())
+        {
+            CallInst* CI = dyn_cast<CallInst>(U);
+            ConstantInt* C = (CI && CI->getCalledFunction() == F) ?
+                dyn_cast<ConstantInt>(CI->getArgOperand(argNo)) : nullptr;
+            if (!C || (value && value != C))
+            {
+                isSame = false;
+                break;
+            }
+            value = C;
+        }
+
+        if (isSame && value)
+        {
+            modeArgs.push_back(std::make_pair(argNo, value->getZExtValue()));
+        }
+    }
+}
+
 void PreCompiledFuncImport::visitBinaryOperator(BinaryOperator &I)
 {
     if (isI64DivRem() && I.getOperand(0)->getType()->isIntOrIntVectorTy())
@@ -32,14 +32,19 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <llvm/Pass.h>
 #include <llvm/IR/InstVisitor.h>
 #include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
 #include "common/LLVMWarningsPop.hpp"
 
+#include <utility>
+
 
 namespace IGC
 {
     typedef struct {
         const char* FuncName;   // Name used in precompiled modules
         int LibModID;           // LibraryModules
+        uint32_t ModeArgMask;   // Arguments (rounding mode, ftz, daz) an imported
+                                // variant can be specialized on, one bit per argument
     } PreCompiledFuncInfo;
 
     typedef struct {
@@ -150,6 +155,12 @@ namespace IGC
         uint32_t getFCmpMask(llvm::CmpInst::Predicate Pred);
 
         bool preProcessDouble();
+        void importLibraryModules(llvm::Module& M);
+        void importLibraryFunctions(llvm::Module& M);
+        void getModeArgValues(llvm::Function* F,
+            llvm::SmallVectorImpl<std::pair<unsigned, uint64_t>>& modeArgs) const;
+        static bool isEmulationFunction(llvm::StringRef name);
+        static LibraryModuleInfo getLibModInfo(int libID);
         void eraseFunction(llvm::Module* M, llvm::Function *F) {
             M->getFunctionList().remove(F);
             delete F;
@@ -0,0 +1,690 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -basicaa -igc-memopt -instcombine | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+define void @f0(i32 %x, i32* noalias %dst, i32* noalias %src) {
+entry:
+  %0 = load i32* %src, align 4
+  %t0 = add i32 %x, 1
+  %t1 = add i32 %t0, 2
+  %t2 = add i32 %t1, 3
+  %t3 = add i32 %t2, 4
+  %t4 = add i32 %t3, 5
+  %t5 = add i32 %t4, 6
+  %t6 = add i32 %t5, 7
+  %t7 = add i32 %t6, 8
+  %t8 = add i32 %t7, 9
+  %t9 = add i32 %t8, 10
+  %t10 = add i32 %t9, 11
+  %t11 = add i32 %t10, 12
+  %t12 = add i32 %t11, 13
+  %t13 = add i32 %t12, 14
+  %t14 = add i32 %t13, 15
+  %t15 = add i32 %t14, 16
+  %t16 = add i32 %t15, 17
+  %t17 = add i32 %t16, 18
+  %t18 = add i32 %t17, 19
+  %t19 = add i32 %t18, 20
+  %t20 = add i32 %t19, 21
+  %t21 = add i32 %t20, 22
+  %t22 = add i32 %t21, 23
+  %t23 = add i32 %t22, 24
+  %t24 = add i32 %t23, 25
+  %t25 = add i32 %t24, 26
+  %t26 = add i32 %t25, 27
+  %t27 = add i32 %t26, 28
+  %t28 = add i32 %t27, 29
+  %t29 = add i32 %t28, 30
+  %t30 = add i32 %t29, 31
+  %t31 = add i32 %t30, 32
+  %t32 = add i32 %t31, 33
+  %t33 = add i32 %t32, 34
+  %t34 = add i32 %t33, 35
+  %t35 = add i32 %t34, 36
+  %t36 = add i32 %t35, 37
+  %t37 = add i32 %t36, 38
+  %t38 = add i32 %t37, 39
+  %t39 = add i32 %t38, 40
+  %t40 = add i32 %t39, 41
+  %t41 = add i32 %t40, 42
+  %t42 = add i32 %t41, 43
+  %t43 = add i32 %t42, 44
+  %t44 = add i32 %t43, 45
+  %t45 = add i32 %t44, 46
+  %t46 = add i32 %t45, 47
+  %t47 = add i32 %t46, 48
+  %t48 = add i32 %t47, 49
+  %t49 = add i32 %t48, 50
+  %t50 = add i32 %t49, 51
+  %t51 = add i32 %t50, 52
+  %t52 = add i32 %t51, 53
+  %t53 = add i32 %t52, 54
+  %t54 = add i32 %t53, 55
+  %t55 = add i32 %t54, 56
+  %t56 = add i32 %t55, 57
+  %t57 = add i32 %t56, 58
+  %t58 = add i32 %t57, 59
+  %t59 = add i32 %t58, 60
+  %t60 = add i32 %t59, 61
+  %t61 = add i32 %t60, 62
+  %t62 = add i32 %t61, 63
+  %t63 = add i32 %t62, 64
+  %t64 = add i32 %t63, 65
+  %t65 = add i32 %t64, 66
+  %t66 = add i32 %t65, 67
+  %t67 = add i32 %t66, 68
+  %t68 = add i32 %t67, 69
+  %t69 = add i32 %t68, 70
+  %t70 = add i32 %t69, 71
+  %t71 = add i32 %t70, 72
+  %t72 = add i32 %t71, 73
+  %t73 = add i32 %t72, 74
+  %t74 = add i32 %t73, 75
+  %t75 = add i32 %t74, 76
+  %t76 = add i32 %t75, 77
+  %t77 = add i32 %t76, 78
+  %t78 = add i32 %t77, 79
+  %t79 = add i32 %t78, 80
+  %t80 = add i32 %t79, 81
+  %t81 = add i32 %t80, 82
+  %t82 = add i32 %t81, 83
+  %t83 = add i32 %t82, 84
+  %t84 = add i32 %t83, 85
+  %t85 = add i32 %t84, 86
+  %t86 = add i32 %t85, 87
+  %t87 = add i32 %t86, 88
+  %t88 = add i32 %t87, 89
+  %t89 = add i32 %t88, 90
+  %t90 = add i32 %t89, 91
+  %t91 = add i32 %t90, 92
+  %t92 = add i32 %t91, 93
+  %t93 = add i32 %t92, 94
+  %t94 = add i32 %t93, 95
+  %t95 = add i32 %t94, 96
+  %t96 = add i32 %t95, 97
+  %t97 = add i32 %t96, 98
+  %t98 = add i32 %t97, 99
+  %t99 = add i32 %t98, 100
+  %t100 = add i32 %t99, 101
+  %t101 = add i32 %t100, 102
+  %t102 = add i32 %t101, 103
+  %t103 = add i32 %t102, 104
+  %t104 = add i32 %t103, 105
+  %t105 = add i32 %t104, 106
+  %t106 = add i32 %t105, 107
+  %t107 = add i32 %t106, 108
+  %t108 = add i32 %t107, 109
+  %t109 = add i32 %t108, 110
+  %t110 = add i32 %t109, 111
+  %t111 = add i32 %t110, 112
+  %t112 = add i32 %t111, 113
+  %t113 = add i32 %t112, 114
+  %t114 = add i32 %t113, 115
+  %t115 = add i32 %t114, 116
+  %t116 = add i32 %t115, 117
+  %t117 = add i32 %t116, 118
+  %t118 = add i32 %t117, 119
+  %t119 = add i32 %t118, 120
+  %t120 = add i32 %t119, 121
+  %t121 = add i32 %t120, 122
+  %t122 = add i32 %t121, 123
+  %t123 = add i32 %t122, 124
+  %t124 = add i32 %t123, 125
+  %t125 = add i32 %t124, 126
+  %t126 = add i32 %t125, 127
+  %t127 = add i32 %t126, 128
+  %t128 = add i32 %t127, 129
+  %t129 = add i32 %t128, 130
+  %t130 = add i32 %t129, 131
+  %t131 = add i32 %t130, 132
+  %t132 = add i32 %t131, 133
+  %t133 = add i32 %t132, 134
+  %t134 = add i32 %t133, 135
+  %t135 = add i32 %t134, 136
+  %t136 = add i32 %t135, 137
+  %t137 = add i32 %t136, 138
+  %t138 = add i32 %t137, 139
+  %t139 = add i32 %t138, 140
+  %t140 = add i32 %t139, 141
+  %t141 = add i32 %t140, 142
+  %t142 = add i32 %t141, 143
+  %t143 = add i32 %t142, 144
+  %t144 = add i32 %t143, 145
+  %t145 = add i32 %t144, 146
+  %t146 = add i32 %t145, 147
+  %t147 = add i32 %t146, 148
+  %t148 = add i32 %t147, 149
+  %t149 = add i32 %t148, 150
+  %t150 = add i32 %t149, 151
+  %t151 = add i32 %t150, 152
+  %t152 = add i32 %t151, 153
+  %t153 = add i32 %t152, 154
+  %t154 = add i32 %t153, 155
+  %t155 = add i32 %t154, 156
+  %t156 = add i32 %t155, 157
+  %t157 = add i32 %t156, 158
+  %t158 = add i32 %t157, 159
+  %t159 = add i32 %t158, 160
+  %t160 = add i32 %t159, 161
+  %t161 = add i32 %t160, 162
+  %t162 = add i32 %t161, 163
+  %t163 = add i32 %t162, 164
+  %t164 = add i32 %t163, 165
+  %t165 = add i32 %t164, 166
+  %t166 = add i32 %t165, 167
+  %t167 = add i32 %t166, 168
+  %t168 = add i32 %t167, 169
+  %t169 = add i32 %t168, 170
+  %t170 = add i32 %t169, 171
+  %t171 = add i32 %t170, 172
+  %t172 = add i32 %t171, 173
+  %t173 = add i32 %t172, 174
+  %t174 = add i32 %t173, 175
+  %t175 = add i32 %t174, 176
+  %t176 = add i32 %t175, 177
+  %t177 = add i32 %t176, 178
+  %t178 = add i32 %t177, 179
+  %t179 = add i32 %t178, 180
+  %t180 = add i32 %t179, 181
+  %t181 = add i32 %t180, 182
+  %t182 = add i32 %t181, 183
+  %t183 = add i32 %t182, 184
+  %t184 = add i32 %t183, 185
+  %t185 = add i32 %t184, 186
+  %t186 = add i32 %t185, 187
+  %t187 = add i32 %t186, 188
+  %t188 = add i32 %t187, 189
+  %t189 = add i32 %t188, 190
+  %t190 = add i32 %t189, 191
+  %t191 = add i32 %t190, 192
+  %t192 = add i32 %t191, 193
+  %t193 = add i32 %t192, 194
+  %t194 = add i32 %t193, 195
+  %t195 = add i32 %t194, 196
+  %t196 = add i32 %t195, 197
+  %t197 = add i32 %t196, 198
+  %t198 = add i32 %t197, 199
+  %t199 = add i32 %t198, 200
+  %arrayidx1 = getelementptr inbounds i32* %src, i64 1
+  %1 = load i32* %arrayidx1, align 4
+  %sum = add i32 %1, %t199
+  store i32 %0, i32* %dst, align 4
+  %arrayidx2 = getelementptr inbounds i32* %dst, i64 1
+  store i32 %sum, i32* %arrayidx2, align 4
+  ret void
+}
+
+; Loads separated by more than the linear scan window are still merged as
+; they share the same symbolic base.
+
+; CHECK-LABEL: define void @f0
+; CHECK: %0 = bitcast i32* %src to <2 x i32>*
+; CHECK: %1 = load <2 x i32>* %0, align 4
+; CHECK: ret void
+
+
+define void @f1(i32 %x, i32* noalias %dst, i32* noalias %src) {
+entry:
+  %0 = load i32* %src, align 4
+  %t0 = add i32 %x, 1
+  %t1 = add i32 %t0, 2
+  %t2 = add i32 %t1, 3
+  %t3 = add i32 %t2, 4
+  %t4 = add i32 %t3, 5
+  %t5 = add i32 %t4, 6
+  %t6 = add i32 %t5, 7
+  %t7 = add i32 %t6, 8
+  %t8 = add i32 %t7, 9
+  %t9 = add i32 %t8, 10
+  %t10 = add i32 %t9, 11
+  %t11 = add i32 %t10, 12
+  %t12 = add i32 %t11, 13
+  %t13 = add i32 %t12, 14
+  %t14 = add i32 %t13, 15
+  %t15 = add i32 %t14, 16
+  %t16 = add i32 %t15, 17
+  %t17 = add i32 %t16, 18
+  %t18 = add i32 %t17, 19
+  %t19 = add i32 %t18, 20
+  %t20 = add i32 %t19, 21
+  %t21 = add i32 %t20, 22
+  %t22 = add i32 %t21, 23
+  %t23 = add i32 %t22, 24
+  %t24 = add i32 %t23, 25
+  %t25 = add i32 %t24, 26
+  %t26 = add i32 %t25, 27
+  %t27 = add i32 %t26, 28
+  %t28 = add i32 %t27, 29
+  %t29 = add i32 %t28, 30
+  %t30 = add i32 %t29, 31
+  %t31 = add i32 %t30, 32
+  %t32 = add i32 %t31, 33
+  %t33 = add i32 %t32, 34
+  %t34 = add i32 %t33, 35
+  %t35 = add i32 %t34, 36
+  %t36 = add i32 %t35, 37
+  %t37 = add i32 %t36, 38
+  %t38 = add i32 %t37, 39
+  %t39 = add i32 %t38, 40
+  %t40 = add i32 %t39, 41
+  %t41 = add i32 %t40, 42
+  %t42 = add i32 %t41, 43
+  %t43 = add i32 %t42, 44
+  %t44 = add i32 %t43, 45
+  %t45 = add i32 %t44, 46
+  %t46 = add i32 %t45, 47
+  %t47 = add i32 %t46, 48
+  %t48 = add i32 %t47, 49
+  %t49 = add i32 %t48, 50
+  %t50 = add i32 %t49, 51
+  %t51 = add i32 %t50, 52
+  %t52 = add i32 %t51, 53
+  %t53 = add i32 %t52, 54
+  %t54 = add i32 %t53, 55
+  %t55 = add i32 %t54, 56
+  %t56 = add i32 %t55, 57
+  %t57 = add i32 %t56, 58
+  %t58 = add i32 %t57, 59
+  %t59 = add i32 %t58, 60
+  %t60 = add i32 %t59, 61
+  %t61 = add i32 %t60, 62
+  %t62 = add i32 %t61, 63
+  %t63 = add i32 %t62, 64
+  %t64 = add i32 %t63, 65
+  %t65 = add i32 %t64, 66
+  %t66 = add i32 %t65, 67
+  %t67 = add i32 %t66, 68
+  %t68 = add i32 %t67, 69
+  %t69 = add i32 %t68, 70
+  %t70 = add i32 %t69, 71
+  %t71 = add i32 %t70, 72
+  %t72 = add i32 %t71, 73
+  %t73 = add i32 %t72, 74
+  %t74 = add i32 %t73, 75
+  %t75 = add i32 %t74, 76
+  %t76 = add i32 %t75, 77
+  %t77 = add i32 %t76, 78
+  %t78 = add i32 %t77, 79
+  %t79 = add i32 %t78, 80
+  %t80 = add i32 %t79, 81
+  %t81 = add i32 %t80, 82
+  %t82 = add i32 %t81, 83
+  %t83 = add i32 %t82, 84
+  %t84 = add i32 %t83, 85
+  %t85 = add i32 %t84, 86
+  %t86 = add i32 %t85, 87
+  %t87 = add i32 %t86, 88
+  %t88 = add i32 %t87, 89
+  %t89 = add i32 %t88, 90
+  %t90 = add i32 %t89, 91
+  %t91 = add i32 %t90, 92
+  %t92 = add i32 %t91, 93
+  %t93 = add i32 %t92, 94
+  %t94 = add i32 %t93, 95
+  %t95 = add i32 %t94, 96
+  %t96 = add i32 %t95, 97
+  %t97 = add i32 %t96, 98
+  %t98 = add i32 %t97, 99
+  %t99 = add i32 %t98, 100
+  %t100 = add i32 %t99, 101
+  fence seq_cst
+  %t101 = add i32 %t100, 102
+  %t102 = add i32 %t101, 103
+  %t103 = add i32 %t102, 104
+  %t104 = add i32 %t103, 105
+  %t105 = add i32 %t104, 106
+  %t106 = add i32 %t105, 107
+  %t107 = add i32 %t106, 108
+  %t108 = add i32 %t107, 109
+  %t109 = add i32 %t108, 110
+  %t110 = add i32 %t109, 111
+  %t111 = add i32 %t110, 112
+  %t112 = add i32 %t111, 113
+  %t113 = add i32 %t112, 114
+  %t114 = add i32 %t113, 115
+  %t115 = add i32 %t114, 116
+  %t116 = add i32 %t115, 117
+  %t117 = add i32 %t116, 118
+  %t118 = add i32 %t117, 119
+  %t119 = add i32 %t118, 120
+  %t120 = add i32 %t119, 121
+  %t121 = add i32 %t120, 122
+  %t122 = add i32 %t121, 123
+  %t123 = add i32 %t122, 124
+  %t124 = add i32 %t123, 125
+  %t125 = add i32 %t124, 126
+  %t126 = add i32 %t125, 127
+  %t127 = add i32 %t126, 128
+  %t128 = add i32 %t127, 129
+  %t129 = add i32 %t128, 130
+  %t130 = add i32 %t129, 131
+  %t131 = add i32 %t130, 132
+  %t132 = add i32 %t131, 133
+  %t133 = add i32 %t132, 134
+  %t134 = add i32 %t133, 135
+  %t135 = add i32 %t134, 136
+  %t136 = add i32 %t135, 137
+  %t137 = add i32 %t136, 138
+  %t138 = add i32 %t137, 139
+  %t139 = add i32 %t138, 140
+  %t140 = add i32 %t139, 141
+  %t141 = add i32 %t140, 142
+  %t142 = add i32 %t141, 143
+  %t143 = add i32 %t142, 144
+  %t144 = add i32 %t143, 145
+  %t145 = add i32 %t144, 146
+  %t146 = add i32 %t145, 147
+  %t147 = add i32 %t146, 148
+  %t148 = add i32 %t147, 149
+  %t149 = add i32 %t148, 150
+  %t150 = add i32 %t149, 151
+  %t151 = add i32 %t150, 152
+  %t152 = add i32 %t151, 153
+  %t153 = add i32 %t152, 154
+  %t154 = add i32 %t153, 155
+  %t155 = add i32 %t154, 156
+  %t156 = add i32 %t155, 157
+  %t157 = add i32 %t156, 158
+  %t158 = add i32 %t157, 159
+  %t159 = add i32 %t158, 160
+  %t160 = add i32 %t159, 161
+  %t161 = add i32 %t160, 162
+  %t162 = add i32 %t161, 163
+  %t163 = add i32 %t162, 164
+  %t164 = add i32 %t163, 165
+  %t165 = add i32 %t164, 166
+  %t166 = add i32 %t165, 167
+  %t167 = add i32 %t166, 168
+  %t168 = add i32 %t167, 169
+  %t169 = add i32 %t168, 170
+  %t170 = add i32 %t169, 171
+  %t171 = add i32 %t170, 172
+  %t172 = add i32 %t171, 173
+  %t173 = add i32 %t172, 174
+  %t174 = add i32 %t173, 175
+  %t175 = add i32 %t174, 176
+  %t176 = add i32 %t175, 177
+  %t177 = add i32 %t176, 178
+  %t178 = add i32 %t177, 179
+  %t179 = add i32 %t178, 180
+  %t180 = add i32 %t179, 181
+  %t181 = add i32 %t180, 182
+  %t182 = add i32 %t181, 183
+  %t183 = add i32 %t182, 184
+  %t184 = add i32 %t183, 185
+  %t185 = add i32 %t184, 186
+  %t186 = add i32 %t185, 187
+  %t187 = add i32 %t186, 188
+  %t188 = add i32 %t187, 189
+  %t189 = add i32 %t188, 190
+  %t190 = add i32 %t189, 191
+  %t191 = add i32 %t190, 192
+  %t192 = add i32 %t191, 193
+  %t193 = add i32 %t192, 194
+  %t194 = add i32 %t193, 195
+  %t195 = add i32 %t194, 196
+  %t196 = add i32 %t195, 197
+  %t197 = add i32 %t196, 198
+  %t198 = add i32 %t197, 199
+  %t199 = add i32 %t198, 200
+  %arrayidx1 = getelementptr inbounds i32* %src, i64 1
+  %1 = load i32* %arrayidx1, align 4
+  %sum = add i32 %1, %t199
+  store i32 %0, i32* %dst, align 4
+  %arrayidx2 = getelementptr inbounds i32* %dst, i64 1
+  store i32 %sum, i32* %arrayidx2, align 4
+  ret void
+}
+
+; The fence beyond the linear scan window is an alias barrier. Loads cannot be
+; merged across it.
+
+; CHECK-LABEL: define void @f1
+; CHECK: %0 = load i32* %src, align 4
+; CHECK: fence seq_cst
+; CHECK: %1 = load i32* %arrayidx1, align 4
+; CHECK: ret void
+
+define void @f2(i32 %x, i32* noalias %dst, i32* noalias %src) {
+entry:
+  store i32 %x, i32* %dst, align 4
+  %t0 = add i32 %x, 1
+  %t1 = add i32 %t0, 2
+  %t2 = add i32 %t1, 3
+  %t3 = add i32 %t2, 4
+  %t4 = add i32 %t3, 5
+  %t5 = add i32 %t4, 6
+  %t6 = add i32 %t5, 7
+  %t7 = add i32 %t6, 8
+  %t8 = add i32 %t7, 9
+  %t9 = add i32 %t8, 10
+  %t10 = add i32 %t9, 11
+  %t11 = add i32 %t10, 12
+  %t12 = add i32 %t11, 13
+  %t13 = add i32 %t12, 14
+  %t14 = add i32 %t13, 15
+  %t15 = add i32 %t14, 16
+  %t16 = add i32 %t15, 17
+  %t17 = add i32 %t16, 18
+  %t18 = add i32 %t17, 19
+  %t19 = add i32 %t18, 20
+  %t20 = add i32 %t19, 21
+  %t21 = add i32 %t20, 22
+  %t22 = add i32 %t21, 23
+  %t23 = add i32 %t22, 24
+  %t24 = add i32 %t23, 25
+  %t25 = add i32 %t24, 26
+  %t26 = add i32 %t25, 27
+  %t27 = add i32 %t26, 28
+  %t28 = add i32 %t27, 29
+  %t29 = add i32 %t28, 30
+  %t30 = add i32 %t29, 31
+  %t31 = add i32 %t30, 32
+  %t32 = add i32 %t31, 33
+  %t33 = add i32 %t32, 34
+  %t34 = add i32 %t33, 35
+  %t35 = add i32 %t34, 36
+  %t36 = add i32 %t35, 37
+  %t37 = add i32 %t36, 38
+  %t38 = add i32 %t37, 39
+  %t39 = add i32 %t38, 40
+  %t40 = add i32 %t39, 41
+  %t41 = add i32 %t40, 42
+  %t42 = add i32 %t41, 43
+  %t43 = add i32 %t42, 44
+  %t44 = add i32 %t43, 45
+  %t45 = add i32 %t44, 46
+  %t46 = add i32 %t45, 47
+  %t47 = add i32 %t46, 48
+  %t48 = add i32 %t47, 49
+  %t49 = add i32 %t48, 50
+  %t50 = add i32 %t49, 51
+  %t51 = add i32 %t50, 52
+  %t52 = add i32 %t51, 53
+  %t53 = add i32 %t52, 54
+  %t54 = add i32 %t53, 55
+  %t55 = add i32 %t54, 56
+  %t56 = add i32 %t55, 57
+  %t57 = add i32 %t56, 58
+  %t58 = add i32 %t57, 59
+  %t59 = add i32 %t58, 60
+  %t60 = add i32 %t59, 61
+  %t61 = add i32 %t60, 62
+  %t62 = add i32 %t61, 63
+  %t63 = add i32 %t62, 64
+  %t64 = add i32 %t63, 65
+  %t65 = add i32 %t64, 66
+  %t66 = add i32 %t65, 67
+  %t67 = add i32 %t66, 68
+  %t68 = add i32 %t67, 69
+  %t69 = add i32 %t68, 70
+  %t70 = add i32 %t69, 71
+  %t71 = add i32 %t70, 72
+  %t72 = add i32 %t71, 73
+  %t73 = add i32 %t72, 74
+  %t74 = add i32 %t73, 75
+  %t75 = add i32 %t74, 76
+  %t76 = add i32 %t75, 77
+  %t77 = add i32 %t76, 78
+  %t78 = add i32 %t77, 79
+  %t79 = add i32 %t78, 80
+  %t80 = add i32 %t79, 81
+  %t81 = add i32 %t80, 82
+  %t82 = add i32 %t81, 83
+  %t83 = add i32 %t82, 84
+  %t84 = add i32 %t83, 85
+  %t85 = add i32 %t84, 86
+  %t86 = add i32 %t85, 87
+  %t87 = add i32 %t86, 88
+  %t88 = add i32 %t87, 89
+  %t89 = add i32 %t88, 90
+  %t90 = add i32 %t89, 91
+  %t91 = add i32 %t90, 92
+  %t92 = add i32 %t91, 93
+  %t93 = add i32 %t92, 94
+  %t94 = add i32 %t93, 95
+  %t95 = add i32 %t94, 96
+  %t96 = add i32 %t95, 97
+  %t97 = add i32 %t96, 98
+  %t98 = add i32 %t97, 99
+  %t99 = add i32 %t98, 100
+  %t100 = add i32 %t99, 101
+  %t101 = add i32 %t100, 102
+  %t102 = add i32 %t101, 103
+  %t103 = add i32 %t102, 104
+  %t104 = add i32 %t103, 105
+  %t105 = add i32 %t104, 106
+  %t106 = add i32 %t105, 107
+  %t107 = add i32 %t106, 108
+  %t108 = add i32 %t107, 109
+  %t109 = add i32 %t108, 110
+  %t110 = add i32 %t109, 111
+  %t111 = add i32 %t110, 112
+  %t112 = add i32 %t111, 113
+  %t113 = add i32 %t112, 114
+  %t114 = add i32 %t113, 115
+  %t115 = add i32 %t114, 116
+  %t116 = add i32 %t115, 117
+  %t117 = add i32 %t116, 118
+  %t118 = add i32 %t117, 119
+  %t119 = add i32 %t118, 120
+  %t120 = add i32 %t119, 121
+  %t121 = add i32 %t120, 122
+  %t122 = add i32 %t121, 123
+  %t123 = add i32 %t122, 124
+  %t124 = add i32 %t123, 125
+  %t125 = add i32 %t124, 126
+  %t126 = add i32 %t125, 127
+  %t127 = add i32 %t126, 128
+  %t128 = add i32 %t127, 129
+  %t129 = add i32 %t128, 130
+  %t130 = add i32 %t129, 131
+  %t131 = add i32 %t130, 132
+  %t132 = add i32 %t131, 133
+  %t133 = add i32 %t132, 134
+  %t134 = add i32 %t133, 135
+  %t135 = add i32 %t134, 136
+  %t136 = add i32 %t135, 137
+  %t137 = add i32 %t136, 138
+  %t138 = add i32 %t137, 139
+  %t139 = add i32 %t138, 140
+  %t140 = add i32 %t139, 141
+  %t141 = add i32 %t140, 142
+  %t142 = add i32 %t141, 143
+  %t143 = add i32 %t142, 144
+  %t144 = add i32 %t143, 145
+  %t145 = add i32 %t144, 146
+  %t146 = add i32 %t145, 147
+  %t147 = add i32 %t146, 148
+  %t148 = add i32 %t147, 149
+  %t149 = add i32 %t148, 150
+  %t150 = add i32 %t149, 151
+  %t151 = add i32 %t150, 152
+  %t152 = add i32 %t151, 153
+  %t153 = add i32 %t152, 154
+  %t154 = add i32 %t153, 155
+  %t155 = add i32 %t154, 156
+  %t156 = add i32 %t155, 157
+  %t157 = add i32 %t156, 158
+  %t158 = add i32 %t157, 159
+  %t159 = add i32 %t158, 160
+  %t160 = add i32 %t159, 161
+  %t161 = add i32 %t160, 162
+  %t162 = add i32 %t161, 163
+  %t163 = add i32 %t162, 164
+  %t164 = add i32 %t163, 165
+  %t165 = add i32 %t164, 166
+  %t166 = add i32 %t165, 167
+  %t167 = add i32 %t166, 168
+  %t168 = add i32 %t167, 169
+  %t169 = add i32 %t168, 170
+  %t170 = add i32 %t169, 171
+  %t171 = add i32 %t170, 172
+  %t172 = add i32 %t171, 173
+  %t173 = add i32 %t172, 174
+  %t174 = add i32 %t173, 175
+  %t175 = add i32 %t174, 176
+  %t176 = add i32 %t175, 177
+  %t177 = add i32 %t176, 178
+  %t178 = add i32 %t177, 179
+  %t179 = add i32 %t178, 180
+  %0 = load i32* %src, align 4
+  %t179.1 = add i32 %t179, %0
+  %t180 = add i32 %t179.1, 181
+  %t181 = add i32 %t180, 182
+  %t182 = add i32 %t181, 183
+  %t183 = add i32 %t182, 184
+  %t184 = add i32 %t183, 185
+  %t185 = add i32 %t184, 186
+  %t186 = add i32 %t185, 187
+  %t187 = add i32 %t186, 188
+  %t188 = add i32 %t187, 189
+  %t189 = add i32 %t188, 190
+  %t190 = add i32 %t189, 191
+  %t191 = add i32 %t190, 192
+  %t192 = add i32 %t191, 193
+  %t193 = add i32 %t192, 194
+  %t194 = add i32 %t193, 195
+  %t195 = add i32 %t194, 196
+  %t196 = add i32 %t195, 197
+  %t197 = add i32 %t196, 198
+  %t198 = add i32 %t197, 199
+  %t199 = add i32 %t198, 200
+  %arrayidx1 = getelementptr inbounds i32* %dst, i64 1
+  store i32 %t199, i32* %arrayidx1, align 4
+  ret void
+}
+
+; Stores separated by more than the linear scan window are merged as well. The
+; load in between does not alias with them.
+
+; CHECK-LABEL: define void @f2
+; CHECK: %0 = load i32* %src, align 4
+; CHECK: [[PTR:%.*]] = bitcast i32* %dst to <2 x i32>*
+; CHECK: store <2 x i32> {{.*}}, <2 x i32>* [[PTR]], align 4
+; CHECK: ret void
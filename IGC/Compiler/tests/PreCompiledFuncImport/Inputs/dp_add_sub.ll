@@ -0,0 +1,48 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; Stand-in for the dp add/sub emulation library, used by dp_specialize.ll.
+
+define double @__igcbuiltin_dp_add(double %xin, double %yin, i32 %rmode, i32 %ftz, i32 %daz, i32* %pflags) {
+entry:
+  %sum = fadd double %xin, %yin
+  %isRN = icmp eq i32 %rmode, 0
+  br i1 %isRN, label %done, label %round
+
+round:
+  %rounded = call double @__igcbuiltin_dp_round(double %sum, i32 %rmode)
+  br label %done
+
+done:
+  %res = phi double [ %sum, %entry ], [ %rounded, %round ]
+  ret double %res
+}
+
+define double @__igcbuiltin_dp_round(double %x, i32 %rmode) {
+entry:
+  %bias = sitofp i32 %rmode to double
+  %res = fadd double %x, %bias
+  ret double %res
+}
@@ -0,0 +1,50 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: llvm-as %S/Inputs/dp_add_sub.ll -o %t.bc
+; RUN: igc_opt %s -S -o - -igc-precompiled-import -igc-precompiled-import-emu-kind=2 -igc-precompiled-import-lib=%t.bc | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; Every call to the dp add emulation passes the same rounding mode, ftz and daz,
+; so the imported variant is specialized on them. Round to nearest folds away
+; the rounding helper, which is then not imported at all.
+
+define void @f0(double %x, double %y, double* %dst) {
+entry:
+  %sum = fadd double %x, %y
+  store double %sum, double* %dst, align 8
+  ret void
+}
+
+; CHECK-LABEL: define void @f0
+; CHECK: %sum = call double @__igcbuiltin_dp_add.spec.2_0.3_1.4_1(double %x, double %y, i32 0, i32 1, i32 1, i32* %DPEmuFlag)
+; CHECK: ret void
+
+; CHECK-NOT: @__igcbuiltin_dp_add(
+; CHECK: define internal double @__igcbuiltin_dp_add.spec.2_0.3_1.4_1(
+; CHECK-NOT: call
+; CHECK: ret double
+; CHECK-NOT: @__igcbuiltin_dp_round
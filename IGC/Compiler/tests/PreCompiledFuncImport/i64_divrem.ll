@@ -0,0 +1,58 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-precompiled-import -igc-precompiled-import-emu-kind=1 | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; i64 udiv and urem each import the slice of the emulation library rooted at
+; their own function. The slices are linked one after the other, and the
+; second declaration is looked up again after the first slice is linked.
+
+define void @f0(i64 %x, i64 %y, i64* %dst) {
+entry:
+  %q = udiv i64 %x, %y
+  %r = urem i64 %x, %y
+  store i64 %q, i64* %dst, align 8
+  %arrayidx1 = getelementptr inbounds i64* %dst, i32 1
+  store i64 %r, i64* %arrayidx1, align 8
+  ret void
+}
+
+; CHECK-LABEL: define void @f0
+; CHECK: %q = call i64 @__precompiled_udiv(i64 %x, i64 %y)
+; CHECK: %r = call i64 @__precompiled_umod(i64 %x, i64 %y)
+; CHECK: ret void
+
+; CHECK-NOT: declare i64 @__precompiled_udiv
+; CHECK-NOT: declare i64 @__precompiled_umod
+; CHECK-DAG: define internal i64 @__precompiled_udiv(
+; CHECK-DAG: define internal i64 @__precompiled_umod(
+
+; Only the slices in use are imported, not the whole library.
+
+; CHECK-NOT: define {{.*}} @__precompiled_sdiv
+; CHECK-NOT: define {{.*}} @__precompiled_smod
+; CHECK-NOT: define {{.*}} @__precompiled_udiv2(
@@ -0,0 +1,109 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-stateless-to-statefull-resolution -igc-stateless-to-statefull-indvar | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; A pointer induction variable that only moves forward from a kernel argument
+; gets an i32 offset phi beside it, and an index that is a no-signed-wrap
+; induction variable starting at zero is proven non-negative.
+
+define void @indvar(i32 addrspace(1)* %dst, i32 addrspace(1)* %src, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %p = phi i32 addrspace(1)* [ %dst, %entry ], [ %p.next, %loop ]
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %arrayidx = getelementptr inbounds i32 addrspace(1)* %src, i32 %i
+  %v = load i32 addrspace(1)* %arrayidx, align 4
+  store i32 %v, i32 addrspace(1)* %p, align 4
+  %p.next = getelementptr inbounds i32 addrspace(1)* %p, i32 1
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: define void @indvar
+; CHECK: loop:
+; CHECK: [[OFF:%[0-9]+]] = phi i32 [ 0, %entry ], [ [[NEXT:%[0-9]+]], %loop ]
+; CHECK: [[I:%[0-9]+]] = bitcast i32 %i to i32
+; CHECK: [[IDX:%[0-9]+]] = mul i32 [[I]], 4
+; CHECK: [[SRCOFF:%[0-9]+]] = add i32 0, [[IDX]]
+; CHECK: [[SRCPTR:%[0-9]+]] = inttoptr i32 [[SRCOFF]] to i32 addrspace([[SRCAS:[0-9]+]])*
+; CHECK: [[V:%[0-9]+]] = load i32 addrspace([[SRCAS]])* [[SRCPTR]], align 4
+; CHECK: [[DSTPTR:%[0-9]+]] = inttoptr i32 [[OFF]] to i32 addrspace([[DSTAS:[0-9]+]])*
+; CHECK: store i32 [[V]], i32 addrspace([[DSTAS]])* [[DSTPTR]], align 4
+; CHECK: [[NEXT]] = add i32 [[OFF]], 4
+; CHECK: ret void
+
+; A pointer phi that also starts from a different argument is left stateless.
+
+define void @two_bases(i32 addrspace(1)* %a, i32 addrspace(1)* %b, i1 %c) {
+entry:
+  br i1 %c, label %then, label %join
+
+then:
+  br label %join
+
+join:
+  %p = phi i32 addrspace(1)* [ %a, %entry ], [ %b, %then ]
+  store i32 0, i32 addrspace(1)* %p, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @two_bases
+; CHECK-NOT: inttoptr
+; CHECK: store i32 0, i32 addrspace(1)* %p, align 4
+
+!igc.functions = !{!0, !18}
+
+!0 = metadata !{void (i32 addrspace(1)*, i32 addrspace(1)*, i32)* @indvar, metadata !1}
+!1 = metadata !{metadata !2, metadata !3, metadata !4, metadata !12, metadata !13, metadata !14, metadata !15, metadata !16, metadata !17}
+!2 = metadata !{metadata !"function_type", i32 0}
+!3 = metadata !{metadata !"implicit_arg_desc"}
+!4 = metadata !{metadata !"resource_alloc", metadata !5, metadata !6, metadata !7, metadata !8}
+!5 = metadata !{metadata !"uavs_num", i32 2}
+!6 = metadata !{metadata !"srvs_num", i32 0}
+!7 = metadata !{metadata !"samplers_num", i32 0}
+!8 = metadata !{metadata !"arg_allocs", metadata !9, metadata !10, metadata !11}
+!9 = metadata !{i32 1, null, i32 0}
+!10 = metadata !{i32 1, null, i32 1}
+!11 = metadata !{i32 0, null, null}
+!12 = metadata !{metadata !"opencl_kernel_arg_addr_space", i32 1, i32 1, i32 0}
+!13 = metadata !{metadata !"opencl_kernel_arg_access_qual", metadata !"none", metadata !"none", metadata !"none"}
+!14 = metadata !{metadata !"opencl_kernel_arg_type", metadata !"int*", metadata !"int*", metadata !"int"}
+!15 = metadata !{metadata !"opencl_kernel_arg_base_type", metadata !"int*", metadata !"int*", metadata !"int"}
+!16 = metadata !{metadata !"opencl_kernel_arg_type_qual", metadata !"", metadata !"", metadata !""}
+!17 = metadata !{metadata !"opencl_kernel_arg_name", metadata !"dst", metadata !"src", metadata !"n"}
+!18 = metadata !{void (i32 addrspace(1)*, i32 addrspace(1)*, i1)* @two_bases, metadata !19}
+!19 = metadata !{metadata !2, metadata !3, metadata !4, metadata !12, metadata !13, metadata !20, metadata !21, metadata !16, metadata !22}
+!20 = metadata !{metadata !"opencl_kernel_arg_type", metadata !"int*", metadata !"int*", metadata !"bool"}
+!21 = metadata !{metadata !"opencl_kernel_arg_base_type", metadata !"int*", metadata !"int*", metadata !"bool"}
+!22 = metadata !{metadata !"opencl_kernel_arg_name", metadata !"a", metadata !"b", metadata !"c"}
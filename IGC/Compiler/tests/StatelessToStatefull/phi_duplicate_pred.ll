@@ -0,0 +1,81 @@
+;===================== begin_copyright_notice ==================================
+
+;Copyright (c) 2017 Intel Corporation
+
+;Permission is hereby granted, free of charge, to any person obtaining a
+;copy of this software and associated documentation files (the
+;"Software"), to deal in the Software without restriction, including
+;without limitation the rights to use, copy, modify, merge, publish,
+;distribute, sublicense, and/or sell copies of the Software, and to
+;permit persons to whom the Software is furnished to do so, subject to
+;the following conditions:
+
+;The above copyright notice and this permission notice shall be included
+;in all copies or substantial portions of the Software.
+
+;THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+;OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+;MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+;IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+;CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+;TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+;SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+;======================= end_copyright_notice ==================================
+; RUN: igc_opt %s -S -o - -igc-stateless-to-statefull-resolution -igc-stateless-to-statefull-indvar | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; The entry block reaches %join through two switch cases, so it is listed
+; twice in the pointer phi. Both entries of the offset phi must take the same
+; value or the phi is invalid.
+
+define void @switch_phi(i32 addrspace(1)* %dst, i32 %x) {
+entry:
+  %q = getelementptr inbounds i32 addrspace(1)* %dst, i32 4
+  switch i32 %x, label %other [
+    i32 0, label %join
+    i32 1, label %join
+  ]
+
+other:
+  %r = getelementptr inbounds i32 addrspace(1)* %dst, i32 8
+  br label %join
+
+join:
+  %p = phi i32 addrspace(1)* [ %q, %entry ], [ %q, %entry ], [ %r, %other ]
+  store i32 %x, i32 addrspace(1)* %p, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @switch_phi
+; CHECK: entry:
+; CHECK: [[Q:%[0-9]+]] = add i32 0, 16
+; CHECK-NOT: add i32 0, 16
+; CHECK: other:
+; CHECK: [[R:%[0-9]+]] = add i32 0, 32
+; CHECK: join:
+; CHECK: [[OFF:%[0-9]+]] = phi i32 [ [[Q]], %entry ], [ [[Q]], %entry ], [ [[R]], %other ]
+; CHECK: [[PTR:%[0-9]+]] = inttoptr i32 [[OFF]] to i32 addrspace({{[0-9]+}})*
+; CHECK: store i32 %x, i32 addrspace({{[0-9]+}})* [[PTR]], align 4
+
+!igc.functions = !{!0}
+
+!0 = metadata !{void (i32 addrspace(1)*, i32)* @switch_phi, metadata !1}
+!1 = metadata !{metadata !2, metadata !3, metadata !4, metadata !9, metadata !10, metadata !11, metadata !12, metadata !13, metadata !14}
+!2 = metadata !{metadata !"function_type", i32 0}
+!3 = metadata !{metadata !"implicit_arg_desc"}
+!4 = metadata !{metadata !"resource_alloc", metadata !5, metadata !6, metadata !7, metadata !8}
+!5 = metadata !{metadata !"uavs_num", i32 1}
+!6 = metadata !{metadata !"srvs_num", i32 0}
+!7 = metadata !{metadata !"samplers_num", i32 0}
+!8 = metadata !{metadata !"arg_allocs", metadata !15, metadata !16}
+!9 = metadata !{metadata !"opencl_kernel_arg_addr_space", i32 1, i32 0}
+!10 = metadata !{metadata !"opencl_kernel_arg_access_qual", metadata !"none", metadata !"none"}
+!11 = metadata !{metadata !"opencl_kernel_arg_type", metadata !"int*", metadata !"int"}
+!12 = metadata !{metadata !"opencl_kernel_arg_base_type", metadata !"int*", metadata !"int"}
+!13 = metadata !{metadata !"opencl_kernel_arg_type_qual", metadata !"", metadata !""}
+!14 = metadata !{metadata !"opencl_kernel_arg_name", metadata !"dst", metadata !"x"}
+!15 = metadata !{i32 1, null, i32 0}
+!16 = metadata !{i32 0, null, null}
@@ -540,29 +540,22 @@ void GenISAIntrinsic::getIntrinsicInfoTableEntries(GenISAIntrinsic::ID id,
 }
 
 GenISAIntrinsic::ID GenISAIntrinsic::getIntrinsicID(const Function *F) {
-    IGC::LLVMContextWrapper::SafeIntrinsicIDCacheTy* safeIntrinsicIDCache =
-        &(static_cast<IGC::LLVMContextWrapper*>(&F->getContext())->m_SafeIntrinsicIDCache);
-    
-    //If you do not find the function ptr as key corresponding to the GenISAIntrinsic::ID add the new key
-    auto it = (*safeIntrinsicIDCache).find(F);
-    if (it == (*safeIntrinsicIDCache).end()) {
-        const ValueName *valueName = F->getValueName();
-        GenISAIntrinsic::ID Id = no_intrinsic;
-        unsigned int Len = valueName->getKeyLength();
-        const char* Name = valueName->getKeyData();
-        // we expect that only IGC intrinsics should call this function
-        assert(!(Len < 5 || Name[4] != '.' || Name[0] != 'g' || Name[1] != 'e'
-            || Name[2] != 'n' || Name[3] != 'x'));
-        Id = lookupGenIntrinsicID(Name, Len);
-        (*safeIntrinsicIDCache)[F] = Id;
-        return Id;
-    }
-    else
+    IGC::LLVMContextWrapper::IntrinsicIDCache& cache =
+        static_cast<IGC::LLVMContextWrapper*>(&F->getContext())->m_IntrinsicIDCache;
+    if (const unsigned* cachedId = cache.find(F))
     {
-        // If you have an entry for the function ptr corresponding to the GenISAIntrinsic::ID return it back,
-        //instead of going through a lengthy look-up.
-        return (static_cast<GenISAIntrinsic::ID>(it->second)); 
+        return static_cast<GenISAIntrinsic::ID>(*cachedId);
     }
+
+    const ValueName *valueName = F->getValueName();
+    unsigned int Len = valueName->getKeyLength();
+    const char* Name = valueName->getKeyData();
+    // we expect that only IGC intrinsics should call this function
+    assert(!(Len < 5 || Name[4] != '.' || Name[0] != 'g' || Name[1] != 'e'
+        || Name[2] != 'n' || Name[3] != 'x'));
+    GenISAIntrinsic::ID Id = lookupGenIntrinsicID(Name, Len);
+    cache.insert(F, Id);
+    return Id;
 }
 
 GenISAIntrinsic::ID GenISAIntrinsic::lookupGenIntrinsicID(const char *Name, unsigned int Len)
@@ -570,5 +563,4 @@ GenISAIntrinsic::ID GenISAIntrinsic::lookupGenIntrinsicID(const char *Name, unsi
 #define GET_FUNCTION_RECOGNIZER
 #include "IntrinsicGenISA.gen"
 #undef GET_FUNCTION_RECOGNIZER
-    return no_intrinsic;
 }
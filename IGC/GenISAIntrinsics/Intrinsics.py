@@ -129,108 +129,109 @@ def generateIDArray():
     f.write("#endif\n\n")
     f.close()
 
-def numberofCharacterMatches(array_of_strings):
-    other_array = []
-    if isinstance(array_of_strings,list):
-        for i in range(len(array_of_strings)):
-            final_num = 0
-            char_string = str()
-            for j in range(len(array_of_strings[i])):
-                char_string += array_of_strings[i][j]
-                matching = [s for s in array_of_strings if char_string == s[:len(char_string)]]
-                if len(matching) <= 1:
-                    break
-                else:
-                    final_num += 1 
-            other_array.append([final_num-7,array_of_strings[i][7:]]) #Subtract 7 because of GenISA_
-    return other_array
-
-
-def sortedIntrinsicsOnLenth():
-    final_array = []
-    special_array = numberofCharacterMatches(ID_array)
-    for i in range(len(special_array)):
-        pair = [special_array[i][1] + "@","GenISAIntrinsic::GenISA_"+special_array[i][1]]
-        final_array.append([special_array[i][0],pair])
+# The recognizer is a minimal-probe perfect hash over the full intrinsic names
+# ("genx.GenISA.foo.bar"). FNV-1a is computed incrementally over the function
+# name, so the hash of every '.'-delimited prefix is available in one pass; the
+# longest prefix that names an intrinsic wins and the rest is the overload
+# suffix. Keys are first split into buckets, then each bucket gets the
+# displacement that places all of its keys into free slots.
+HASH_MASK = (1 << 64) - 1
+FNV_OFFSET = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+DISPLACEMENT_MUL = 0x9E3779B97F4A7C15
+
+def fnv1a(name):
+    h = FNV_OFFSET
+    for c in name:
+        h = ((h ^ ord(c)) * FNV_PRIME) & HASH_MASK
+    return h
+
+def mix(x):
+    x ^= x >> 33
+    x = (x * 0xff51afd7ed558ccd) & HASH_MASK
+    x ^= x >> 33
+    return x
+
+def nextPowerOfTwo(n):
+    p = 1
+    while p < n:
+        p <<= 1
+    return p
+
+def buildPerfectHash(names):
+    num_buckets = nextPowerOfTwo(max(len(names) // 2, 1))
+    num_slots = nextPowerOfTwo(len(names) + len(names) // 4)
+    buckets = [[] for i in range(num_buckets)]
+    for name in names:
+        h = fnv1a(name)
+        buckets[mix(h) & (num_buckets - 1)].append((name, h))
+    displacements = [0] * num_buckets
+    slots = [None] * num_slots
+    for b in sorted(range(num_buckets), key=lambda i: -len(buckets[i])):
+        if not buckets[b]:
+            continue
+        for d in range(1 << 16):
+            positions = [mix((h + d * DISPLACEMENT_MUL) & HASH_MASK) & (num_slots - 1) for (name, h) in buckets[b]]
+            if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+                break
+        else:
+            raise Exception("Unable to build the GenISA intrinsic perfect hash")
+        displacements[b] = d
+        for (name, h), p in zip(buckets[b], positions):
+            slots[p] = name
+    return displacements, slots
+
+def createFunctionRecognizer():
+    names = dict()
+    for i in range(len(ID_array)):
+        name = "genx." + ID_array[i].replace("_",".")
+        if name in names:
+            raise Exception("Intrinsics " + names[name] + " and " + ID_array[i] + " have the same name")
+        names[name] = ID_array[i]
+    displacements, slots = buildPerfectHash(sorted(names))
+    max_len = max(len(name) for name in names)
 
     f = open(outputFile,"a")
-    f.write("// Sorted by length table\n"
+    f.write("// Perfect hash function recognizer\n"
             "#ifdef GET_FUNCTION_RECOGNIZER\n"
-            "static const std::vector<std::pair<unsigned,std::pair<std::string,GenISAIntrinsic::ID>>> LengthTable = {\n")
-    for i in range(len(final_array)):
-        #Go through and write each element
-        f.write("{ "+str(final_array[i][0])+",{\""+str(final_array[i][1][0])+"\","+ str(final_array[i][1][1])+"}}, ")
-        if i%2 == 0:
-            f.write("\n")
+            "struct IntrinsicNameEntry { const char* Name; unsigned Len; GenISAIntrinsic::ID Id; };\n"
+            "static const unsigned short Displacements[] = {\n  ")
+    for i in range(len(displacements)):
+        f.write(str(displacements[i]) + ", ")
+        if i%16 == 15:
+            f.write("\n  ")
+    f.write("\n};\n\n")
+    f.write("static const IntrinsicNameEntry Entries[] = {\n")
+    for name in slots:
+        if name is None:
+            f.write("  { nullptr, 0, GenISAIntrinsic::no_intrinsic },\n")
+        else:
+            f.write("  { \"" + name + "\", " + str(len(name)) + ", GenISAIntrinsic::" + names[name] + " },\n")
     f.write("};\n\n")
-    
-    #Now to write the algorithm to search
-    f.write("std::string input_name(Name);\n"
-            "unsigned start = 0;\n"
-            "unsigned end = "+str(len(final_array))+";\n"
-            "unsigned initial_size = end;\n"
-            "unsigned cur_pos = (start + end) / 2;\n"
-            "char letter;\n"
-            "char input_letter;\n"
-            "bool isError = false;\n"
-            "bool bump = false;\n"
-            "for (unsigned i = 0; i < Len; i++)\n"
+
+    f.write("auto mix = [](uint64_t x) {\n"
+            "    x ^= x >> 33;\n"
+            "    x *= 0xff51afd7ed558ccdULL;\n"
+            "    x ^= x >> 33;\n"
+            "    return x;\n"
+            "};\n"
+            "GenISAIntrinsic::ID result = GenISAIntrinsic::no_intrinsic;\n"
+            "uint64_t hash = 0xcbf29ce484222325ULL;\n"
+            "unsigned end = Len < " + str(max_len) + " ? Len : " + str(max_len) + ";\n"
+            "for (unsigned i = 0; i <= end; i++)\n"
             "{\n"
-            "    input_letter = input_name[12 + i];\n"
-            "    unsigned counter = 0;\n"
-            "    while (1)\n"
+            "    if (i == Len || Name[i] == '.')\n"
             "    {\n"
-            "        if (counter == initial_size || cur_pos >= initial_size)\n"
-            "        {\n"
-            "            isError = true;\n"
-            "            break;\n"
-            "        }\n"
-            "        counter++;\n"
-            "        letter = LengthTable[cur_pos].second.first[i];\n"
-            "        if (letter == input_letter)\n"
-            "        {\n"
-            "            if (LengthTable[cur_pos].first == i)\n"
-            "                return LengthTable[cur_pos].second.second;\n"
-            "            bump = true;\n"
-            "            break;\n"
-            "        }\n"
-            "        else if (input_letter == '\\0' && letter == '@')\n"
-            "            return LengthTable[cur_pos].second.second;\n"
-            "        else if (input_letter == '.' && letter == '_')\n"
-            "            break;\n"
-            "        else if (input_letter == '.' && letter == '@')\n"
-            "        {\n"
-            "            unsigned original_cur_pos = cur_pos;\n"
-            "            while (1)\n"
-            "            {\n"
-            "                if (cur_pos >= initial_size || LengthTable[cur_pos].first < i)\n"
-            "                    return LengthTable[original_cur_pos].second.second;\n"
-            "                if (LengthTable[cur_pos].second.first[i] == '_')\n"
-            "                    break;\n"
-            "                cur_pos += 1;\n"
-            "            }\n"
-            "            break;\n"
-            "        }\n"
-            "        else if ((bump && letter < input_letter) || letter == '@')\n"
-            "        {\n"
-            "            cur_pos += 1;\n"
-            "            continue;\n"
-            "        }\n"
-            "        else if (bump && letter > input_letter)\n"
-            "        {\n"
-            "            cur_pos -= 1;\n"
-            "            continue;\n"
-            "        }\n"
-            "        else if (letter < input_letter)\n"
-            "            start = cur_pos;\n"
-            "        else\n"
-            "            end = cur_pos;\n"
-            "        cur_pos = (start + end) / 2;\n"
+            "        uint64_t displacement = Displacements[mix(hash) & " + str(len(displacements) - 1) + "];\n"
+            "        const IntrinsicNameEntry& entry = Entries[mix(hash + displacement * 0x9E3779B97F4A7C15ULL) & " + str(len(slots) - 1) + "];\n"
+            "        if (entry.Len == i && memcmp(entry.Name, Name, i) == 0)\n"
+            "            result = entry.Id;\n"
             "    }\n"
-            "    if (isError)\n"
-            "        break;\n"
-            "}\n")
-    f.write("\n#endif\n\n")
+            "    if (i < Len)\n"
+            "        hash = (hash ^ (unsigned char)Name[i]) * 0x100000001b3ULL;\n"
+            "}\n"
+            "return result;\n"
+            "#endif\n\n")
     f.close()
 
 def createOverloadTable():
@@ -426,7 +427,7 @@ emitPrefix()
 generateEnums()
 generateIDArray()
 createOverloadTable()
-sortedIntrinsicsOnLenth()
+createFunctionRecognizer()
 createTypeTable()
 createAttributeTable()
 emitSuffix()
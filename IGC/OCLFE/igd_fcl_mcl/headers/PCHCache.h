@@ -0,0 +1,119 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#ifndef FCL_PCHCACHE_H
+#define FCL_PCHCACHE_H
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace TC
+{
+    /***************************************************************************\
+
+    Class:
+        CPCHCache
+
+    Description:
+        On-disk cache of precompiled compile-time headers, shared by all
+        processes of the current user. Entries are keyed by everything that
+        affects the preprocessed header: the front end module, the header
+        itself, OpenCL version, extensions, -D/-U macros and target.
+
+        The cache directory is taken from IGC_FCL_PCH_CACHE_DIR (an empty value
+        disables the cache) and defaults to a per-user cache directory.
+        Generation of a missing entry is serialized across processes with a
+        lock file and the entry is published with an atomic rename, so readers
+        never observe a partially written PCH. Entries on disk are evicted least
+        recently used first once they exceed a size limit. Within a process,
+        each key is generated by one thread at a time without blocking lookups
+        of other keys, and the most recently used PCHs are kept in memory.
+
+    \***************************************************************************/
+    class CPCHCache
+    {
+    public:
+        typedef std::shared_ptr<const std::string> PCHBuffer;
+        typedef std::function<bool(std::string& pch)> PCHGenerator;
+
+        static CPCHCache& GetInstance();
+
+        bool IsEnabled() const { return !m_directory.empty(); }
+
+        // Returns the PCH stored under the given key, calling generate on a
+        // miss. Returns null if no usable PCH could be loaded or generated. A
+        // key whose generation failed is not generated again by this process;
+        // other misses, such as timing out on another process's lock, are
+        // retried by the next call.
+        PCHBuffer GetPCH(const std::string& key, const PCHGenerator& generate);
+
+        // Builds a cache key out of an ordered list of key components
+        static std::string MakeKey(const std::vector<std::string>& parts);
+
+        // Returns a string identifying the exact binary of the loaded module
+        // that contains the given symbol (path, size and modification time)
+        static std::string GetModuleIdentity(void* pModule, const void* pSymbol);
+
+    private:
+        CPCHCache();
+
+        struct SEntry
+        {
+            PCHBuffer pch;
+            bool inFlight;                                  // being loaded or generated
+            bool failed;                                    // generation failed, not retried
+            std::list<std::string>::iterator lruPosition;   // valid once loaded
+        };
+
+        PCHBuffer LoadOrGenerate(const std::string& key, const PCHGenerator& generate, bool& generationFailed) const;
+        PCHBuffer ReadEntry(const std::string& path, const std::string& key) const;
+        bool WriteEntry(const std::string& path, const std::string& key, const std::string& pch) const;
+        void EvictEntries();
+        void EvictDiskEntries() const;
+
+        std::string m_directory;
+        std::mutex m_mutex;
+        std::condition_variable m_entryDone;
+        std::map<std::string, SEntry> m_entries;
+        std::list<std::string> m_lru;       // loaded keys, least recently used first
+        size_t m_memorySize;                // bytes of the loaded PCHs
+    };
+
+    // Returns the part of the front end options that affects the contents of
+    // the PCH: macro definitions, language and target options. Options which
+    // only affect code generation or output (include paths, dumps, debug source
+    // paths) are dropped so that they do not fragment the cache.
+    std::string GetPCHRelevantOptions(const std::string& options);
+
+} // namespace TC
+
+#endif // FCL_PCHCACHE_H
@@ -32,6 +32,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 
 #include "LoadBuffer.h"
+#include "PCHCache.h"
 #include "AdaptorOCL/CLElfLib/ElfReader.h"
 // TODO: really need this to point to the header file from the common clang
 // zip instead of our own copy.
@@ -172,6 +173,11 @@ namespace TC
                                   std::string& exceptString);
       
       void EnsureProperPCH( TranslateClangArgs* pArgs, const char* pInternalOptions, std::string& exceptString);
+
+      CPCHCache::PCHBuffer GetCachedPCH( const TranslateClangArgs* pInputArgs,
+                                         const std::string& options,
+                                         const std::string& optionsEx,
+                                         std::string& pchOptionsEx );
       
       bool ReturnSuppliedIR( const STB_TranslateInputArgs* pInputArgs,
                            STB_TranslateOutputArgs* pOutputArgs );
@@ -0,0 +1,495 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+#include "../headers/PCHCache.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+using namespace llvm;
+
+namespace TC
+{
+    static const char* const g_PCHEntryMagic = "IGCFCLPCH1";
+
+    // Bytes of PCHs kept in memory. Keys vary with user macros, so without a
+    // bound a long-running process accumulates one multi-MB buffer per variant.
+    static const size_t g_PCHMemoryLimit = 64 * 1024 * 1024;
+
+    // Bytes of PCH entries kept on disk, shared by all processes of the user.
+    static const uint64_t g_PCHDiskLimit = 512 * 1024 * 1024;
+
+    static std::string HashString(StringRef data)
+    {
+        MD5 hash;
+        hash.update(data);
+        MD5::MD5Result result;
+        hash.final(result);
+        SmallString<32> hex;
+        MD5::stringifyResult(result, hex);
+        return hex.str().str();
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::CPCHCache
+
+    Description:
+    Resolves and creates the cache directory. Leaves the cache disabled if the
+    directory is explicitly set to an empty string or cannot be created.
+
+    \*****************************************************************************/
+    CPCHCache::CPCHCache() : m_memorySize(0)
+    {
+        SmallString<256> directory;
+        if (const char* pOverride = getenv("IGC_FCL_PCH_CACHE_DIR"))
+        {
+            directory = pOverride;
+        }
+        else
+        {
+#if defined(_WIN32)
+            if (const char* pLocalAppData = getenv("LOCALAPPDATA"))
+            {
+                sys::path::append(directory, pLocalAppData, "Intel", "IGC", "fcl_pch");
+            }
+#else
+            if (const char* pXdgCache = getenv("XDG_CACHE_HOME"))
+            {
+                sys::path::append(directory, pXdgCache, "intel-igc", "fcl_pch");
+            }
+            else if (const char* pHome = getenv("HOME"))
+            {
+                sys::path::append(directory, pHome, ".cache", "intel-igc", "fcl_pch");
+            }
+#endif
+        }
+
+        if (!directory.empty() && !sys::fs::create_directories(directory))
+        {
+            m_directory = directory.str().str();
+        }
+    }
+
+    CPCHCache& CPCHCache::GetInstance()
+    {
+        static CPCHCache instance;
+        return instance;
+    }
+
+    std::string CPCHCache::MakeKey(const std::vector<std::string>& parts)
+    {
+        std::string keyData;
+        for (const std::string& part : parts)
+        {
+            // length-prefix every part so that different splits never collide
+            keyData += std::to_string(part.size());
+            keyData += ':';
+            keyData += part;
+        }
+        return HashString(keyData);
+    }
+
+    std::string CPCHCache::GetModuleIdentity(void* pModule, const void* pSymbol)
+    {
+        std::string path;
+#if defined(_WIN32)
+        (void)pSymbol;
+        char fileName[MAX_PATH] = {};
+        if (GetModuleFileNameA((HMODULE)pModule, fileName, MAX_PATH) != 0)
+        {
+            path = fileName;
+        }
+#else
+        (void)pModule;
+        Dl_info info;
+        if (dladdr(pSymbol, &info) != 0 && info.dli_fname != nullptr)
+        {
+            path = info.dli_fname;
+        }
+#endif
+        sys::fs::file_status status;
+        if (path.empty() || sys::fs::status(path, status))
+        {
+            return path;
+        }
+
+        std::ostringstream identity;
+        identity << path << ';' << status.getSize() << ';'
+                 << sys::toTimeT(status.getLastModificationTime());
+        return identity.str();
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::ReadEntry
+
+    Description:
+    Loads a cache entry and verifies its header and checksum. Any mismatch is
+    treated as a miss. A hit refreshes the modification time of the entry,
+    which orders the entries for EvictDiskEntries.
+
+    \*****************************************************************************/
+    CPCHCache::PCHBuffer CPCHCache::ReadEntry(const std::string& path, const std::string& key) const
+    {
+        int fd = -1;
+        if (sys::fs::openFileForRead(path, fd))
+        {
+            return nullptr;
+        }
+        auto file = MemoryBuffer::getOpenFile(fd, path, -1, /*RequiresNullTerminator=*/false);
+        if (file)
+        {
+            // best effort, a stale time only makes the entry evicted earlier
+            sys::fs::setLastModificationAndAccessTime(fd, std::chrono::system_clock::now());
+        }
+        sys::Process::SafelyCloseFileDescriptor(fd);
+        if (!file)
+        {
+            return nullptr;
+        }
+
+        StringRef contents = (*file)->getBuffer();
+        StringRef fields[4];
+        for (StringRef& field : fields)
+        {
+            std::tie(field, contents) = contents.split('\n');
+        }
+
+        unsigned long long size = 0;
+        if (fields[0] != g_PCHEntryMagic || fields[1] != key ||
+            fields[2].getAsInteger(10, size) || size != contents.size() ||
+            fields[3] != HashString(contents))
+        {
+            return nullptr;
+        }
+
+        return std::make_shared<const std::string>(contents.str());
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::WriteEntry
+
+    Description:
+    Writes a cache entry to a unique temporary file and renames it over the
+    final path, so concurrent readers see either the old or the new entry.
+
+    \*****************************************************************************/
+    bool CPCHCache::WriteEntry(const std::string& path, const std::string& key, const std::string& pch) const
+    {
+        int fd = -1;
+        SmallString<256> tempPath;
+        if (sys::fs::createUniqueFile(path + "-%%%%%%%%.tmp", fd, tempPath))
+        {
+            return false;
+        }
+
+        {
+            raw_fd_ostream os(fd, /*shouldClose=*/true);
+            os << g_PCHEntryMagic << '\n' << key << '\n' << pch.size() << '\n'
+               << HashString(pch) << '\n' << pch;
+            os.close();
+            if (os.has_error())
+            {
+                os.clear_error();
+                sys::fs::remove(tempPath);
+                return false;
+            }
+        }
+
+        if (sys::fs::rename(tempPath, path))
+        {
+            sys::fs::remove(tempPath);
+            return false;
+        }
+        return true;
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::GetPCH
+
+    Description:
+    Looks the key up in memory. On a miss the calling thread marks the key as in
+    flight and loads or generates the PCH without holding the cache lock, so
+    lookups of other keys proceed; threads asking for the same key wait for it.
+    A failed generation is remembered so that every build of the process does
+    not pay for it again; other failures are forgotten and a later call tries
+    again.
+
+    \*****************************************************************************/
+    CPCHCache::PCHBuffer CPCHCache::GetPCH(const std::string& key, const PCHGenerator& generate)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                auto it = m_entries.find(key);
+                if (it == m_entries.end())
+                {
+                    break;
+                }
+                if (!it->second.inFlight)
+                {
+                    if (it->second.failed)
+                    {
+                        return nullptr;
+                    }
+                    m_lru.splice(m_lru.end(), m_lru, it->second.lruPosition);
+                    return it->second.pch;
+                }
+                m_entryDone.wait(lock);
+            }
+
+            SEntry& entry = m_entries[key];
+            entry.inFlight = true;
+            entry.failed = false;
+        }
+
+        bool generationFailed = false;
+        PCHBuffer pch = LoadOrGenerate(key, generate, generationFailed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(key);
+            if (pch)
+            {
+                it->second.pch = pch;
+                it->second.inFlight = false;
+                it->second.lruPosition = m_lru.insert(m_lru.end(), key);
+                m_memorySize += pch->size();
+                EvictEntries();
+            }
+            else if (generationFailed)
+            {
+                it->second.failed = true;
+                it->second.inFlight = false;
+            }
+            else
+            {
+                m_entries.erase(it);
+            }
+        }
+        m_entryDone.notify_all();
+        return pch;
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::LoadOrGenerate
+
+    Description:
+    Reads the entry from disk. On a miss, one process generates the PCH while
+    holding the entry's lock file; the others wait for it and pick up the
+    published entry. If the owner of the lock dies the waiting process
+    generates the PCH itself; if the wait times out it returns null without
+    generating, and generationFailed stays false so that the key is retried.
+
+    \*****************************************************************************/
+    CPCHCache::PCHBuffer CPCHCache::LoadOrGenerate(const std::string& key, const PCHGenerator& generate, bool& generationFailed) const
+    {
+        SmallString<256> entryPath(m_directory);
+        sys::path::append(entryPath, key + ".pch");
+        const std::string path = entryPath.str().str();
+
+        PCHBuffer pch = ReadEntry(path, key);
+        if (pch)
+        {
+            return pch;
+        }
+
+        LockFileManager fileLock(path);
+        bool generateEntry = true;
+        if (fileLock == LockFileManager::LFS_Shared)
+        {
+            // another process is generating this entry
+            switch (fileLock.waitForUnlock())
+            {
+            case LockFileManager::Res_Success:
+                pch = ReadEntry(path, key);
+                generateEntry = !pch;
+                break;
+            case LockFileManager::Res_Timeout:
+                // still being generated, building without the PCH is cheaper
+                // than generating it a second time
+                return nullptr;
+            default:
+                break;
+            }
+        }
+        else
+        {
+            // the entry may have been published before the lock was taken
+            pch = ReadEntry(path, key);
+            generateEntry = !pch;
+        }
+
+        if (generateEntry)
+        {
+            std::string newPCH;
+            if (generate(newPCH) && !newPCH.empty())
+            {
+                if (WriteEntry(path, key, newPCH))
+                {
+                    EvictDiskEntries();
+                }
+                pch = std::make_shared<const std::string>(std::move(newPCH));
+            }
+            else
+            {
+                generationFailed = true;
+            }
+        }
+        return pch;
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::EvictEntries
+
+    Description:
+    Drops least recently used PCHs from memory until they fit in the limit. The
+    most recent one is always kept; buffers still in use by a build stay alive
+    through their shared pointers. Must be called with m_mutex held.
+
+    \*****************************************************************************/
+    void CPCHCache::EvictEntries()
+    {
+        while (m_memorySize > g_PCHMemoryLimit && m_lru.size() > 1)
+        {
+            auto it = m_entries.find(m_lru.front());
+            m_memorySize -= it->second.pch->size();
+            m_entries.erase(it);
+            m_lru.pop_front();
+        }
+    }
+
+    /*****************************************************************************\
+
+    Function:
+    CPCHCache::EvictDiskEntries
+
+    Description:
+    Removes the least recently used entries from the cache directory until the
+    rest fit in the disk limit. Runs after an entry is published, which is the
+    only time the directory grows. Entries removed while another process reads
+    them are still read in full on POSIX; elsewhere the removal fails and the
+    entry is left for a later pass.
+
+    \*****************************************************************************/
+    void CPCHCache::EvictDiskEntries() const
+    {
+        struct SDiskEntry
+        {
+            std::string path;
+            uint64_t size;
+            sys::TimePoint<> lastUsed;
+        };
+        std::vector<SDiskEntry> diskEntries;
+        uint64_t diskSize = 0;
+
+        std::error_code ec;
+        for (sys::fs::directory_iterator it(m_directory, ec), end; it != end && !ec; it.increment(ec))
+        {
+            const std::string& path = it->path();
+            sys::fs::file_status status;
+            if (sys::path::extension(path) != ".pch" || sys::fs::status(path, status))
+            {
+                continue;
+            }
+            diskEntries.push_back({ path, status.getSize(), status.getLastModificationTime() });
+            diskSize += status.getSize();
+        }
+
+        if (diskSize <= g_PCHDiskLimit)
+        {
+            return;
+        }
+
+        std::sort(diskEntries.begin(), diskEntries.end(),
+            [](const SDiskEntry& a, const SDiskEntry& b) { return a.lastUsed < b.lastUsed; });
+        // the newest entry, just written, is always kept
+        for (size_t i = 0; i + 1 < diskEntries.size() && diskSize > g_PCHDiskLimit; i++)
+        {
+            if (!sys::fs::remove(diskEntries[i].path))
+            {
+                diskSize -= diskEntries[i].size;
+            }
+        }
+    }
+
+    std::string GetPCHRelevantOptions(const std::string& options)
+    {
+        std::istringstream iss(options);
+        std::string relevant;
+        std::string option;
+        while (iss >> option)
+        {
+            if (option == "-I" || option == "-s")
+            {
+                // the option's value is a separate token
+                iss >> option;
+                continue;
+            }
+            if (option.compare(0, 2, "-I") == 0 ||
+                option.compare(0, 14, "-dump-opt-llvm") == 0)
+            {
+                continue;
+            }
+            relevant += option;
+            relevant += ' ';
+        }
+        return relevant;
+    }
+
+} // namespace TC
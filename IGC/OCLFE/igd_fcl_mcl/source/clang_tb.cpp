@@ -681,6 +681,69 @@ namespace TC
 
 	/*****************************************************************************\
 
+	Function:
+	CClangTranslationBlock::GetCachedPCH
+
+	Description:
+	Looks up the PCH of the compile-time header for the given options in the
+	on-disk PCH cache, generating it on the first miss. On success pchOptionsEx
+	is set to optionsEx without the textual include of the header.
+
+	Input:
+
+	Output:
+
+	\*****************************************************************************/
+	CPCHCache::PCHBuffer CClangTranslationBlock::GetCachedPCH(const TranslateClangArgs* pInputArgs,
+		const std::string& options, const std::string& optionsEx, std::string& pchOptionsEx)
+	{
+		static const std::string includeCTH = " -include CTHeader.h";
+
+		CPCHCache& cache = CPCHCache::GetInstance();
+		size_t includePosition = optionsEx.find(includeCTH);
+		if (!m_cthBuffer || !cache.IsEnabled() || includePosition == std::string::npos)
+		{
+			return nullptr;
+		}
+
+		pchOptionsEx = optionsEx;
+		pchOptionsEx.erase(includePosition, includeCTH.size());
+
+		// everything that can change the preprocessed header, including the
+		// exact front end binary since PCHs are not portable between versions
+		std::string pchOptions = GetPCHRelevantOptions(options);
+		std::string key = CPCHCache::MakeKey({
+			CPCHCache::GetModuleIdentity(m_CCModule.pModule, (const void*)m_CCModule.pCompile),
+			m_cthBuffer,
+			pInputArgs->oclVersion,
+			pchOptions,
+			GetPCHRelevantOptions(pchOptionsEx) });
+
+		const char* pOclVersion = pInputArgs->oclVersion.c_str();
+		return cache.GetPCH(key, [&](std::string& pch)
+		{
+			IOCLFEBinaryResult *pResultPtr = NULL;
+			int res = m_CCModule.pCompile(m_cthBuffer, NULL, 0, NULL, NULL, 0,
+				pchOptions.c_str(), (pchOptionsEx + " -emit-pch").c_str(), pOclVersion, &pResultPtr);
+			IOCLFEBinaryResultPtr pchResult(pResultPtr, ReleaseDP);
+			if (res != 0 || !pResultPtr || !pResultPtr->GetIR() || pResultPtr->GetIRSize() == 0)
+			{
+				return false;
+			}
+			pch.assign((const char*)pResultPtr->GetIR(), pResultPtr->GetIRSize());
+
+			// only share the PCH if the front end accepts it in place of the header
+			const char* pProbeSource = "kernel void pch_probe(global uint* p) { p[0] = (uint)get_global_id(0); }";
+			pResultPtr = NULL;
+			res = m_CCModule.pCompile(pProbeSource, NULL, 0, NULL, pch.data(), pch.size(),
+				pchOptions.c_str(), (pchOptionsEx + " -emit-llvm-bc").c_str(), pOclVersion, &pResultPtr);
+			IOCLFEBinaryResultPtr probeResult(pResultPtr, ReleaseDP);
+			return res == 0;
+		});
+	}
+
+	/*****************************************************************************\
+
 	Function:
 	CClangTranslationBlock::TranslateClang
 
@@ -700,13 +763,14 @@ namespace TC
 		std::string options = pInputArgs->options;
 		optionsEx.append(" -disable-llvm-optzns -fblocks -I. -D__ENABLE_GENERIC__=1");
 
+		std::string emitOption;
 		switch (m_OutputFormat)
 		{
 		case TB_DATA_FORMAT_LLVM_TEXT:
-			optionsEx += " -emit-llvm";
+			emitOption = " -emit-llvm";
 			break;
 		case TB_DATA_FORMAT_LLVM_BINARY:
-			optionsEx += " -emit-llvm-bc";
+			emitOption = " -emit-llvm-bc";
 			break;
 		default:
 			break;
@@ -763,17 +827,48 @@ namespace TC
 
 		optionsEx += " -D__IMAGE_SUPPORT__ -D__ENDIAN_LITTLE__";
 
+		std::string pchOptionsEx;
+		CPCHCache::PCHBuffer pch = GetCachedPCH(pInputArgs, options, optionsEx, pchOptionsEx);
+		optionsEx += emitOption;
+
 		IOCLFEBinaryResult *pResultPtr = NULL;
-		int res = m_CCModule.pCompile(pInputArgs->pszProgramSource,
-			(const char**)pInputArgs->inputHeaders.data(),
-			(unsigned int)pInputArgs->inputHeaders.size(),
-			(const char**)pInputArgs->inputHeadersNames.data(),
-			NULL,
-			0,
-			options.c_str(),
-			optionsEx.c_str(),
-			pInputArgs->oclVersion.c_str(),
-			&pResultPtr);
+		int res = -1;
+		if (pch)
+		{
+			pchOptionsEx += emitOption;
+			res = m_CCModule.pCompile(pInputArgs->pszProgramSource,
+				(const char**)pInputArgs->inputHeaders.data(),
+				(unsigned int)pInputArgs->inputHeaders.size(),
+				(const char**)pInputArgs->inputHeadersNames.data(),
+				pch->data(),
+				pch->size(),
+				options.c_str(),
+				pchOptionsEx.c_str(),
+				pInputArgs->oclVersion.c_str(),
+				&pResultPtr);
+
+			// redo failed builds with the textual header so that the build log
+			// is the same as without the cache
+			if (res != 0 && pResultPtr)
+			{
+				pResultPtr->Release();
+				pResultPtr = NULL;
+			}
+		}
+
+		if (res != 0)
+		{
+			res = m_CCModule.pCompile(pInputArgs->pszProgramSource,
+				(const char**)pInputArgs->inputHeaders.data(),
+				(unsigned int)pInputArgs->inputHeaders.size(),
+				(const char**)pInputArgs->inputHeadersNames.data(),
+				NULL,
+				0,
+				options.c_str(),
+				optionsEx.c_str(),
+				pInputArgs->oclVersion.c_str(),
+				&pResultPtr);
+		}
 
 		Utils::FillOutputArgs(pResultPtr, pOutputArgs, exceptString);
 		if (!exceptString.empty()) // str != "" => there was an exception. skip further code and return. 
@@ -0,0 +1,218 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// KernelBinaryCache: a rebuild of an unchanged program finds the binaries of
+// all its kernels in the cache, and an edit to a kernel, one of its callees or
+// the build options makes the affected kernels miss while the others still hit.
+// Code generation is replaced by a stand-in binary that records the kernel
+// name, so a hit can be traced back to the kernel that produced it.
+
+#include "UnitTest.hpp"
+
+#include "AdaptorOCL/DriverInfoOCL.hpp"
+#include "AdaptorOCL/ocl_igc_shared/executable_format/patch_g7.h"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CISACodeGen/helper.h"
+#include "Compiler/CISACodeGen/KernelBinaryCache.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace
+{
+    /// A program with kernels k1, which calls helper, and k2. Each test uses
+    /// its own seed so it does not hit the entries of an earlier test.
+    std::string ProgramIR(int seed, int helperValue, int k2Value)
+    {
+        return
+            "target datalayout = \"e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-n8:16:32:64\"\n"
+            "target triple = \"spir64\"\n"
+            "\n"
+            "define spir_func i32 @helper(i32 %x) {\n"
+            "entry:\n"
+            "  %r = add i32 %x, " + std::to_string(helperValue) + "\n"
+            "  ret i32 %r\n"
+            "}\n"
+            "\n"
+            "define spir_kernel void @k1(i32 addrspace(1)* %dst) {\n"
+            "entry:\n"
+            "  %v = call spir_func i32 @helper(i32 " + std::to_string(seed) + ")\n"
+            "  store i32 %v, i32 addrspace(1)* %dst, align 4\n"
+            "  ret void\n"
+            "}\n"
+            "\n"
+            "define spir_kernel void @k2(i32 addrspace(1)* %dst) {\n"
+            "entry:\n"
+            "  store i32 " + std::to_string(seed + k2Value) + ", i32 addrspace(1)* %dst, align 4\n"
+            "  ret void\n"
+            "}\n"
+            "\n"
+            "!igc.functions = !{!0, !3, !4}\n"
+            "!0 = !{i32 (i32)* @helper, !1}\n"
+            "!1 = !{!2}\n"
+            "!2 = !{!\"function_type\", i32 1}\n"
+            "!3 = !{void (i32 addrspace(1)*)* @k1, !5}\n"
+            "!4 = !{void (i32 addrspace(1)*)* @k2, !5}\n"
+            "!5 = !{!6}\n"
+            "!6 = !{!\"function_type\", i32 0}\n";
+    }
+
+    /// Stand-in for a code generated kernel: a kernel binary header followed
+    /// by the kernel name.
+    std::vector<char> KernelBinary(const std::string& kernelName)
+    {
+        iOpenCL::SKernelBinaryHeaderGen7 header;
+        memset(&header, 0, sizeof(header));
+        std::vector<char> binary((const char*)&header, (const char*)&header + sizeof(header));
+        binary.insert(binary.end(), kernelName.begin(), kernelName.end());
+        return binary;
+    }
+
+    /// Kernel name recorded in a binary made by KernelBinary().
+    std::string KernelBinaryName(const std::vector<char>& binary)
+    {
+        if (binary.size() < sizeof(iOpenCL::SKernelBinaryHeaderGen7))
+        {
+            return std::string();
+        }
+        return std::string(binary.begin() + sizeof(iOpenCL::SKernelBinaryHeaderGen7), binary.end());
+    }
+
+    /// Build the program the way TranslateBuild does on its first try, up to
+    /// code generation: look the kernels up in the cache, then "code generate"
+    /// and cache the others. Returns the names of the kernels whose binary
+    /// came from the cache, checking that each is the binary of that kernel.
+    std::vector<std::string> Build(const std::string& ir, const char* options = "")
+    {
+        PLATFORM platformInfo;
+        memset(&platformInfo, 0, sizeof(platformInfo));
+        CPlatform platform(platformInfo);
+        WA_TABLE waTable;
+        memset(&waTable, 0, sizeof(waTable));
+        platform.SetWATable(waTable);
+        SKU_FEATURE_TABLE skuTable;
+        memset(&skuTable, 0, sizeof(skuTable));
+        platform.SetSkuTable(skuTable);
+        GT_SYSTEM_INFO gtSystemInfo;
+        memset(&gtSystemInfo, 0, sizeof(gtSystemInfo));
+        platform.SetGTSystemInfo(gtSystemInfo);
+
+        TC::STB_TranslateInputArgs inputArgs;
+        inputArgs.pOptions = options;
+        inputArgs.OptionsSize = (uint32_t)strlen(options);
+
+        TC::CDriverInfoOCLNEO driverInfo;
+        USC::SShaderStageBTLayout zeroLayout = USC::g_cZeroShaderStageBTLayout;
+        COCLBTILayout oclLayout(&zeroLayout);
+        OpenCLProgramContext oclContext(oclLayout, platform, &inputArgs, driverInfo);
+        oclContext.m_ProfilingTimerResolution = 0.0f;
+
+        SMDiagnostic err;
+        std::unique_ptr<Module> M = parseAssemblyString(ir, err, *oclContext.getLLVMContext());
+        UT_CHECK(M != nullptr);
+        if (!M)
+        {
+            return std::vector<std::string>();
+        }
+        oclContext.setModule(M.release());
+
+        LookupCachedKernels(&oclContext, &inputArgs);
+
+        std::vector<std::string> hits;
+        MetaDataUtils* pMdUtils = oclContext.getMetaDataUtils();
+        for (auto i = pMdUtils->begin_FunctionsInfo(), e = pMdUtils->end_FunctionsInfo(); i != e; ++i)
+        {
+            Function* pFunc = i->first;
+            if (!isOCLKernelFunc(pMdUtils, pFunc))
+            {
+                continue;
+            }
+            const std::string name = pFunc->getName().str();
+            auto cached = oclContext.m_cachedKernelBinaries.find(name);
+            if (cached != oclContext.m_cachedKernelBinaries.end())
+            {
+                UT_CHECK(KernelBinaryName(cached->second) == name);
+                hits.push_back(name);
+                continue;
+            }
+            std::vector<char> binary = KernelBinary(name);
+            oclContext.m_programOutput.AddKernelBinary(binary.data(), binary.size());
+            CacheKernelBinary(&oclContext, name);
+        }
+        return hits;
+    }
+
+    const std::vector<std::string> NoKernels;
+    const std::vector<std::string> AllKernels = { "k1", "k2" };
+
+    void TestHitForUnchangedProgram()
+    {
+        const std::string program = ProgramIR(100, 1, 1);
+        UT_CHECK(Build(program) == NoKernels);
+        UT_CHECK(Build(program) == AllKernels);
+    }
+
+    void TestMissForChangedKernel()
+    {
+        UT_CHECK(Build(ProgramIR(200, 1, 1)) == NoKernels);
+        UT_CHECK(Build(ProgramIR(200, 1, 2)) == std::vector<std::string>{ "k1" });
+    }
+
+    void TestMissForChangedCallee()
+    {
+        UT_CHECK(Build(ProgramIR(300, 1, 1)) == NoKernels);
+        UT_CHECK(Build(ProgramIR(300, 2, 1)) == std::vector<std::string>{ "k2" });
+    }
+
+    void TestMissForChangedOptions()
+    {
+        const std::string program = ProgramIR(400, 1, 1);
+        UT_CHECK(Build(program) == NoKernels);
+        UT_CHECK(Build(program, "-cl-mad-enable") == NoKernels);
+        UT_CHECK(Build(program, "-cl-mad-enable") == AllKernels);
+    }
+}
+
+int main()
+{
+    UnitTest::Run("HitForUnchangedProgram", TestHitForUnchangedProgram);
+    UnitTest::Run("MissForChangedKernel", TestMissForChangedKernel);
+    UnitTest::Run("MissForChangedCallee", TestMissForChangedCallee);
+    UnitTest::Run("MissForChangedOptions", TestMissForChangedOptions);
+    return UnitTest::Result();
+}
@@ -0,0 +1,143 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+
+// LLVMContextPool: a build in a recycled LLVM context must see the type names
+// of its own module unchanged, even though the earlier builds in the context
+// created types with the same names. Passes match OCL builtin types such as
+// opencl.image2d_t by their exact name.
+
+#include "UnitTest.hpp"
+
+#include "AdaptorOCL/DriverInfoOCL.hpp"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CISACodeGen/LLVMContextPool.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/SourceMgr.h>
+#include "common/LLVMWarningsPop.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace IGC;
+
+namespace
+{
+    const char* KernelModule = R"(
+target datalayout = "e-i64:64-v16:16-v24:32-v32:32-v48:64-v96:128-v192:256-v256:256-v512:512-v1024:1024-n8:16:32:64"
+target triple = "spir64"
+
+%opencl.image2d_t = type opaque
+%opencl.sampler_t = type opaque
+%struct.Params = type { i32, float }
+
+define spir_kernel void @test(%opencl.image2d_t addrspace(1)* %img, %opencl.sampler_t addrspace(2)* %smp, %struct.Params addrspace(1)* %params) {
+  ret void
+}
+)";
+
+    std::vector<std::string> StructTypeNames(const Module& M)
+    {
+        std::vector<std::string> names;
+        for (StructType* type : M.getIdentifiedStructTypes())
+        {
+            names.push_back(type->getName().str());
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    const std::vector<std::string> ExpectedNames = { "opencl.image2d_t", "opencl.sampler_t", "struct.Params" };
+
+    /// Parse the kernel module into a context from the pool and hand it to an
+    /// OCL program context the way TranslateBuild does. The context returns
+    /// to the pool when the program context is destroyed.
+    LLVMContextWrapper* Build(std::vector<std::string>& typeNames)
+    {
+        LLVMContextWrapper* llvmContext = LLVMContextPool::acquire(true);
+        SMDiagnostic err;
+        std::unique_ptr<Module> M = parseAssemblyString(KernelModule, err, *llvmContext);
+        UT_CHECK(M != nullptr);
+        if (!M)
+        {
+            delete llvmContext;
+            return nullptr;
+        }
+        llvmContext->retireStructTypes(*M);
+
+        PLATFORM platformInfo;
+        memset(&platformInfo, 0, sizeof(platformInfo));
+        CPlatform platform(platformInfo);
+        TC::CDriverInfoOCLNEO driverInfo;
+        USC::SShaderStageBTLayout zeroLayout = USC::g_cZeroShaderStageBTLayout;
+        COCLBTILayout oclLayout(&zeroLayout);
+        OpenCLProgramContext oclContext(oclLayout, platform, nullptr, driverInfo, llvmContext);
+        oclContext.setModule(M.release());
+
+        typeNames = StructTypeNames(*oclContext.getModule());
+        return llvmContext;
+    }
+
+    void TestRecycledContextKeepsTypeNames()
+    {
+        std::vector<std::string> firstNames;
+        LLVMContextWrapper* first = Build(firstNames);
+        UT_CHECK(firstNames == ExpectedNames);
+
+        std::vector<std::string> secondNames;
+        LLVMContextWrapper* second = Build(secondNames);
+        UT_CHECK(second == first);
+        UT_CHECK(secondNames == ExpectedNames);
+    }
+
+    // Sanity check of the test itself: without recycling, the second module
+    // in a context gets suffixed type names.
+    void TestSharedContextSuffixesTypeNames()
+    {
+        LLVMContext context;
+        SMDiagnostic err;
+        std::unique_ptr<Module> first = parseAssemblyString(KernelModule, err, context);
+        std::unique_ptr<Module> second = parseAssemblyString(KernelModule, err, context);
+        UT_CHECK(first && second);
+        if (first && second)
+        {
+            UT_CHECK(StructTypeNames(*first) == ExpectedNames);
+            UT_CHECK(StructTypeNames(*second) != ExpectedNames);
+        }
+    }
+}
+
+int main()
+{
+    UnitTest::Run("RecycledContextKeepsTypeNames", TestRecycledContextKeepsTypeNames);
+    UnitTest::Run("SharedContextSuffixesTypeNames", TestSharedContextSuffixesTypeNames);
+    return UnitTest::Result();
+}
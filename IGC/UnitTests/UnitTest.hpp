@@ -0,0 +1,69 @@
+/*===================== begin_copyright_notice ==================================
+
+Copyright (c) 2017 Intel Corporation
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+======================= end_copyright_notice ==================================*/
+#pragma once
+
+#include <cstdio>
+
+// Support for the self-checking unit test programs. A failed UT_CHECK prints
+// its location and marks the program as failed; the test keeps running so
+// one run reports every failed check.
+
+namespace IGC
+{
+    namespace UnitTest
+    {
+        inline int& FailureCount()
+        {
+            static int count = 0;
+            return count;
+        }
+
+        /// Run one test function and report whether its checks passed.
+        template <typename Fn>
+        void Run(const char* name, Fn&& test)
+        {
+            int failuresBefore = FailureCount();
+            test();
+            printf("%s %s\n", FailureCount() == failuresBefore ? "PASS" : "FAIL", name);
+        }
+
+        /// Exit code of the test program.
+        inline int Result()
+        {
+            return FailureCount() == 0 ? 0 : 1;
+        }
+    }
+}
+
+#define UT_CHECK(cond)                                                              \
+    do                                                                              \
+    {                                                                               \
+        if (!(cond))                                                                \
+        {                                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            IGC::UnitTest::FailureCount()++;                                        \
+        }                                                                           \
+    } while (0)
@@ -25,6 +25,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ======================= end_copyright_notice ==================================*/
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/CISACodeGen/PassTimer.hpp"
+#include "Compiler/CISACodeGen/PassProfiler.hpp"
 #include "common/Stats.hpp"
 #include "common/debug/Dump.hpp"
 #include "common/shaderOverride.hpp"
@@ -41,7 +42,14 @@ using namespace llvm;
 
 void IGCPassManager::add(Pass *P)
 {
-    PassManager::add(P);
+    if(IGC_IS_FLAG_ENABLED(EnablePassProfile) && !P->getAsImmutablePass())
+    {
+        addProfiled(P);
+    }
+    else
+    {
+        PassManager::add(P);
+    }
     if(IGC_IS_FLAG_ENABLED(ShaderDumpEnableAll))
     {
         std::string passName = m_name + '_' + std::string(P->getPassName());
@@ -61,6 +69,94 @@ void IGCPassManager::add(Pass *P)
     }
 }
 
+void IGCPassManager::addProfiled(Pass *P)
+{
+    if(!m_pContext->m_passProfile)
+    {
+        m_pContext->m_passProfile = new PassProfile();
+    }
+
+    PassKind kind = P->getPassKind();
+    PassKind markerKind = (kind == PT_Module || kind == PT_PassManager || kind == PT_CallGraphSCC) ?
+        PT_Module : PT_Function;
+    bool grouped = kind == PT_Loop || kind == PT_Region || kind == PT_BasicBlock || kind == PT_CallGraphSCC;
+
+    // Only a CGSCC pass opens a module-level group. The legacy pass manager runs the
+    // function passes that follow it inside the same call graph walk, which a module
+    // marker between them would end, so those passes are profiled with the group.
+    bool inCGSCCGroup = m_profileGroup && m_profileGroupKind == PT_Module && markerKind == PT_Function;
+    if(inCGSCCGroup || (grouped && m_profileGroup && m_profileGroupKind == markerKind))
+    {
+        m_profileGroup->pass += " + " + std::string(P->getPassName());
+        PassManager::add(P);
+        return;
+    }
+    closeProfileGroup();
+
+    auto scope = std::make_shared<PassProfileScope>();
+    scope->profile = m_pContext->m_passProfile;
+    scope->pipeline = m_name;
+    scope->pass = P->getPassName();
+    scope->simd = m_simd;
+    scope->record = 0;
+
+    if(markerKind == PT_Module)
+    {
+        PassManager::add(new ModulePassProfiler(scope, true));
+    }
+    else
+    {
+        PassManager::add(new FunctionPassProfiler(scope, true));
+    }
+    PassManager::add(P);
+
+    if(grouped)
+    {
+        m_profileGroup = scope;
+        m_profileGroupKind = markerKind;
+    }
+    else if(markerKind == PT_Module)
+    {
+        PassManager::add(new ModulePassProfiler(scope, false));
+    }
+    else
+    {
+        PassManager::add(new FunctionPassProfiler(scope, false));
+    }
+}
+
+void IGCPassManager::closeProfileGroup()
+{
+    if(!m_profileGroup)
+    {
+        return;
+    }
+    if(m_profileGroupKind == PT_Module)
+    {
+        PassManager::add(new ModulePassProfiler(m_profileGroup, false));
+    }
+    else
+    {
+        PassManager::add(new FunctionPassProfiler(m_profileGroup, false));
+    }
+    m_profileGroup.reset();
+}
+
+bool IGCPassManager::run(Module &M)
+{
+    closeProfileGroup();
+    PassProfile* profile = m_pContext->m_passProfile;
+    if(!profile)
+    {
+        return PassManager::run(M);
+    }
+
+    size_t record = profile->begin(m_name, "", nullptr, 0, PassProfile::countInstructions(M));
+    bool changed = PassManager::run(M);
+    profile->end(record, PassProfile::countInstructions(M));
+    return changed;
+}
+
 IGCPassManager::~IGCPassManager()
 {
     if(IGC_IS_FLAG_ENABLED(ShaderDumpEnableAll))
@@ -28,6 +28,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/IR/LegacyPassManager.h>
 #include "common/LLVMWarningsPop.hpp"
+#include <memory>
 #include <vector>
 #include "Stats.hpp"
 #include <string.h>
@@ -39,6 +40,7 @@ namespace IGC
         class Dump;
     }
     class CodeGenContext;
+    struct PassProfileScope;
 
     class IGCPassManager : public llvm::legacy::PassManager
     {
@@ -53,10 +55,22 @@ namespace IGC
             m_pContext = ctx; 
         }
         void add(llvm::Pass *P);
+        bool run(llvm::Module &M);
+        /// SIMD width recorded for the passes in the pass profile
+        void setSIMDWidth(unsigned simd) { m_simd = simd; }
     private:
+        void addProfiled(llvm::Pass *P);
+        void closeProfileGroup();
+
         CodeGenContext* m_pContext;
         std::string m_name;
         std::vector<Debug::Dump *> m_irDumps;
+        unsigned m_simd = 0;
+        // Loop, region and basic block passes (resp. CGSCC passes and the function
+        // passes after them) added in a row are profiled as one, so the markers
+        // don't split their pass manager
+        std::shared_ptr<PassProfileScope> m_profileGroup;
+        llvm::PassKind m_profileGroupKind = llvm::PT_Function;
     };
 }
 
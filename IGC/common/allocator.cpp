@@ -24,7 +24,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ======================= end_copyright_notice ==================================*/
 #define ThreadCnt
-#define He4k
+#if defined( _WIN32 )
+    #define He4k
+#else
+    #define Mmap4k
+#endif
 
 //#define DisableForceInline
 //#define OptimizationsOff
@@ -39,10 +43,17 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #endif
 
 // Includes for CMA
-#if defined( _WIN32 )
+// CMA always backs operator new/delete on Windows. Elsewhere it is opt-in at
+// build time with IGC_CUSTOM_MEM_ALLOCATOR (IGC_OPTION__CUSTOM_MEM_ALLOCATOR),
+// see the sized operator delete below for how libigc binds to it.
+#if defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR )
 #include "3d/common/iStdLib/types.h"
 #include <new>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <atomic>
 //#include <math.h>
 
 #if defined( _WIN32 )
@@ -54,6 +65,18 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
     #include <WinBase.h>
 #endif
 
+#if defined Mmap4k
+    #include <sys/mman.h>
+#endif
+
+#if defined( _WIN32 )
+    #define CMA_THREAD_LOCAL    __declspec( thread )
+    #define CMA_CALL            __stdcall
+#else
+    #define CMA_THREAD_LOCAL    thread_local
+    #define CMA_CALL
+#endif
+
 namespace CMA
 {
 
@@ -115,36 +138,36 @@ namespace CMA
     {
         // Static class members declarations.
     public:
-        __declspec( thread ) static spinlock_t *     mpSpinlock;
+        CMA_THREAD_LOCAL static spinlock_t *     mpSpinlock;
     private:
-        __declspec( thread ) static int_fast32_t     mInitialized;
-        __declspec( thread ) static int_fast32_t     mEnabled;
-        __declspec( thread ) static int_fast32_t     mThClosed;
-        __declspec( thread ) static GenericPool **   mpPools;
+        CMA_THREAD_LOCAL static int_fast32_t     mInitialized;
+        CMA_THREAD_LOCAL static int_fast32_t     mEnabled;
+        CMA_THREAD_LOCAL static int_fast32_t     mThClosed;
+        CMA_THREAD_LOCAL static GenericPool **   mpPools;
     public:
-        __declspec( thread ) static SStructThreadLocalPtrs * mpStructThreadLocalPtrs;
-        __declspec( thread ) static uint16_t          mCMAThrdInd;
+        CMA_THREAD_LOCAL static SStructThreadLocalPtrs * mpStructThreadLocalPtrs;
+        CMA_THREAD_LOCAL static uint16_t          mCMAThrdInd;
         
         // Methods.
     public:
-        static int       __stdcall   Create( void );
-        static void *    __stdcall   CustomAllocate( const size_t argSize );
-        static void      __stdcall   CustomDeallocate( void * ptr );
-        static void      __stdcall   DLLThreadAttach( void );
-        static void      __stdcall   DLLProcessAttach( void );
-        static void      __stdcall   DLLThreadDetach( void );
-        static void      __stdcall   DLLProcessDetach( void );
+        static int       CMA_CALL   Create( void );
+        static void *    CMA_CALL   CustomAllocate( const size_t argSize );
+        static void      CMA_CALL   CustomDeallocate( void * ptr );
+        static void      CMA_CALL   DLLThreadAttach( void );
+        static void      CMA_CALL   DLLProcessAttach( void );
+        static void      CMA_CALL   DLLThreadDetach( void );
+        static void      CMA_CALL   DLLProcessDetach( void );
 
 #ifdef EnableCMATraces
-        static void      __stdcall   CMAPrintStats( void );
+        static void      CMA_CALL   CMAPrintStats( void );
 #endif
 
-        static void      __stdcall   ReleaseEmptyBlocks( void );
+        static void      CMA_CALL   ReleaseEmptyBlocks( void );
         
     private:
                                 CustomMA();
 
-        static void __stdcall   CustomDeallocateCritSect(
+        static void CMA_CALL   CustomDeallocateCritSect(
             GenericPool ** pChunkPools,
             const unsigned chunkSize,
             const unsigned chunkInd,
@@ -271,6 +294,7 @@ using namespace std;
     template < size_t  N > inline unsigned int getReservedChunks( const unsigned int size )
     {
         CMA_assert( 0 );
+        return 0;
     }
 
 
@@ -395,7 +419,7 @@ using namespace std;
         DWORD bit = 0;
         if( mask != 0 )
         {
-            while( ( ( mask & 1 << bit) ) == 0 ) && bit < 32 )
+            while( ( ( mask & ( 1u << bit ) ) == 0 ) && bit < 32 )
             {
                 ++bit;
             }
@@ -705,19 +729,14 @@ using namespace std;
         inline
     #endif
         void lock() {
-            while(
-    #if defined _WIN32
-                    0 != _interlockedbittestandset( &m_lock, 0 ) )
-    #else
-                    __sync_lock_test_and_set( &m_lock, 1 ) )
-    #endif
+            while( 0 != m_lock.exchange( 1, std::memory_order_acquire ) )
             {
                 for(;;) 
                 {
-                    if(m_lock==0) break;
-                    if(m_lock==0) break;
-                    if(m_lock==0) break;
-                    if(m_lock==0) break;
+                    if(m_lock.load( std::memory_order_relaxed )==0) break;
+                    if(m_lock.load( std::memory_order_relaxed )==0) break;
+                    if(m_lock.load( std::memory_order_relaxed )==0) break;
+                    if(m_lock.load( std::memory_order_relaxed )==0) break;
                 }
             }
         }
@@ -729,11 +748,11 @@ using namespace std;
     #endif
         void unlock()
         {
-            m_lock=0;
+            m_lock.store( 0, std::memory_order_release );
         }
 
     private:
-        volatile long m_lock;
+        std::atomic<long> m_lock;
 
     };
 
@@ -793,13 +812,94 @@ using namespace std;
 #endif
 
     // Static class members definitions.
-    __declspec( thread ) spinlock_t *                CustomMA::mpSpinlock;
-    __declspec( thread ) int_fast32_t                CustomMA::mInitialized;
-    __declspec( thread ) int_fast32_t                CustomMA::mEnabled;
-    __declspec( thread ) int_fast32_t                CustomMA::mThClosed;
-    __declspec( thread ) GenericPool **              CustomMA::mpPools;
-    __declspec( thread ) SStructThreadLocalPtrs *    CustomMA::mpStructThreadLocalPtrs;
-    __declspec( thread ) uint16_t                    CustomMA::mCMAThrdInd;
+    CMA_THREAD_LOCAL spinlock_t *                CustomMA::mpSpinlock;
+    CMA_THREAD_LOCAL int_fast32_t                CustomMA::mInitialized;
+#if defined( _WIN32 )
+    // Enabled per thread from DllMain (DLLProcessAttach / DLLThreadAttach).
+    CMA_THREAD_LOCAL int_fast32_t                CustomMA::mEnabled;
+#else
+    // There is no DllMain to enable threads as they attach, so every thread
+    // starts enabled and ThreadDetachGuard disables it on thread exit.
+    CMA_THREAD_LOCAL int_fast32_t                CustomMA::mEnabled = 1;
+#endif
+    CMA_THREAD_LOCAL int_fast32_t                CustomMA::mThClosed;
+    CMA_THREAD_LOCAL GenericPool **              CustomMA::mpPools;
+    CMA_THREAD_LOCAL SStructThreadLocalPtrs *    CustomMA::mpStructThreadLocalPtrs;
+    CMA_THREAD_LOCAL uint16_t                    CustomMA::mCMAThrdInd;
+
+#if defined Mmap4k
+    // 4kB block buffers are carved from a single address space reservation
+    // big enough for every CMA thread to hold its maximum number of blocks.
+    // This replaces the private Windows heap (He4k) and lets CustomDeallocate
+    // recognize CMA chunks by address, so anything outside the arena is
+    // plain malloc memory.
+    const size_t            cArenaSize = ( size_t ) cMaxThds * blockListLenTresh * cBlockBufSize;
+
+    std::atomic<char *>     glArenaBase( NULL );
+    std::atomic<size_t>     glArenaUsed( 0 );
+    char *                  glArenaFreeList = NULL;     // released blocks, linked through their first word
+    spinlock_t              glArenaSpinlock;
+
+    // Called under GlobalSpinlock.
+    void CMAReserveArena()
+    {
+        if( glArenaBase.load( std::memory_order_relaxed ) == NULL )
+        {
+            void * base = mmap( NULL, cArenaSize, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+
+            if( base != MAP_FAILED )
+            {
+                glArenaBase.store( ( char * ) base, std::memory_order_release );
+            }
+        }
+    }
+
+    inline bool CMAArenaContains( const void * ptr )
+    {
+        const char * base = glArenaBase.load( std::memory_order_acquire );
+        return base && ( const char * ) ptr >= base && ( const char * ) ptr < base + cArenaSize;
+    }
+
+    void * CMAArenaAllocBlock()
+    {
+        char * base = glArenaBase.load( std::memory_order_acquire );
+        if( base == NULL )
+        {
+            return NULL;
+        }
+
+        {
+            lock_t lock( glArenaSpinlock );
+
+            if( glArenaFreeList )
+            {
+                char * pBlock = glArenaFreeList;
+                glArenaFreeList = *( char ** ) pBlock;
+                return pBlock;
+            }
+        }
+
+        // Untouched pages are committed by the kernel on first use.
+        size_t offset = glArenaUsed.fetch_add( cBlockBufSize, std::memory_order_relaxed );
+        if( offset + cBlockBufSize > cArenaSize )
+        {
+            return NULL;
+        }
+
+        return base + offset;
+    }
+
+    void CMAArenaFreeBlock( void * ptr )
+    {
+        CMA_assert( CMAArenaContains( ptr ) );
+
+        lock_t lock( glArenaSpinlock );
+
+        *( char ** ) ptr = glArenaFreeList;
+        glArenaFreeList = ( char * ) ptr;
+    }
+#endif
     
 
 #ifndef EnableAsserts
@@ -820,6 +920,8 @@ void * CMAInternalMalloc( size_t alSize )
         void * lptr = 
 #if defined He4k
             ( char * ) HeapAlloc( heap1, 0, alSize );
+#elif defined Mmap4k
+            CMAArenaAllocBlock();
 #else
             malloc( alSize );
 #endif
@@ -849,6 +951,8 @@ void CMAInternalFree( void * ptr, size_t alSize )
 		CMA_assert( heap1 != NULL );
 
         HeapFree( heap1, 0, ptr );
+#elif defined Mmap4k
+        CMAArenaFreeBlock( ptr );
 #else
         free( ptr );
 #endif
@@ -982,6 +1086,17 @@ void CMAInternalFree( void * ptr, size_t alSize )
         ReleaseEmptyBlocks();
     }
 
+#if !defined( _WIN32 )
+    // Runs DLLThreadDetach when a thread that has created its CMA state exits.
+    struct ThreadDetachGuard
+    {
+        ~ThreadDetachGuard()
+        {
+            CustomMA::DLLThreadDetach();
+        }
+    };
+#endif
+
 #ifdef EnableCMATraces
     void CustomMA::CMAPrintStats()
     {
@@ -1170,7 +1285,21 @@ void CMAInternalFree( void * ptr, size_t alSize )
                         // release mpStructTLP
                         mpStructThreadLocalPtrs->~SStructThreadLocalPtrs();
                         CMAInternalFree( mpStructThreadLocalPtrs, sizeof ( SStructThreadLocalPtrs ) );
+#if defined( _WIN32 )
                         ttlp[ mCMAThrdInd ] = &StructTLPPlaceholder;
+#else
+                        // No chunk refers to this thread index any more. Hand
+                        // the slot back so short-lived threads do not use up
+                        // all cMaxThds slots.
+                        {
+                            lock_t lock( GlobalSpinlock );
+                            ttlp[ mCMAThrdInd ] = NULL;
+                            if( glThCnt > 0 )
+                            {
+                                --glThCnt;
+                            }
+                        }
+#endif
                         mpStructThreadLocalPtrs = &StructTLPPlaceholder;
 
                         CMA_assert( mpPools );
@@ -1262,6 +1391,10 @@ void CMAInternalFree( void * ptr, size_t alSize )
 						}
 #endif
 
+#ifdef Mmap4k
+                        CMAReserveArena();
+#endif
+
 #if defined ThreadCnt
                         ttlp[ mCMAThrdInd ] = mpStructThreadLocalPtrs;
 
@@ -1279,6 +1412,11 @@ void CMAInternalFree( void * ptr, size_t alSize )
 
         if( ptr && mpSpinlock && mpPools && mpStructThreadLocalPtrs )
         {
+#if !defined( _WIN32 )
+            // The first use registers the destructor for this thread.
+            static thread_local ThreadDetachGuard threadDetachGuard;
+            ( void ) &threadDetachGuard;
+#endif
 
 #ifdef EnableCMATraces
     #if defined ( _DEBUG ) || defined ( _INTERNAL )
@@ -1854,6 +1992,11 @@ void CMAInternalFree( void * ptr, size_t alSize )
         // OS_malloc
         if( doOSAlloc )
         {
+#if defined Mmap4k
+            // CustomDeallocate tells arena chunks apart by address, so
+            // memory from malloc needs no chunk header.
+            return malloc( origSize );
+#endif
             const size_t allocSize = origSize + overlaySize;
 
             char * ptr = ( char * ) malloc( allocSize );
@@ -2058,6 +2201,14 @@ void CMAInternalFree( void * ptr, size_t alSize )
     {
         unsigned char * ptr = ( unsigned char * ) arg_ptr;
 
+#if defined Mmap4k
+        if( ptr && !CMAArenaContains( ptr ) )
+        {
+            free( ptr );
+            return;
+        }
+#endif
+
         if( ptr )
         {
 #if defined( _MS_CRT_STDMUTEX_WA_ )
@@ -2255,7 +2406,7 @@ void CMADLLProcessDetach()
 #endif
 
 
-#if defined( _WIN32 ) || ( defined ( _DEBUG ) || defined ( _INTERNAL ) )
+#if defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) || ( defined ( _DEBUG ) || defined ( _INTERNAL ) )
 /*****************************************************************************\
 
 Class:
@@ -2489,7 +2640,7 @@ inline void* CAllocator::Malloc(size_t size)
     // CAllocator seems always be enabled for all platforms.
     // CMA check-in doesn't change that.
 
-#if ( defined( _WIN32 ) && !( defined IGC_STANDALONE ) )
+#if ( ( defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) ) && !( defined IGC_STANDALONE ) )
     ptr = CMA::CustomMA::CustomAllocate( size );
 #else
     ptr = malloc( size );
@@ -2530,7 +2681,7 @@ inline void CAllocator::Free(void* ptr)
 {
     if(ptr)
     {
-#if ( defined( _WIN32 ) && !( defined IGC_STANDALONE ) )
+#if ( ( defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) ) && !( defined IGC_STANDALONE ) )
     CMA::CustomMA::CustomDeallocate( ptr );
 #else
     free( ptr );
@@ -2538,12 +2689,12 @@ inline void CAllocator::Free(void* ptr)
     }
 }
 
-#endif //defined( _WIN32 ) || ( defined ( _DEBUG ) || defined ( _INTERNAL ) )
+#endif //defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) || ( defined ( _DEBUG ) || defined ( _INTERNAL ) )
 
 /*****************************************************************************\
 locally visible new & delete for Linux
 \*****************************************************************************/
-#if defined ( _DEBUG ) || defined ( _INTERNAL )
+#if ( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && !defined( IGC_CUSTOM_MEM_ALLOCATOR )
 #if defined __GNUC__ 
 
 #if !defined __clang__
@@ -2603,13 +2754,17 @@ inline void operator delete[](void* ptr)
 }
 #endif // !defined __clang__
 #endif//defined __GNUC__
-#endif //defined ( _DEBUG ) || defined ( _INTERNAL )
+#endif //( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && !defined( IGC_CUSTOM_MEM_ALLOCATOR )
 
 #ifndef __GNUC__
 #define __NOTAGNUC__ 
 #endif // __GNUC__
 
-#if defined( _WIN32 ) || ( ( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && (defined __NOTAGNUC__ ) )
+#if !defined( _WIN32 )
+#define __cdecl
+#endif
+
+#if defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) || ( ( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && (defined __NOTAGNUC__ ) )
 /*****************************************************************************\
  operator new
 \*****************************************************************************/
@@ -2645,9 +2800,38 @@ void __cdecl operator delete[]( void* ptr )
 {
     CAllocator::Deallocate( ptr );
 }
-#endif // defined( _WIN32 ) || ( ( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && (defined __NOTAGNUC__) )
+#endif // defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR ) || ( ( defined ( _DEBUG ) || defined ( _INTERNAL ) ) && (defined __NOTAGNUC__) )
 
-#if defined( _WIN32 )
+#if defined( IGC_CUSTOM_MEM_ALLOCATOR )
+/*****************************************************************************\
+ sized operator delete
+
+ On Linux, libigc binds the operators in this file locally through the
+ version script common/allocator.map, which is what a DLL does on Windows.
+ Without it libigc, which is dlopen'ed without -Bsymbolic, would call the
+ operators of libstdc++ and CMA would never run. The sized forms must be
+ defined as well, or libstdc++'s sized delete would hand CMA chunks to free().
+
+ Local binding keeps the Windows rule: memory allocated by libigc is freed by
+ libigc. Memory of other modules is freed correctly here, because chunks
+ outside the CMA arena go back to free(). The reverse does not hold: a CMA
+ chunk deleted by code outside libigc reaches free() and corrupts the heap.
+ That is why CMA requires LLVM to be linked statically into libigc (see
+ IGC_OPTION__CUSTOM_MEM_ALLOCATOR), and why libigc must not pass objects
+ whose deletion is left to other modules.
+\*****************************************************************************/
+void __cdecl operator delete( void* ptr, size_t ) throw()
+{
+    CAllocator::Deallocate( ptr );
+}
+
+void __cdecl operator delete[]( void* ptr, size_t ) throw()
+{
+    CAllocator::Deallocate( ptr );
+}
+#endif // defined( IGC_CUSTOM_MEM_ALLOCATOR )
+
+#if defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR )
 void* __cdecl operator new( size_t size, const std::nothrow_t& ) throw()
 {
     return CAllocator::Allocate( size );
@@ -2667,4 +2851,4 @@ void __cdecl operator delete[]( void* ptr, const std::nothrow_t& ) throw()
 {
     CAllocator::Deallocate( ptr );
 }
-#endif // defined( _WIN32 )
+#endif // defined( _WIN32 ) || defined( IGC_CUSTOM_MEM_ALLOCATOR )
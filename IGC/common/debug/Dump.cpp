@@ -34,6 +34,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "common/igc_regkeys.hpp"
 
 #include <iStdLib/utility.h>
+#include <iStdLib/Hash128.h>
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/IR/Value.h>
@@ -574,7 +575,12 @@ void PrintDebugMsg(
 AsmHash AsmHashOCL(const UINT* pShaderCode, size_t size)
 {
     AsmHash hash;
-    hash.value = iSTD::Hash(reinterpret_cast<const DWORD*>(pShaderCode), int_cast<DWORD>(size));
+    // The legacy mode yields the same value as iSTD::Hash so that existing
+    // dump and override names stay valid.
+    iSTD::Hash128 hasher(IGC_IS_FLAG_ENABLED(ShaderHashLanes) ?
+        iSTD::Hash128::HASH128_LANES : iSTD::Hash128::HASH128_LEGACY);
+    hasher.Update(pShaderCode, size * sizeof(UINT));
+    hash.value = hasher.Final().lo;
     return hash;
 }
 
@@ -369,8 +369,7 @@ static void LoadDebugFlagsFromFile()
     }
 }
 
-thread_local unsigned long long g_CurrentShaderHash = 0;
-bool CheckHashRange(const std::vector<HashRange>& hashes)
+static bool IsHashInRange(const std::vector<HashRange>& hashes, unsigned long long hash)
 {
 	if(hashes.empty())
 	{
@@ -378,7 +377,7 @@ bool CheckHashRange(const std::vector<HashRange>& hashes)
 	}
 	for(auto it : hashes)
 	{
-		if(g_CurrentShaderHash >= it.start && g_CurrentShaderHash <= it.end)
+		if(hash >= it.start && hash <= it.end)
 		{
 			return true;
 		}
@@ -386,6 +385,21 @@ bool CheckHashRange(const std::vector<HashRange>& hashes)
 	return false;
 }
 
+thread_local unsigned long long g_CurrentShaderHash = 0;
+bool CheckHashRange(const std::vector<HashRange>& hashes)
+{
+	return IsHashInRange(hashes, g_CurrentShaderHash);
+}
+
+SRegKeyValues::SRegKeyValues(unsigned long long hash)
+{
+#define DECLARE_IGC_REGKEY(dataType, regkeyName, defaultValue, description)     \
+    regkeyName = IsHashInRange(g_RegKeyList.regkeyName.hashes, hash) ?          \
+        g_RegKeyList.regkeyName.m_Value : g_RegKeyList.regkeyName.GetDefault();
+#include "igc_regkeys.def"
+#undef DECLARE_IGC_REGKEY
+}
+
 static void LoadFromRegKeyOrEnvVar()
 {
 	SRegKeyVariableMetaData* pRegKeyVariable = (SRegKeyVariableMetaData*)&g_RegKeyList;
@@ -102,6 +102,22 @@ extern SRegKeysList g_RegKeyList;
 #define IGC_GET_REGKEYSTRING( name )               \
 ( CheckHashRange(g_RegKeyList.name.hashes) ? g_RegKeyList.name.m_string : "" )
 
+/*****************************************************************************\
+STRUCT: SRegKeyValues
+PURPOSE: Regkey values resolved once against the hash ranges for one shader.
+         Reading a flag from it is a plain load, and it does not depend on
+         the thread-local hash set by SetCurrentDebugHash.
+\*****************************************************************************/
+#define DECLARE_IGC_REGKEY(dataType, regkeyName, defaultValue, description) \
+    unsigned regkeyName;
+struct SRegKeyValues
+{
+    explicit SRegKeyValues(unsigned long long hash);
+#include "igc_regkeys.def"
+};
+#undef DECLARE_IGC_REGKEY
+#define IGC_GET_FLAG_VALUE_IN( regKeys, name )     ( (regKeys).name )
+
 void DumpIGCRegistryKeyDefinitions();
 void LoadRegistryKeys();
 void SetCurrentDebugHash(unsigned long long hash);
@@ -122,4 +138,19 @@ public:
 #define IGC_IS_FLAG_DISABLED( name )    (DebugVariable::name##default == 0)
 #define IGC_GET_FLAG_VALUE( name )      (DebugVariable::name##default)
 #define IGC_GET_REGKEYSTRING( name )    ("")
+
+struct SRegKeyValues
+{
+    explicit SRegKeyValues(unsigned long long) {}
+};
+#define IGC_GET_FLAG_VALUE_IN( regKeys, name )     (DebugVariable::name##default)
 #endif
+
+// Flag accessors reading the snapshot of a CodeGenContext (see
+// CodeGenContext::getRegKeys); use these on paths that run once per pass or
+// per instruction.
+#define IGC_IS_FLAG_ENABLED_IN( regKeys, name )    ( IGC_GET_FLAG_VALUE_IN(regKeys, name) != 0 )
+#define IGC_IS_FLAG_DISABLED_IN( regKeys, name )   ( !IGC_IS_FLAG_ENABLED_IN(regKeys, name) )
+#define IGC_GET_FLAG_VALUE_CTX( ctx, name )        IGC_GET_FLAG_VALUE_IN((ctx)->getRegKeys(), name)
+#define IGC_IS_FLAG_ENABLED_CTX( ctx, name )       ( IGC_GET_FLAG_VALUE_CTX(ctx, name) != 0 )
+#define IGC_IS_FLAG_DISABLED_CTX( ctx, name )      ( !IGC_IS_FLAG_ENABLED_CTX(ctx, name) )
@@ -29,6 +29,9 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <fstream>
 #include <list>
+#include <map>
+#include <set>
+#include <vector>
 
 #include "visa_igc_common_header.h"
 #include "Common_ISA.h"
@@ -811,6 +814,14 @@ int CISA_IR_Builder::Compile( const char* nameInput)
 
         pseudoHeader.functions = (function_info_t*)mem.alloc(sizeof(function_info_t) * pseudoHeader.num_functions);
 
+        // Compiling units on several threads relies on every unit owning its
+        // state; 3D RA may still update the shared options, so 3D stays serial.
+        unsigned int numThreads = m_options.getuInt32Option(vISA_KernelCompileThreads);
+        if (m_options.getTarget() == VISA_3D)
+        {
+            numThreads = 0;
+        }
+
         int i;
         unsigned int k = 0;
         std::list<G4_Kernel*> compilationUnits;
@@ -846,13 +857,38 @@ int CISA_IR_Builder::Compile( const char* nameInput)
                 kernels.push_back(kernel);
             }
 
-            m_currentKernel = kernel;
+            if (numThreads <= 1)
+            {
+                m_currentKernel = kernel;
 
-            int status =  kernel->compileFastPath();
-			if (status != CM_SUCCESS)
-			{
-                stopTimer(TIMER_TOTAL);
-				return status;
+                int status =  kernel->compileFastPath();
+                if (status != CM_SUCCESS)
+                {
+                    stopTimer(TIMER_TOTAL);
+                    return status;
+                }
+            }
+        }
+
+        if (numThreads > 1)
+        {
+            // Every unit has its own IR builder up to this point, so all of
+            // them can be compiled concurrently. Report the first failure in
+            // unit order, as the serial loop would.
+            std::vector<VISAKernelImpl*> units(m_kernels.begin(), m_kernels.end());
+            std::vector<int> unitStatus(units.size(), CM_SUCCESS);
+            parallelFor(units.size(), numThreads, [&](size_t u)
+            {
+                unitStatus[u] = units[u]->compileFastPath();
+            }, [this]() { pCisaBuilder = this; });
+            m_currentKernel = units.back();
+            for (int unitResult : unitStatus)
+            {
+                if (unitResult != CM_SUCCESS)
+                {
+                    stopTimer(TIMER_TOTAL);
+                    return unitResult;
+                }
             }
         }
 
@@ -876,21 +912,15 @@ int CISA_IR_Builder::Compile( const char* nameInput)
             saveFCallState( function->getKernel(), savedFCallState );
         }
 
-        bool FCPatchNeeded = false;
-        for( std::list<VISAKernelImpl*>::iterator kernel_it = kernels.begin();
-            kernel_it != kernels.end();
-            kernel_it++ )
+        auto finishKernel = [&](VISAKernelImpl* kernel)
         {
-            VISAKernelImpl* kernel = (*kernel_it);
-
-            m_currentKernel = kernel;
-            compilationUnits.clear();
-            compilationUnits.push_back( kernel->getKernel() );
+            std::list<G4_Kernel*> kernelUnits;
+            kernelUnits.push_back( kernel->getKernel() );
             for( std::list<VISAKernelImpl*>::iterator func_it = functions.begin();
                 func_it != functions.end();
                 func_it++ )
             {
-                compilationUnits.push_back( (*func_it)->getKernel() );
+                kernelUnits.push_back( (*func_it)->getKernel() );
                 if(m_options.getOption(vISA_GenerateDebugInfo))
                 {
                     (*func_it)->getKernel()->getKernelDebugInfo()->resetRelocOffset();
@@ -900,7 +930,7 @@ int CISA_IR_Builder::Compile( const char* nameInput)
 
             unsigned int genxBufferSize = 0;
 
-            Stitch_Compiled_Units(pseudoHeader, compilationUnits);
+            Stitch_Compiled_Units(pseudoHeader, kernelUnits);
 
             void* genxBuffer = kernel->compilePostOptimize(genxBufferSize);
             kernel->setGenxBinaryBuffer(genxBuffer, genxBufferSize);
@@ -921,6 +951,68 @@ int CISA_IR_Builder::Compile( const char* nameInput)
 #endif
 
             restoreFCallState( kernel->getKernel(), savedFCallState );
+        };
+
+        // A kernel whose callees are not called by any other kernel does not
+        // touch IR shared with other kernels, so those kernels are finished
+        // concurrently. The rest reuse the IR of shared functions one kernel
+        // at a time and stay serial in their original order.
+        std::vector<VISAKernelImpl*> independentKernels;
+        std::set<VISAKernelImpl*> isIndependent;
+        if (numThreads > 1 && !m_options.getOption(vISA_GenerateDebugInfo))
+        {
+            std::list<G4_Kernel*> functionUnits;
+            for (VISAKernelImpl* function : functions)
+            {
+                functionUnits.push_back(function->getKernel());
+            }
+
+            std::vector<std::list<int>> kernelCallees;
+            std::map<int, unsigned int> calleeUses;
+            for (VISAKernelImpl* kernel : kernels)
+            {
+                std::list<int> callees;
+                Enumerate_Callees(pseudoHeader, kernel->getKernel(), functionUnits, callees);
+                for (int callee : callees)
+                {
+                    calleeUses[callee]++;
+                }
+                kernelCallees.push_back(callees);
+            }
+
+            size_t kernelIdx = 0;
+            for (VISAKernelImpl* kernel : kernels)
+            {
+                bool shared = false;
+                for (int callee : kernelCallees[kernelIdx++])
+                {
+                    shared |= calleeUses[callee] > 1;
+                }
+                if (!shared)
+                {
+                    independentKernels.push_back(kernel);
+                    isIndependent.insert(kernel);
+                }
+            }
+        }
+
+        parallelFor(independentKernels.size(), numThreads, [&](size_t k)
+        {
+            finishKernel(independentKernels[k]);
+        }, [this]() { pCisaBuilder = this; });
+
+        bool FCPatchNeeded = false;
+        for( std::list<VISAKernelImpl*>::iterator kernel_it = kernels.begin();
+            kernel_it != kernels.end();
+            kernel_it++ )
+        {
+            VISAKernelImpl* kernel = (*kernel_it);
+
+            if (!isIndependent.count(kernel))
+            {
+                m_currentKernel = kernel;
+                finishKernel(kernel);
+            }
 
             if(kernel->isFCCallableKernel() ||
                 kernel->isFCCallerKernel() ||
@@ -1335,7 +1335,12 @@ public:
         lab = newLab.c_str();
 
         G4_Label* l = hashtable.lookupLabel(lab);
-        return (l != NULL)? l : hashtable.createLabel(lab);
+        if (l == NULL)
+        {
+            l = hashtable.createLabel(lab);
+            l->setKernelName(kernel.getName());
+        }
+        return l;
     }
 
     G4_Predicate* createPredicate(G4_PredState s, G4_VarBase* flag, unsigned short srOff, G4_Predicate_Control ctrl = PRED_DEFAULT)
@@ -26,6 +26,8 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "CISALinker.h"
 #include <stdio.h>
+#include <algorithm>
+#include <thread>
 
 // *** Macros ***
 
@@ -154,6 +156,7 @@ CISALinker::LinkCisaObjInfos(const std::string& knlName)
         TRY(LinkExternCisaObjInfos());
     }
 
+    TRY(RelocPendingClosures());
     TRY(BuildLinkedCisaObj(cisaKnlClosureList));
     TRY(UpdateLinkedCisaImageOffsetsAndSize());
     ClearGlobalInfoTables();
@@ -271,6 +274,39 @@ CISALinker::GetGlobalVarClosure(
     return 0;
 }
 
+// The scratch field of an extern entry is otherwise unused, so it caches the
+// global closure the entry resolves to. Every reference to the same extern
+// symbol from a CISA object then costs a single name lookup.
+inline int
+CISALinker::GetExternUnitClosure(
+    CompiledUnitInfo& externUnitInfo, CompiledUnitClosure *& externUnitClosure)
+{
+    externUnitClosure = UNITCLOSURE(externUnitInfo);
+
+    if (externUnitClosure == NULL) {
+        std::string unitName(externUnitInfo.name, externUnitInfo.name_len);
+        TRY(GetGlobalUnitClosure(unitName, externUnitClosure));
+        CLOSURE(externUnitInfo) = externUnitClosure;
+    }
+
+    return 0;
+}
+
+inline int
+CISALinker::GetExternVarClosure(
+    CompiledVarInfo& externVarInfo, CompiledVarClosure *& externVarClosure)
+{
+    externVarClosure = VARCLOSURE(externVarInfo);
+
+    if (externVarClosure == NULL) {
+        std::string varName((char *) externVarInfo.name, externVarInfo.name_len);
+        TRY(GetGlobalVarClosure(varName, externVarClosure));
+        CLOSURE(externVarInfo) = externVarClosure;
+    }
+
+    return 0;
+}
+
 int
 CISALinker::CreateKernelClosures(
     const std::string& knlName, CompiledUnitClosureList& knlClosureList)
@@ -338,17 +374,15 @@ CISALinker::LinkLocalCisaObjInfos(
         TRY(LinkInDepVars(**iter));
     }
 
-    for (iter = _pendingLocalClosures.begin();
-         iter != _pendingLocalClosures.end(); ++iter) {
-        TRY(RelocFunctionSyms(**iter));
-        TRY(RelocVariableSyms(**iter));
-    }
-
-    for (iter = localUnitClosureList.begin();
-         iter != localUnitClosureList.end(); ++iter) {
-        TRY(RelocFunctionSyms(**iter));
-        TRY(RelocVariableSyms(**iter));
-    }
+    // Relocation only reads link indices that are final once a closure has
+    // been linked in, so it is deferred until every kernel has been linked
+    // and then done for all closures at once (see RelocPendingClosures).
+    _pendingRelocClosures.insert(
+        _pendingRelocClosures.end(),
+        _pendingLocalClosures.begin(), _pendingLocalClosures.end());
+    _pendingRelocClosures.insert(
+        _pendingRelocClosures.end(),
+        localUnitClosureList.begin(), localUnitClosureList.end());
 
     _pendingLocalClosures.clear();
     _localUnitMap = NULL;
@@ -433,8 +467,7 @@ CISALinker::LinkInDepUnits(CompiledUnitClosure& cisaUnitClosure)
             CompiledUnitInfo& unit =
                 cisaUnitClosure.unitObjInfo->hdr.functions[inputRefIndex];
             CompiledUnitClosure *externUnitClosure = NULL;
-            std::string unitName(unit.name, unit.name_len);
-            TRY(GetGlobalUnitClosure(unitName, externUnitClosure));
+            TRY(GetExternUnitClosure(unit, externUnitClosure));
 
             if (externUnitClosure->linkedUnitIndex == -1) {
                 externUnitClosure->linkedUnitIndex = _countLinkedUnits++;
@@ -490,8 +523,7 @@ CISALinker::LinkInDepVars(CompiledUnitClosure& cisaUnitClosure)
         else {
             CompiledVarInfo& variable = vars[inputRefIndex];
             CompiledVarClosure *externVarClosure = NULL;
-            std::string varName((char *) variable.name, variable.name_len);
-            TRY(GetGlobalVarClosure(varName, externVarClosure));
+            TRY(GetExternVarClosure(variable, externVarClosure));
 
             if (externVarClosure->linkedVarIndex == -1) {
                 externVarClosure->linkedVarIndex = _countLinkedVars++;
@@ -507,6 +539,7 @@ int
 CISALinker::RelocFunctionSyms(CompiledUnitClosure& localUnitClosure)
 {
     CompiledUnitInfo& localUnitInfo = *localUnitClosure.unit;
+    CompiledUnitInfo *units = localUnitClosure.unitObjInfo->hdr.functions;
 
     for (int i = 0; i < localUnitInfo.function_reloc_symtab.num_syms; i++) {
         int inputRefIndex =
@@ -515,18 +548,15 @@ CISALinker::RelocFunctionSyms(CompiledUnitClosure& localUnitClosure)
 
         if (inputRefIndex >= offset) {
             int linkedUnitIndex =
-                UNITCLOSURE(_localUnitMap[inputRefIndex])->linkedUnitIndex;
+                UNITCLOSURE(units[inputRefIndex])->linkedUnitIndex;
             INTERNAL_ASSERT(linkedUnitIndex >= 0);
             localUnitInfo.function_reloc_symtab.reloc_syms[i].resolved_index =
                 linkedUnitIndex;
         }
         else {
-            CompiledUnitInfo *units =
-                localUnitClosure.unitObjInfo->hdr.functions;
-            CompiledUnitInfo& unit = units[inputRefIndex];
-            CompiledUnitClosure *externUnitClosure = NULL;
-            std::string unitName(unit.name, unit.name_len);
-            TRY(GetGlobalUnitClosure(unitName, externUnitClosure));
+            CompiledUnitClosure *externUnitClosure =
+                UNITCLOSURE(units[inputRefIndex]);
+            INTERNAL_ASSERT(externUnitClosure);
             int linkedUnitIndex = externUnitClosure->linkedUnitIndex;
             INTERNAL_ASSERT(linkedUnitIndex >= 0);
             localUnitInfo.function_reloc_symtab.reloc_syms[i].resolved_index =
@@ -553,16 +583,15 @@ CISALinker::RelocVariableSyms(CompiledUnitClosure& localUnitClosure)
 
         if (inputRefIndex >= offset) {
             int linkedVarIndex =
-                VARCLOSURE(_localVarMap[inputRefIndex])->linkedVarIndex;
+                VARCLOSURE(vars[inputRefIndex])->linkedVarIndex;
             INTERNAL_ASSERT(linkedVarIndex >= 0);
             localUnitInfo.variable_reloc_symtab.reloc_syms[i].resolved_index =
                 linkedVarIndex;
         }
         else {
-            CompiledVarInfo& variable = vars[inputRefIndex];
-            CompiledVarClosure * externVarClosure = NULL;
-            std::string unitName((char *) variable.name, variable.name_len);
-            TRY(GetGlobalVarClosure(unitName, externVarClosure));
+            CompiledVarClosure *externVarClosure =
+                VARCLOSURE(vars[inputRefIndex]);
+            INTERNAL_ASSERT(externVarClosure);
             int linkedVarIndex = externVarClosure->linkedVarIndex;
             INTERNAL_ASSERT(linkedVarIndex >= 0);
             localUnitInfo.variable_reloc_symtab.reloc_syms[i].resolved_index =
@@ -573,6 +602,48 @@ CISALinker::RelocVariableSyms(CompiledUnitClosure& localUnitClosure)
     return 0;
 }
 
+int
+CISALinker::RelocPendingClosures()
+{
+    // Linking has resolved every extern entry into its scratch field, so
+    // relocating a closure only writes its own reloc tables and the closures
+    // can be processed independently of each other.
+    const size_t numClosures = _pendingRelocClosures.size();
+    std::vector<int> status(numClosures, 0);
+    auto relocRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            CompiledUnitClosure& closure = *_pendingRelocClosures[i];
+            status[i] =
+                RelocFunctionSyms(closure) || RelocVariableSyms(closure);
+        }
+    };
+
+    size_t numThreads =
+        std::min<size_t>(
+            std::thread::hardware_concurrency(),
+            numClosures / MIN_RELOC_CLOSURES_PER_THREAD);
+
+    if (numThreads <= 1) {
+        relocRange(0, numClosures);
+    }
+    else {
+        size_t chunk = (numClosures + numThreads - 1) / numThreads;
+        size_t numChunks = (numClosures + chunk - 1) / chunk;
+
+        parallelFor(numChunks, (unsigned int)numThreads, [&](size_t c) {
+            relocRange(c * chunk, std::min((c + 1) * chunk, numClosures));
+        });
+    }
+
+    _pendingRelocClosures.clear();
+
+    for (size_t i = 0; i < numClosures; i++) {
+        TRY(status[i]);
+    }
+
+    return 0;
+}
+
 int
 CISALinker::BuildLinkedCisaObj(CompiledUnitClosureList& knlClosureList)
 {
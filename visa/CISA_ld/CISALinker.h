@@ -98,6 +98,9 @@ private:
         std::string, CompiledVarInfo *>  GlobalVarNameToInfoMap;
     typedef std::vector<CompiledVarClosure *>  LinkedVarIndexToClosureMap;
 
+    // Below this many closures per worker, relocation stays single threaded.
+    static const size_t MIN_RELOC_CLOSURES_PER_THREAD = 256;
+
 
     // *** Private functions ***
 
@@ -115,6 +118,12 @@ private:
 	int GetGlobalVarClosure(
         const std::string& unitName,
         CompiledVarClosure *& globalVarClosure);
+    int GetExternUnitClosure(
+        CompiledUnitInfo& externUnitInfo,
+        CompiledUnitClosure *& externUnitClosure);
+    int GetExternVarClosure(
+        CompiledVarInfo& externVarInfo,
+        CompiledVarClosure *& externVarClosure);
 	int CreateKernelClosures(
 		const std::string& knlName, CompiledUnitClosureList& knlClosureList);
     int LinkCisaObjInfos(const std::string& knlName);
@@ -126,6 +135,7 @@ private:
     int LinkInDepVars(CompiledUnitClosure& cisaUnitClosure);
     int RelocFunctionSyms(CompiledUnitClosure& localUnitClosure);
     int RelocVariableSyms(CompiledUnitClosure& localUnitClosure);
+    int RelocPendingClosures();
     int BuildLinkedCisaObj(CompiledUnitClosureList& cisaKnlClosureList);
     int BuildLinkedUnitInfo(
         const std::string &unitName, CompiledUnitClosure& objUnitClosure,
@@ -166,6 +176,7 @@ private:
 
     CompiledUnitClosureList     _pendingLocalClosures;
     CompiledUnitClosureList     _pendingExternClosures;
+    std::vector<CompiledUnitClosure *> _pendingRelocClosures;
 
     int                         _countLinkedUnits;
 	int                         _countLinkedVars;
@@ -30,6 +30,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "FlowGraph.h"
 #include "BuildIR.h"
 #include <map>
+#include <algorithm>
 #include "Common_ISA_framework.h"
 #include "BuildCISAIR.h"
 #include "VISAKernel.h"
@@ -75,6 +76,54 @@ void DbgDecoder::ddName()
     std::cout << name;
 }
 
+int DbgDecoder::ddOffsetMap(const char* keyName)
+{
+    uint32_t numElements;
+    auto retval = fread(&numElements, sizeof(uint32_t), 1, dbgFile);
+    if (!retval)
+        return -1;
+
+    std::cout << keyName << " -> Gen byte offset mapping\n";
+
+    if (compact)
+    {
+        uint32_t numBytes;
+        retval = fread(&numBytes, sizeof(uint32_t), 1, dbgFile);
+        if (!retval)
+            return -1;
+
+        std::vector<unsigned char> bytes(numBytes);
+        if (numBytes != 0 && fread(bytes.data(), sizeof(unsigned char), numBytes, dbgFile) != numBytes)
+            return -1;
+
+        DeltaOffsetTable::const_iterator it(bytes.data(), bytes.data() + bytes.size());
+        for (uint32_t j = 0; j < numElements; j++, ++it)
+        {
+            std::cout << it->first << "\t" << it->second << "\n";
+        }
+    }
+    else
+    {
+        for (uint32_t j = 0; j < numElements; j++)
+        {
+            uint32_t key, genOffset;
+            retval = fread(&key, sizeof(uint32_t), 1, dbgFile);
+            if (!retval)
+                return -1;
+
+            retval = fread(&genOffset, sizeof(uint32_t), 1, dbgFile);
+            if (!retval)
+                return -1;
+
+            std::cout << key << "\t" << genOffset << "\n";
+        }
+    }
+
+    std::cout << "\n";
+
+    return 0;
+}
+
 template<class T>
 void DbgDecoder::ddLiveInterval()
 {
@@ -289,7 +338,8 @@ int DbgDecoder::ddDbg()
 
     std::cout << "=== Start of Debug Dump ===" << "\n";
     std::cout << "Magic: " << "0x" << std::hex << magic << std::dec << "\n";
-    if(magic != DEBUG_MAGIC_NUMBER)
+    compact = (magic == DEBUG_MAGIC_NUMBER_COMPACT);
+    if(magic != DEBUG_MAGIC_NUMBER && !compact)
     {
         std::cout << "************ Magic expected = " << "0x" << std::hex << DEBUG_MAGIC_NUMBER << std::dec << " *************" << "\n";
 
@@ -327,52 +377,12 @@ int DbgDecoder::ddDbg()
             std::cout << "(function binary @ gen offset " << reloc_offset << " bytes)" << "\n";
         }
 
-        uint32_t numElementsCISAOffsetMap;
-        retval = fread(&numElementsCISAOffsetMap, sizeof(uint32_t), 1, dbgFile);
-        if (!retval)
+        if (ddOffsetMap("CISA byte offset") != 0)
             return -1;
 
-        std::cout << "CISA byte offset -> Gen byte offset mapping\n";
-
-        for(unsigned int j = 0; j < numElementsCISAOffsetMap; j++)
-        {
-            uint32_t cisaOffset, genOffset;
-            retval = fread(&cisaOffset, sizeof(uint32_t), 1, dbgFile);
-            if (!retval)
-                return -1;
-
-            retval = fread(&genOffset, sizeof(uint32_t), 1, dbgFile);
-            if (!retval)
-                return -1;
-
-            std::cout << cisaOffset << "\t" << genOffset << "\n";
-        }
-
-        std::cout << "\n";
-
-        uint32_t numElementsCISAIndexMap;
-        retval = fread(&numElementsCISAIndexMap, sizeof(uint32_t), 1, dbgFile);
-        if (!retval)
+        if (ddOffsetMap("CISA index") != 0)
             return -1;
 
-        std::cout << "CISA index -> Gen byte offset mapping\n";
-
-        for(unsigned int j = 0; j < numElementsCISAIndexMap; j++)
-        {
-            uint32_t cisaIndex, genOffset;
-            retval = fread(&cisaIndex, sizeof(uint32_t), 1, dbgFile);
-            if (!retval)
-                return -1;
-
-            retval = fread(&genOffset, sizeof(uint32_t), 1, dbgFile);
-            if (!retval)
-                return -1;
-
-            std::cout << cisaIndex << "\t" << genOffset << "\n";
-        }
-
-        std::cout << "\n";
-
         uint32_t numElementsVarMap;
         retval = fread(&numElementsVarMap, sizeof(uint32_t), 1, dbgFile);
         if (!retval)
@@ -515,7 +525,7 @@ bool KernelDebugInfo::isMissingVISAId(unsigned int id)
         computeMissingVISAIds();
     }
 
-    return (missingVISAIds.find(id) != missingVISAIds.end());
+    return id < missingVISAIds.size() && missingVISAIds[id];
 }
 
 void KernelDebugInfo::computeMissingVISAIds()
@@ -534,7 +544,7 @@ void KernelDebugInfo::computeMissingVISAIds()
         }
     }
 
-    std::vector<bool> seenVISAIds(maxCISAId+1, false);
+    missingVISAIds.assign(maxCISAId+1, true);
 
     for (auto bb : getKernel().fg.BBs)
     {
@@ -542,19 +552,11 @@ void KernelDebugInfo::computeMissingVISAIds()
         {
             if (inst->getCISAOff() != UNMAPPABLE_VISA_INDEX)
             {
-                seenVISAIds[inst->getCISAOff()] = true;
+                missingVISAIds[inst->getCISAOff()] = false;
             }
         }
     }
 
-    for (unsigned int i = 0; i < seenVISAIds.size(); i++)
-    {
-        if (!seenVISAIds[i])
-        {
-            missingVISAIds.insert(i);
-        }
-    }
-
     missingVISAIdsComputed = true;
 }
 
@@ -564,7 +566,6 @@ void KernelDebugInfo::updateMapping(std::list<G4_BB*>& stackCallEntryBBs)
 
     generateByteOffsetMapping(stackCallEntryBBs);
     emitRegisterMapping();
-    generateCISAByteOffsetFromOffset();
     generateGenISAToVISAIndex();
 }
 
@@ -580,7 +581,7 @@ void KernelDebugInfo::generateGenISAToVISAIndex()
         {
             if (inst->getGenOffset() == -1)
                 continue;
-            genISAOffsetToVISAIndex.push_back(std::make_pair((unsigned int)inst->getGenOffset(), (unsigned int)inst->getCISAOff()));
+            genISAOffsetToVISAIndex.push_back((unsigned int)inst->getGenOffset(), (unsigned int)inst->getCISAOff());
         }
     }
 }
@@ -591,28 +592,6 @@ void KernelDebugInfo::setVISAKernel(VISAKernelImpl* k)
     kernel = k->getKernel();
 }
 
-void KernelDebugInfo::generateCISAByteOffsetFromOffset()
-{
-    // Using map1 and map2, generate map3
-    for(std::vector<std::pair<unsigned int, unsigned int>>::iterator it = mapCISAIndexGenOffset.begin();
-        it != mapCISAIndexGenOffset.end();
-        it++)
-    {
-        // Read each entry in CISA Index->Gen Offset then map CISA Index to CISA Offset.
-        // Push back results.
-        unsigned int cisaIndex = (*it).first;
-        unsigned int genOffset = (*it).second;
-
-        std::map<unsigned int, unsigned int>::iterator map_it = mapCISAOffset.find(cisaIndex);
-
-        if (map_it != mapCISAOffset.end())
-        {
-            unsigned int cisaOffset = mapCISAOffset.find(cisaIndex)->second;
-            mapCISAOffsetGenOffset.push_back(std::make_pair(cisaOffset, genOffset));
-        }
-    }
-}
-
 void KernelDebugInfo::generateByteOffsetMapping(std::list<G4_BB*>& stackCallEntryBBs)
 {
     // When compiling stack call functions, all stack call functions
@@ -678,7 +657,13 @@ void KernelDebugInfo::generateByteOffsetMapping(std::list<G4_BB*>& stackCallEntr
                     // mapping holds pair of CISA bytecode index and gen Offset
                     // Use VISAKernelImpl's member mapCISAOffset to convert
                     // CISA bytecode index to CISA bytecode byte offset
-                    mapCISAIndexGenOffset.push_back(std::make_pair(cisaByteIndex, (int)inst->getGenOffset()));
+                    unsigned int genOffset = (unsigned int)inst->getGenOffset();
+                    unsigned int cisaOffset;
+                    mapCISAIndexGenOffset.push_back(cisaByteIndex, genOffset);
+                    if (mapCISAOffset.find(cisaByteIndex, cisaOffset))
+                    {
+                        mapCISAOffsetGenOffset.push_back(cisaOffset, genOffset);
+                    }
                 }
             }
         }
@@ -985,6 +970,32 @@ void emitDataUInt8(uint8_t data, T& t)
     insertData(&data, sizeof(uint8_t), t);
 }
 
+// Emit an offset map with relocOffset subtracted from every gen offset
+template<class T>
+void emitDataOffsetMap(DeltaOffsetTable& map, uint32_t relocOffset, bool compact, T& t)
+{
+    emitDataUInt32((uint32_t)map.size(), t);
+
+    if (compact)
+    {
+        DeltaOffsetTable relocated;
+        for (auto& entry : map)
+        {
+            relocated.push_back(entry.first, entry.second - relocOffset);
+        }
+        auto& bytes = relocated.getBytes();
+        emitDataUInt32((uint32_t)bytes.size(), t);
+        insertData(bytes.data(), (uint32_t)bytes.size(), t);
+        return;
+    }
+
+    for (auto& entry : map)
+    {
+        emitDataUInt32((uint32_t)entry.first, t);
+        emitDataUInt32((uint32_t)(entry.second - relocOffset), t);
+    }
+}
+
 template<class T>
 void emitDataVarLiveInterval(VISAKernelImpl* visaKernel, LiveIntervalInfo* lrInfo, uint32_t i, uint16_t size, T& t)
 {
@@ -1468,7 +1479,8 @@ void emitDataCallFrameInfo(VISAKernelImpl* visaKernel, T& t)
 template<class T>
 void emitData(std::list<VISAKernelImpl*>& compilationUnits, T t)
 {
-    const unsigned int magic = DEBUG_MAGIC_NUMBER;
+    const bool compact = compilationUnits.front()->getOptions()->getOption(vISA_CompactDebugInfo);
+    const unsigned int magic = compact ? DEBUG_MAGIC_NUMBER_COMPACT : DEBUG_MAGIC_NUMBER;
     const unsigned int numKernels = (uint32_t) compilationUnits.size();
     // Magic
     emitDataUInt32((uint32_t)magic, t);
@@ -1496,38 +1508,10 @@ void emitData(std::list<VISAKernelImpl*>& compilationUnits, T t)
         }
 
         // Emit CISA Offset:Gen Offset mapping
-        const unsigned int numElementsCISAOffsetMap = (uint32_t) curKernel->getKernel()->getKernelDebugInfo()->getMapCISAOffsetGenOffset().size();
-        // Num elements
-        emitDataUInt32((uint32_t)numElementsCISAOffsetMap, t);
-
-        // Emit out actual CISA Offset:Gen Offset mapping elements
-        for(unsigned int i = 0; i < numElementsCISAOffsetMap; i++)
-        {
-            const unsigned int cisaOffset = curKernel->getKernel()->getKernelDebugInfo()->getMapCISAOffsetGenOffset()[i].first;
-            const unsigned int genOffset = curKernel->getKernel()->getKernelDebugInfo()->getMapCISAOffsetGenOffset()[i].second -
-                (unsigned int)reloc_offset;
-
-            // Write cisa offset and gen offset
-            emitDataUInt32((uint32_t)cisaOffset, t);
-            emitDataUInt32((uint32_t)genOffset, t);
-        }
+        emitDataOffsetMap(curKernel->getKernel()->getKernelDebugInfo()->getMapCISAOffsetGenOffset(), reloc_offset, compact, t);
 
         // Emit CISA index:Gen Offset mapping
-        const unsigned int numElementsCISAIndexMap = (uint32_t) curKernel->getKernel()->getKernelDebugInfo()->getMapCISAIndexGenOffset().size();
-        // Num elements
-        emitDataUInt32((uint32_t)numElementsCISAIndexMap, t);
-
-        // Emit out actual CISA index:Gen Offset mapping
-        for(unsigned int i = 0; i < numElementsCISAIndexMap; i++)
-        {
-            const unsigned int cisaIndex = curKernel->getKernel()->getKernelDebugInfo()->getMapCISAIndexGenOffset()[i].first;
-            const unsigned int genOffset = curKernel->getKernel()->getKernelDebugInfo()->getMapCISAIndexGenOffset()[i].second -
-                (unsigned int)reloc_offset;
-
-            // Write cisa index and gen offset
-            emitDataUInt32((uint32_t)cisaIndex, t);
-            emitDataUInt32((uint32_t)genOffset, t);
-        }
+        emitDataOffsetMap(curKernel->getKernel()->getKernelDebugInfo()->getMapCISAIndexGenOffset(), reloc_offset, compact, t);
 
         // All variables present in varMap need not be present in
         // mapDclName. Only those variables seen when constructing
@@ -1633,6 +1617,91 @@ void emitDebugInfoToMem(VISAKernelImpl* curKernel, void*& info, unsigned& size)
     emitDebugInfoToMem(curKernel, compilationUnits, info, size);
 }
 
+void DeltaOffsetTable::push_back(unsigned int key, unsigned int value)
+{
+    keysSorted &= (numEntries == 0 || key >= last.first);
+
+    unsigned int deltas[2] = { key - last.first, value - last.second };
+    for (unsigned int delta : deltas)
+    {
+        // Zigzag so small negative deltas stay small
+        uint32_t zz = ((uint32_t)delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+        while (zz >= 0x80)
+        {
+            bytes.push_back((unsigned char)(zz | 0x80));
+            zz >>= 7;
+        }
+        bytes.push_back((unsigned char)zz);
+    }
+
+    last = Entry(key, value);
+    if (numEntries % CheckpointInterval == 0)
+    {
+        checkpoints.push_back({ last, bytes.size() });
+    }
+    numEntries++;
+}
+
+void DeltaOffsetTable::decodeNext(const unsigned char*& p, unsigned int& key, unsigned int& value)
+{
+    unsigned int* fields[2] = { &key, &value };
+    for (unsigned int* field : fields)
+    {
+        uint32_t zz = 0;
+        unsigned int shift = 0;
+        unsigned char byte;
+        do
+        {
+            byte = *p++;
+            zz |= (uint32_t)(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        *field += (zz >> 1) ^ (0 - (zz & 1));
+    }
+}
+
+bool DeltaOffsetTable::find(unsigned int key, unsigned int& value) const
+{
+    MUST_BE_TRUE(keysSorted, "Searching an offset table with unsorted keys");
+
+    // Start from the last checkpoint with a smaller key, so that the
+    // first of several entries with this key is found.
+    auto it = std::lower_bound(checkpoints.begin(), checkpoints.end(), key,
+        [](const Checkpoint& c, unsigned int k) { return c.entry.first < k; });
+    if (it != checkpoints.begin())
+    {
+        --it;
+    }
+    else if (it == checkpoints.end() || it->entry.first != key)
+    {
+        return false;
+    }
+
+    Entry cur = it->entry;
+    const unsigned char* p = bytes.data() + it->nextPos;
+    const unsigned char* end = bytes.data() + bytes.size();
+    while (cur.first < key && p != end)
+    {
+        decodeNext(p, cur.first, cur.second);
+    }
+
+    if (cur.first != key)
+    {
+        return false;
+    }
+    value = cur.second;
+    return true;
+}
+
+void DeltaOffsetTable::clear()
+{
+    bytes.clear();
+    checkpoints.clear();
+    numEntries = 0;
+    last = Entry(0, 0);
+    keysSorted = true;
+}
+
 void* KernelDebugInfo::operator new(size_t sz, Mem_Manager& m)
 {
     return m.alloc(sz);
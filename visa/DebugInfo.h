@@ -94,6 +94,9 @@ void updateDebugInfo(vISA::G4_Kernel& kernel, vISA::G4_Declare* dcl, uint32_t of
 void updateCallStackLiveIntervals(vISA::G4_Kernel& kernel);
 
 #define DEBUG_MAGIC_NUMBER ((unsigned int)0xdeadd010)
+// Same layout as DEBUG_MAGIC_NUMBER except that the CISA offset/index to
+// Gen offset maps are emitted as DeltaOffsetTable byte streams.
+#define DEBUG_MAGIC_NUMBER_COMPACT ((unsigned int)0xdeadd011)
 
 // Format of debug info
 struct VarnameMap
@@ -140,6 +143,83 @@ struct VarnameMap
 // on G4_Kernel.
 namespace vISA
 {
+// Append-only table of (key, value) offset pairs. Each pair is stored as
+// LEB128 encoded zigzag deltas from the previous pair. The offset maps
+// below are produced in layout order, so an entry usually takes 2-3 bytes
+// instead of 8. The full pair is also recorded every CheckpointInterval
+// entries, so that a table whose keys were appended in non-decreasing
+// order can be searched by key with a binary search.
+class DeltaOffsetTable
+{
+public:
+    typedef std::pair<unsigned int, unsigned int> Entry;
+
+    class const_iterator
+    {
+    public:
+        const_iterator(const unsigned char* p, const unsigned char* e) : pos(p), end(e), cur(0, 0)
+        {
+            advance();
+        }
+        const Entry& operator*() const { return cur; }
+        const Entry* operator->() const { return &cur; }
+        const_iterator& operator++() { advance(); return *this; }
+        bool operator==(const const_iterator& other) const { return pos == other.pos && atEnd == other.atEnd; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        void advance()
+        {
+            atEnd = (pos == end);
+            if (!atEnd)
+            {
+                DeltaOffsetTable::decodeNext(pos, cur.first, cur.second);
+            }
+        }
+
+        const unsigned char* pos;
+        const unsigned char* end;
+        Entry cur;
+        bool atEnd;
+    };
+
+    void push_back(unsigned int key, unsigned int value);
+    void push_back(const Entry& e) { push_back(e.first, e.second); }
+    // Find the first entry with the given key. Only valid if keys
+    // were appended in non-decreasing order.
+    bool find(unsigned int key, unsigned int& value) const;
+    void clear();
+
+    size_t size() const { return numEntries; }
+    bool empty() const { return numEntries == 0; }
+    const Entry& back() const { return last; }
+    const_iterator begin() const { return const_iterator(bytes.data(), bytes.data() + bytes.size()); }
+    const_iterator end() const { return const_iterator(bytes.data() + bytes.size(), bytes.data() + bytes.size()); }
+
+    // Encoded entries, as written to compact debug info.
+    const std::vector<unsigned char>& getBytes() const { return bytes; }
+
+    // Decode the entry at p given the previous entry in key/value and
+    // advance p past it. key/value must be 0 for the first entry.
+    static void decodeNext(const unsigned char*& p, unsigned int& key, unsigned int& value);
+
+private:
+    static const size_t CheckpointInterval = 32;
+
+    struct Checkpoint
+    {
+        Entry entry;
+        // Byte offset of the entry following this one
+        size_t nextPos;
+    };
+
+    std::vector<unsigned char> bytes;
+    std::vector<Checkpoint> checkpoints;
+    size_t numEntries = 0;
+    Entry last = Entry(0, 0);
+    bool keysSorted = true;
+};
+
 class KernelDebugInfo
 {
 private:
@@ -172,23 +252,24 @@ private:
 
     INST_LIST oldInsts;
 
-    // Store pair of cisa byte offset and gen byte offset in vector
-    std::vector<std::pair<unsigned int, unsigned int>> mapCISAOffsetGenOffset;
-    // Store pair of cisa index and gen byte offset in vector
-    std::vector<std::pair<unsigned int, unsigned int>> mapCISAIndexGenOffset;
+    // Store pair of cisa byte offset and gen byte offset
+    DeltaOffsetTable mapCISAOffsetGenOffset;
+    // Store pair of cisa index and gen byte offset
+    DeltaOffsetTable mapCISAIndexGenOffset;
     // Store varname map instance for each dcl
     std::vector<VarnameMap*> varsMap;
-    // Store map between CISA bytecode index and CISA offset
-    std::map<unsigned int, unsigned int> mapCISAOffset;
+    // Store map between CISA bytecode index and CISA offset. Indices are
+    // inserted in increasing order while reading the bytecode.
+    DeltaOffsetTable mapCISAOffset;
     // Store reloc_offset of gen binary. This is emitted out to debug info.
     uint32_t reloc_offset;
 
     // Store set of missing VISA ids as this helps consolidate live-intervals
-    // to save compile time.
-    std::set<unsigned int> missingVISAIds;
+    // to save compile time. Indexed by VISA id, true if the id is missing.
+    std::vector<bool> missingVISAIds;
     bool missingVISAIdsComputed;
 
-    std::vector<std::pair<unsigned int, unsigned int>> genISAOffsetToVISAIndex;
+    DeltaOffsetTable genISAOffsetToVISAIndex;
 
 public:
     LiveIntervalInfo* getLiveIntervalInfo(G4_Declare* dcl, bool createIfNULL = true);
@@ -275,7 +356,6 @@ public:
 
     void generateByteOffsetMapping(std::list<G4_BB*>& stackCallEntryBBs);
     void emitRegisterMapping();
-    void generateCISAByteOffsetFromOffset();
     void updateRelocOffset();
     void updateCallStackLiveIntervals();
     void generateGenISAToVISAIndex();
@@ -286,12 +366,16 @@ public:
 
     void mapCISAOffsetInsert(unsigned int a, unsigned int b)
     {
-        mapCISAOffset.insert(std::make_pair(a, b));
+        // Keep the first offset seen for an index
+        if (mapCISAOffset.empty() || mapCISAOffset.back().first < a)
+        {
+            mapCISAOffset.push_back(a, b);
+        }
     }
 
-    std::vector<std::pair<unsigned int, unsigned int>>& getMapCISAOffsetGenOffset() { return mapCISAOffsetGenOffset; }
-    std::vector<std::pair<unsigned int, unsigned int>>& getMapCISAIndexGenOffset() { return mapCISAIndexGenOffset; }
-    std::vector<std::pair<unsigned int, unsigned int>>& getMapGenISAOffsetToCISAIndex() { return genISAOffsetToVISAIndex; }
+    DeltaOffsetTable& getMapCISAOffsetGenOffset() { return mapCISAOffsetGenOffset; }
+    DeltaOffsetTable& getMapCISAIndexGenOffset() { return mapCISAIndexGenOffset; }
+    DeltaOffsetTable& getMapGenISAOffsetToCISAIndex() { return genISAOffsetToVISAIndex; }
     std::vector<VarnameMap*>& getVarsMap() { return varsMap; }
 
     uint32_t getVarIndex(G4_Declare* dcl);
@@ -390,8 +474,10 @@ class DbgDecoder
 private:
     char* filename;
     std::FILE* dbgFile;
+    bool compact = false;
 
     void ddName();
+    int ddOffsetMap(const char* keyName);
     template<class T> void ddLiveInterval();
     void ddCalleeCallerSave(uint32_t relocOffset);
 
@@ -43,6 +43,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "DebugInfo.h"
 #include <random>
 #include <chrono>
+#include <atomic>
 
 #include "iga/IGALibrary/api/iga.h"
 #include "iga/IGALibrary/api/iga.hpp"
@@ -436,7 +437,8 @@ G4_BB* FlowGraph::createNewBB(bool insertInFG)
     return bb;
 }
 
-static int globalCount = 1;
+// Kernels of a program may be finalized in parallel.
+static std::atomic<int> globalCount(1);
 int64_t FlowGraph::insertDummyUUIDMov()
 {
     // Here when -addKernelId is passed
@@ -454,8 +456,7 @@ int64_t FlowGraph::insertDummyUUIDMov()
         for (auto bb : BBs)
         {
             uint32_t seed = (uint32_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
-            std::mt19937 mt_rand(seed * globalCount);
-            globalCount++;
+            std::mt19937 mt_rand(seed * globalCount++);
 
             G4_DstRegRegion* nullDst = builder->createNullDst(Type_UD);
             int64_t uuID = (int64_t)mt_rand();
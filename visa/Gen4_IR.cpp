@@ -6627,9 +6627,11 @@ void G4_Label::emit(std::ostream& output, bool symbolreg)
         pCisaBuilder->m_options.getOption(vISA_LabelStr, labelStr);
         if (labelStr != nullptr)
         {
-        output << (pCisaBuilder != NULL ? pCisaBuilder->getCurrentKernel()->getName() : "") << "_" <<
-            labelStr << "_" << label;
-    }
+            // Kernels may be emitted in parallel, so the builder's current
+            // kernel is not necessarily the one owning this label.
+            output << (kernelName != nullptr ? kernelName : "") << "_" <<
+                labelStr << "_" << label;
+        }
     }
     else
     {
@@ -2683,11 +2683,12 @@ class G4_Label: public G4_Operand
     friend class OperandHashTable; // labels are hashed, and only OperandHashTable may create a label
 
     char* label;
+    const char* kernelName;     // owning kernel, prefixes the label with -uniqueLabels
     bool funcLabel;
     bool start_loop_label;
     bool isFC;
 
-    G4_Label(char* l) : G4_Operand(G4_Operand::label), label(l)
+    G4_Label(char* l) : G4_Operand(G4_Operand::label), label(l), kernelName(nullptr)
     {
         funcLabel = false;
         start_loop_label = false;
@@ -2705,6 +2706,7 @@ public:
     bool isStartLoopLabel(){ return start_loop_label; }
     bool isFCLabel() { return isFC; }
     void setFCLabel(bool fcLabel) { isFC = fcLabel; }
+    void setKernelName(const char* name) { kernelName = name; }
 };
 }
 //
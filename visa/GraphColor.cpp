@@ -1891,12 +1891,81 @@ uint32_t GlobalRA::getRefCount(int loopNestLevel)
     return (uint32_t)std::pow(IN_LOOP_REFERENCE_COUNT_FACTOR, std::min(loopNestLevel, 8));
 }
 
+// Load the "gen" records of the block profile that match this kernel. Each
+// line is "<kind> <hash> <kernel> <bb id> <count>"; the hash is only checked
+// when -blockProfileHash is given.
+void GlobalRA::loadBlockProfile()
+{
+    blockProfileLoaded = true;
+    const char* fileName = builder.getOptions()->getOptionCstr(vISA_BlockProfileFile);
+    if (fileName == NULL)
+    {
+        return;
+    }
+    std::ifstream profile(fileName);
+    if (!profile)
+    {
+        return;
+    }
+
+    bool checkHash = builder.getOptions()->isOptionSetByUser(vISA_BlockProfileHash);
+    uint64_t hash = builder.getOptions()->getuInt64Option(vISA_BlockProfileHash);
+    std::string line;
+    while (std::getline(profile, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream record(line);
+        std::string kind, kernelName;
+        uint64_t recordHash = 0, count = 0;
+        unsigned bbId = 0;
+        if (!(record >> kind >> std::hex >> recordHash >> std::dec >> kernelName >> bbId >> count))
+        {
+            continue;
+        }
+        if (kind != "gen" || kernelName != kernel.getName() ||
+            (checkHash && recordHash != hash))
+        {
+            continue;
+        }
+        bbProfileCounts[bbId] = count;
+    }
+
+    auto entryIt = bbProfileCounts.find(kernel.fg.getEntryBB()->getId());
+    if (entryIt != bbProfileCounts.end())
+    {
+        entryProfileCount = entryIt->second;
+    }
+}
+
+// Reference weight of a BB. With a block profile, references are weighted by
+// how many times the block runs per kernel entry; otherwise by loop depth.
+uint32_t GlobalRA::getRefCount(G4_BB* bb)
+{
+    if (!blockProfileLoaded)
+    {
+        loadBlockProfile();
+    }
+    if (entryProfileCount != 0)
+    {
+        auto it = bbProfileCounts.find(bb->getId());
+        if (it != bbProfileCounts.end())
+        {
+            uint64_t weight = 1 + it->second / entryProfileCount;
+            return (uint32_t)std::min<uint64_t>(weight, getRefCount(8));
+        }
+    }
+    return getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
+        bb->getNestLevel() : 0);
+}
+
 // handle return value interference for fcall
 void Interference::buildInterferenceForFcall(G4_BB* bb, BitSet& live, G4_INST* inst, std::list<G4_INST*>::reverse_iterator i, G4_VarBase* regVar)
 {
     assert(inst->opcode() == G4_pseudo_fcall && "expect fcall inst");
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = gra.getRefCount(bb);
 
     if (regVar->isRegAllocPartaker())
     {
@@ -1917,8 +1986,7 @@ bool GlobalRA::isReRAPass()
 
 void Interference::buildInterferenceForDst(G4_BB* bb, BitSet& live, G4_INST* inst, std::list<G4_INST*>::reverse_iterator i, G4_DstRegRegion* dst)
 {
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = gra.getRefCount(bb);
 
     if (dst->getBase()->isRegAllocPartaker())
     {
@@ -2134,8 +2202,7 @@ void Interference::buildInterferenceForDst(G4_BB* bb, BitSet& live, G4_INST* ins
 void Interference::buildInterferenceWithinBB(G4_BB* bb, BitSet& live, G4_Declare* arg, G4_Declare* ret)
 {
     DebugInfoState state(kernel.fg.mem);
-    unsigned refCount = GlobalRA::getRefCount(kernel.getOption(vISA_ConsiderLoopInfoInRA) ?
-        bb->getNestLevel() : 0);
+    unsigned refCount = gra.getRefCount(bb);
 
     for (std::list<G4_INST*>::reverse_iterator i = bb->instList.rbegin();
         i != bb->instList.rend();
@@ -31,6 +31,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Gen4_IR.hpp"
 #include "SpillManagerGMRF.h"
 #include <list>
+#include <unordered_map>
 #include <unordered_set>
 #include <limits>
 #include "RPE.h"
@@ -728,6 +729,12 @@ namespace vISA
         RAVarInfo defaultValues;
         std::vector<RAVarInfo> vars;
 
+        // Execution count per BB id from the block profile, if any.
+        std::unordered_map<unsigned, uint64_t> bbProfileCounts;
+        uint64_t entryProfileCount;
+        bool blockProfileLoaded;
+        void loadBlockProfile();
+
         void resize(unsigned int id)
         {
             if (id >= vars.size())
@@ -995,8 +1002,8 @@ namespace vISA
         void removeUnreferencedDcls();
         LocalLiveRange* GetOrCreateLocalLiveRange(G4_Declare* topdcl, Mem_Manager& mem);
 
-        GlobalRA(G4_Kernel& k, PhyRegPool& r, PointsToAnalysis& p2a) : kernel(k), builder(*k.fg.builder), regPool(r),
-            pointsToAnalysis(p2a)
+        GlobalRA(G4_Kernel& k, PhyRegPool& r, PointsToAnalysis& p2a) : entryProfileCount(0), blockProfileLoaded(false),
+            kernel(k), builder(*k.fg.builder), regPool(r), pointsToAnalysis(p2a)
         {
             vars.resize(k.Declares.size());
         }
@@ -1004,6 +1011,7 @@ namespace vISA
         void emitFGWithLiveness(LivenessAnalysis& liveAnalysis);
         void reportSpillInfo(LivenessAnalysis& liveness, GraphColor& coloring);
         static uint32_t getRefCount(int loopNestLevel);
+        uint32_t getRefCount(G4_BB* bb);
         bool isReRAPass();
         void updateSubRegAlignment(unsigned char regFile, G4_SubReg_Align subAlign);
         void updateAlignment(unsigned char regFile, G4_Align align);
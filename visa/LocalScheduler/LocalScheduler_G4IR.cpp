@@ -26,9 +26,13 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <fstream>
 #include <functional>
+#include <map>
 #include <sstream>
 #include "LocalScheduler_G4IR.h"
 #include "Dependencies_G4IR.h"
+#include "../Common_ISA_framework.h"
+#include "../VISAKernel.h"
+#include "../BuildCISAIR.h"
 #include "../G4_Opcode.h"
 #include "../Timer.h"
 #include "visa_wa.h"
@@ -192,6 +196,43 @@ static bool operandOverlap(G4_Operand* opnd1, G4_Operand* opnd2)
         opnd2->getLinearizedEnd() > opnd1->getLinearizedStart());
 }
 
+namespace {
+    // A unit of local scheduling work: either a whole BB or a window of a
+    // large BB that has been spliced into a temporary BB. Regions never share
+    // instructions, so they can be scheduled independently of each other.
+    struct SchedRegion
+    {
+        G4_BB* bb;
+        G4_BB* owner;       // the BB in the flow graph this region belongs to
+        int infoIdx;        // slot in the BB info table, -1 for windows
+        uint32_t lastCycle;
+        uint32_t staticCycle;
+        uint32_t sendStallCycle;
+
+        SchedRegion(G4_BB* b, G4_BB* o, int idx)
+            : bb(b), owner(o), infoIdx(idx), lastCycle(0), staticCycle(0), sendStallCycle(0) {}
+    };
+}
+
+// Operand bounds are computed lazily on first query. Compute them up front so
+// that scheduler worker threads only ever read the IR they do not own.
+static void precomputeOperandBounds(G4_BB* bb)
+{
+    for (G4_INST* inst : bb->instList)
+    {
+        for (Gen4_Operand_Number opndNum
+            : {Opnd_dst, Opnd_src0, Opnd_src1, Opnd_src2, Opnd_src3,
+            Opnd_pred, Opnd_condMod, Opnd_implAccSrc, Opnd_implAccDst})
+        {
+            G4_Operand* opnd = inst->getOperand(opndNum);
+            if (opnd && !opnd->isLabel() && !opnd->isImm())
+            {
+                opnd->getRightBound();
+            }
+        }
+    }
+}
+
 /*
     Entry to the local scheduling.
     */
@@ -217,18 +258,19 @@ void LocalScheduler::localScheduling()
     const Options *m_options = fg.builder->getOptions();
     LatencyTable LT(m_options);
 
+    std::vector<SchedRegion> regions;
+    std::vector<std::pair<G4_BB*, std::vector<G4_BB*>>> splitBBs;
+    unsigned int schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
+
     for (; ib != bend; ++ib)
     {
         unsigned int instCountBefore = (uint32_t)(*ib)->instList.size();
-        // mem pool for each BB
-        Mem_Manager bbMem(4096);
 
         if (instCountBefore < SCH_THRESHOLD)
         {
             continue;
         }
 
-        unsigned int schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
         if (schedulerWindowSize > 0 && instCountBefore > schedulerWindowSize)
         {
             // If BB has a lot of instructions then when recursively
@@ -250,8 +292,7 @@ void LocalScheduler::localScheduling()
                     tempBB->instList.splice(tempBB->instList.begin(),
                         (*ib)->instList,
                         (*ib)->instList.begin(), inst_it);
-                    G4_BB_Schedule schedule(fg.getKernel(), bbMem, tempBB, buildDDD, listSch,
-                        totalCycle, m_options, LT);
+                    regions.push_back(SchedRegion(tempBB, *ib, -1));
 
                     count = 0;
                 }
@@ -263,28 +304,251 @@ void LocalScheduler::localScheduling()
                 }
             }
 
-            for (unsigned int i = 0; i < sections.size(); i++)
-            {
-                (*ib)->instList.splice((*ib)->instList.end(), sections[i]->instList, sections[i]->instList.begin(), sections[i]->instList.end());
-            }
+            splitBBs.push_back(std::make_pair(*ib, sections));
         }
         else
         {
-            G4_BB_Schedule schedule(fg.getKernel(), bbMem, *ib, buildDDD, listSch, totalCycle,
-                m_options, LT);
-            bbInfo[i].id = (*ib)->getId();
-            bbInfo[i].staticCycle = schedule.sequentialCycle;
-            bbInfo[i].sendStallCycle = schedule.sendStallCycle;
+            regions.push_back(SchedRegion(*ib, *ib, i));
         }
 
         i++;
     }
 
+    // mem pool for each region
+    auto scheduleRegion = [&](SchedRegion& region)
+    {
+        Mem_Manager regionMem(4096);
+        G4_BB_Schedule schedule(fg.getKernel(), regionMem, region.bb, buildDDD, listSch,
+            region.lastCycle, m_options, LT);
+        region.staticCycle = schedule.sequentialCycle;
+        region.sendStallCycle = schedule.sendStallCycle;
+    };
+
+    unsigned int numThreads = std::min(m_options->getuInt32Option(vISA_LocalSchedulingThreads),
+        (uint32_t)regions.size());
+    if (numThreads > 1)
+    {
+        for (const SchedRegion& region : regions)
+        {
+            precomputeOperandBounds(region.bb);
+        }
+
+        // Workers pull regions in order; results are merged below in region
+        // order, so the output does not depend on the thread count. The
+        // scheduler dumps instructions, which reads the builder.
+        CISA_IR_Builder* builder = pCisaBuilder;
+        parallelFor(regions.size(), numThreads, [&](size_t r)
+        {
+            scheduleRegion(regions[r]);
+        }, [builder]() { pCisaBuilder = builder; });
+    }
+    else
+    {
+        for (SchedRegion& region : regions)
+        {
+            scheduleRegion(region);
+        }
+    }
+
+    std::map<G4_BB*, uint32_t> bbCycles;
+    for (const SchedRegion& region : regions)
+    {
+        totalCycle += region.lastCycle;
+        bbCycles[region.owner] += region.lastCycle;
+        if (region.infoIdx >= 0)
+        {
+            bbInfo[region.infoIdx].id = region.bb->getId();
+            bbInfo[region.infoIdx].staticCycle = region.staticCycle;
+            bbInfo[region.infoIdx].sendStallCycle = region.sendStallCycle;
+        }
+    }
+
+    for (auto& split : splitBBs)
+    {
+        for (G4_BB* section : split.second)
+        {
+            split.first->instList.splice(split.first->instList.end(), section->instList,
+                section->instList.begin(), section->instList.end());
+        }
+    }
+
+    if (m_options->getOption(vISA_TraceScheduling))
+    {
+        scheduleTraces(LT, bbCycles);
+    }
+
     FINALIZER_INFO* jitInfo = fg.builder->getJitInfo();
     jitInfo->BBInfo = bbInfo;
     jitInfo->BBNum = i;
 }
 
+// Returns true if bb always falls through into next and next cannot be
+// entered any other way. Both blocks then execute under the same predicate
+// and channel mask, so instructions can move between them without any
+// compensation code.
+static bool isFallThroughOnly(G4_BB* bb, G4_BB* next)
+{
+    if (bb->getBBType() != G4_BB_NONE_TYPE || next->getBBType() != G4_BB_NONE_TYPE)
+    {
+        return false;
+    }
+
+    if (bb->Succs.size() != 1 || bb->Succs.front() != next ||
+        next->Preds.size() != 1 || next->Preds.front() != bb)
+    {
+        return false;
+    }
+
+    if (!bb->instList.empty())
+    {
+        G4_INST* lastInst = bb->instList.back();
+        if (lastInst->isFlowControl() || lastInst->isEOT())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+    Trace scheduling: chains of blocks linked by fall-through only edges are
+    scheduled as one region so that latency at the end of a block (typically
+    sends) can be overlapped with independent work from its successor.
+    The blocks keep their original instruction counts; only the instructions
+    move between them. A trace schedule is kept only if its estimate beats
+    the sum of the estimates of its blocks scheduled separately.
+    */
+void LocalScheduler::scheduleTraces(const LatencyTable &LT, std::map<G4_BB*, uint32_t> &bbCycles)
+{
+    const Options *m_options = fg.builder->getOptions();
+    unsigned int schedulerWindowSize = m_options->getuInt32Option(vISA_SchedulerWindowSize);
+    int buildDDD = 0, listSch = 0;
+    uint32_t totalBefore = 0, totalAfter = 0;
+    std::stringstream report;
+
+    for (BB_LIST_ITER ib = fg.BBs.begin(), bend = fg.BBs.end(); ib != bend;)
+    {
+        std::vector<G4_BB*> trace(1, *ib);
+        size_t numInsts = (*ib)->instList.size();
+        for (++ib; ib != bend && isFallThroughOnly(trace.back(), *ib); ++ib)
+        {
+            size_t traceInsts = numInsts + (*ib)->instList.size();
+            if (schedulerWindowSize > 0 && traceInsts > schedulerWindowSize)
+            {
+                break;
+            }
+            trace.push_back(*ib);
+            numInsts = traceInsts;
+        }
+
+        if (trace.size() < 2)
+        {
+            continue;
+        }
+
+        uint32_t before = 0;
+        for (G4_BB* bb : trace)
+        {
+            auto cycleIt = bbCycles.find(bb);
+            if (cycleIt != bbCycles.end())
+            {
+                before += cycleIt->second;
+            }
+            else if (!bb->instList.empty())
+            {
+                // Blocks too small for local scheduling still need an estimate.
+                Mem_Manager bbMem(4096);
+                uint32_t bbCycle = 0;
+                G4_BB_Schedule schedule(fg.getKernel(), bbMem, bb, buildDDD, listSch,
+                    bbCycle, m_options, LT);
+                bbCycles[bb] = bbCycle;
+                before += bbCycle;
+            }
+        }
+
+        // Move the trace into a temporary BB. Labels of the later blocks are
+        // held back: they would act as scheduling barriers, and are put back
+        // at the block boundaries afterwards.
+        G4_BB* traceBB = fg.createNewBB(false);
+        std::vector<G4_INST*> labels;
+        std::vector<size_t> sizes;
+        for (G4_BB* bb : trace)
+        {
+            G4_INST* label = nullptr;
+            if (bb != trace.front() && !bb->instList.empty() && bb->instList.front()->isLabel())
+            {
+                label = bb->instList.front();
+                bb->instList.pop_front();
+            }
+            labels.push_back(label);
+            sizes.push_back(bb->instList.size());
+            traceBB->instList.splice(traceBB->instList.end(), bb->instList);
+        }
+
+        // Remember the incoming code; scheduling may also set InstOpt_Atomic
+        // on message pairs, which must be undone if the trace is rejected.
+        std::vector<std::pair<G4_INST*, unsigned int>> original;
+        for (G4_INST* inst : traceBB->instList)
+        {
+            original.push_back(std::make_pair(inst, inst->getOption()));
+        }
+
+        uint32_t after = 0;
+        {
+            Mem_Manager traceMem(4096);
+            G4_BB_Schedule schedule(fg.getKernel(), traceMem, traceBB, buildDDD, listSch,
+                after, m_options, LT);
+        }
+
+        bool keep = after < before;
+        if (!keep)
+        {
+            INST_LIST_ITER inst_it = traceBB->instList.begin();
+            for (auto& orig : original)
+            {
+                *inst_it++ = orig.first;
+                orig.first->setOptions(orig.second);
+            }
+        }
+
+        INST_LIST_ITER inst_it = traceBB->instList.begin();
+        for (size_t b = 0; b < trace.size(); b++)
+        {
+            INST_LIST_ITER sectionEnd = inst_it;
+            std::advance(sectionEnd, sizes[b]);
+            trace[b]->instList.splice(trace[b]->instList.end(), traceBB->instList, inst_it, sectionEnd);
+            inst_it = sectionEnd;
+            if (labels[b])
+            {
+                trace[b]->instList.push_front(labels[b]);
+            }
+        }
+
+        totalBefore += before;
+        totalAfter += keep ? after : before;
+        report << "trace";
+        for (G4_BB* bb : trace)
+        {
+            report << " BB" << bb->getId();
+        }
+        report << ": " << numInsts << " insts, " << before << " -> " << after << " cycles"
+            << (keep ? "" : " (rejected)") << "\n";
+    }
+
+    if (m_options->getOption(vISA_DumpTraceSchedule))
+    {
+        const char *asmName = nullptr;
+        m_options->getOption(VISA_AsmFileName, asmName);
+        char dumpFileName[MAX_OPTION_STR_LENGTH];
+        SNPRINTF(dumpFileName, MAX_OPTION_STR_LENGTH, "%s.traces", asmName);
+        fstream ofile(dumpFileName, ios::out);
+        ofile << report.str();
+        ofile << "total: " << totalBefore << " -> " << totalAfter << " cycles\n";
+        ofile.close();
+    }
+}
+
 void G4_BB_Schedule::setOptimumConsecutiveSends()
 {
     optimumConsecutiveSends = m_options->getuInt32Option(vISA_NumPackedSends);
@@ -688,6 +952,14 @@ static inline bool hasIndirection(G4_Operand *opnd, Gen4_Operand_Number opndNum)
     }
 }
 
+// getDepSend() never reports a dependence between two sends for which this
+// returns false: neither of them can write memory.
+static bool sendMayWriteMemory(G4_INST* inst)
+{
+    G4_SendMsgDescriptor* msgDesc = inst->getMsgDesc();
+    return !msgDesc || msgDesc->isSendBarrier() || msgDesc->isDataPortWrite();
+}
+
 // Given an inst with physical register assignment,
 // return all bucket descriptors that the physical register can map
 // to. This requires taking in to account exec size, data
@@ -719,6 +991,8 @@ bool DDD::getBucketDescrs(G4_INST* inst, std::vector<BucketDescr>& BDvec)
     if (inst->isSend()) {
         if (inst->getMsgDesc()->isScratchRW()) {
             BDvec.push_back(BucketDescr(SCRATCH_SEND_BUCKET, Mask(), Opnd_dst));
+        } else if (splitSendBucket && !sendMayWriteMemory(inst)) {
+            BDvec.push_back(BucketDescr(SEND_READ_BUCKET, Mask(), Opnd_dst));
         } else {
             BDvec.push_back(BucketDescr(SEND_BUCKET, Mask(), Opnd_dst));
         }
@@ -804,7 +1078,7 @@ public:
         }
         BucketNode *operator*() {
             assert(node_it != LB->nodeBucketsArray[bucket].bucketVec->end());
-            return *node_it;
+            return &*node_it;
         }
     };
 
@@ -882,7 +1156,7 @@ public:
         BucketHeadNode &BHNode = nodeBucketsArray[bn_it.bucket];
         BUCKET_VECTOR &vec = *BHNode.bucketVec;
         BUCKET_VECTOR_ITER &node_it = bn_it.node_it;
-        if (*node_it == vec.back()) {
+        if (node_it + 1 == vec.end()) {
             vec.pop_back();
             node_it = vec.end();
         } else {
@@ -898,9 +1172,7 @@ public:
         // Append the bucket node to the vector hanging from the header
         assert(BHNode.bucketVec != nullptr);
         BUCKET_VECTOR& nodeVec = *(BHNode.bucketVec);
-        void *allocedMem = ddd->get_mem()->alloc(sizeof(BucketNode));
-        BucketNode *newNode = new(allocedMem)BucketNode(node, BD.mask, BD.operand);
-        nodeVec.push_back(newNode);
+        nodeVec.push_back(BucketNode(node, BD.mask, BD.operand));
         // If it is a write to a subreg, mark the NODE accordingly
         if (BD.operand == Opnd_dst) {
             node->setWritesToSubreg(BD.bucket);
@@ -989,7 +1261,11 @@ DDD::DDD(Mem_Manager &m, G4_BB* bb, const Options *options,
     SEND_BUCKET = A0_BUCKET + 1;
     SCRATCH_SEND_BUCKET = SEND_BUCKET + 1;
     OTHER_ARF_BUCKET = SCRATCH_SEND_BUCKET + 1;
-    TOTAL_BUCKETS = OTHER_ARF_BUCKET + 1;
+    SEND_READ_BUCKET = OTHER_ARF_BUCKET + 1;
+    TOTAL_BUCKETS = SEND_READ_BUCKET + 1;
+
+    splitSendBucket = m_options->getOption(vISA_SplitSendBucket);
+    buildingDAG = true;
 
     INST_LIST& instList = bb->instList;
     LiveBuckets LB(this, GRF_BUCKET, TOTAL_BUCKETS);
@@ -997,7 +1273,7 @@ DDD::DDD(Mem_Manager &m, G4_BB* bb, const Options *options,
     // Building the graph in reverse relative to the original instruction
     // order, to naturally take care of the liveness of operands.
     std::list<G4_INST*>::reverse_iterator iInst(instList.rbegin()), iInstEnd(instList.rend());
-    std::vector<BucketDescr> BDvec;
+    std::vector<BucketDescr> BDvec, sendScanBDvec;
 
     for (int nodeId = (int)(instList.size() - 1); iInst != iInstEnd; ++iInst, nodeId--)
     {
@@ -1054,8 +1330,26 @@ DDD::DDD(Mem_Manager &m, G4_BB* bb, const Options *options,
             // Compute buckets for RAW
             bool transitiveEdgeToBarrier = false;
 
+            // Sends in SEND_READ_BUCKET only need to be checked against the
+            // sends that may write memory, the others against both kinds.
+            std::vector<BucketDescr> *scanBDvec = &BDvec;
+            if (splitSendBucket && curInst->isSend()) {
+                scanBDvec = &sendScanBDvec;
+                sendScanBDvec.clear();
+                for (const BucketDescr &BD : BDvec) {
+                    if (BD.bucket == SEND_READ_BUCKET) {
+                        sendScanBDvec.push_back(BucketDescr(SEND_BUCKET, BD.mask, BD.operand));
+                    } else {
+                        sendScanBDvec.push_back(BD);
+                        if (BD.bucket == SEND_BUCKET) {
+                            sendScanBDvec.push_back(BucketDescr(SEND_READ_BUCKET, BD.mask, BD.operand));
+                        }
+                    }
+                }
+            }
+
             // For all bucket descriptors of curInst
-            for (const BucketDescr &BD : BDvec) {
+            for (const BucketDescr &BD : *scanBDvec) {
                 const int &curBucket = BD.bucket;
                 const Gen4_Operand_Number &curOpnd = BD.operand;
                 const Mask &curMask = BD.mask;
@@ -1092,7 +1386,7 @@ DDD::DDD(Mem_Manager &m, G4_BB* bb, const Options *options,
                         || curBucket == A0_BUCKET) {
                         dep = getDepForOpnd(curOpnd, liveOpnd);
                         curKillsBucket = false;
-                    } else if (curBucket == SEND_BUCKET) {
+                    } else if (curBucket == SEND_BUCKET || curBucket == SEND_READ_BUCKET) {
                         dep = getDepSend(curInst, liveInst, m_options);
                         hasOverlap = (dep != NODEP);
                         curKillsBucket = false;
@@ -1150,6 +1444,7 @@ DDD::DDD(Mem_Manager &m, G4_BB* bb, const Options *options,
         // Insert this node into the graph.
         InsertNode(node);
     }
+    buildingDAG = false;
 
     // We have no label in this block. Need to initialize roots to traverse the DAG correctly.
     if (Roots.size() == 0)
@@ -1492,7 +1787,12 @@ void DDD::setPriority(Node *pred, const Edge &edge)
 void DDD::createAddEdge(Node* pred, Node* succ, DepType d)
 {
     // Check whether an edge already exists
-    for (int i = 0; i < (int)(pred->succs.size()); i++)
+    int i = 0, e = (int)(pred->succs.size());
+    if (buildingDAG)
+    {
+        i = (succ->lastEdgePred == pred) ? (int)succ->lastEdgeIdx : e;
+    }
+    for (; i < e; i++)
     {
         Edge& curSucc = pred->succs[i];
         // Keep the deptype that has the highest latency
@@ -1512,6 +1812,8 @@ void DDD::createAddEdge(Node* pred, Node* succ, DepType d)
     }
 
     // No edge with the same successor exists. Append this edge.
+    succ->lastEdgePred = pred;
+    succ->lastEdgeIdx = (uint32_t)pred->succs.size();
     uint32_t edgeLatency = getEdgeLatency(pred, d);
     Edge newEdge = Edge(succ, d, edgeLatency);
     pred->succs.emplace_back(newEdge);
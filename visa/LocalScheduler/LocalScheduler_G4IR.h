@@ -29,6 +29,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <string>
 #include <set>
+#include <map>
 #include <bitset>
 #include "../Mem_Manager.h"
 #include "../FlowGraph.h"
@@ -113,6 +114,12 @@ class Node
     // we just leave it for debugging
     bool m_isDead = false;
 
+    // The last node that added an edge to this node and the index of that
+    // edge in its succs. While the DAG is built all edges of a node are added
+    // back to back, so this finds an existing edge without a search.
+    Node *lastEdgePred = nullptr;
+    uint32_t lastEdgeIdx = 0;
+
 public:
     static const uint32_t SCHED_CYCLE_UNINIT = UINT_MAX;
     static const int NO_SUBREG = INT_MAX;
@@ -223,7 +230,7 @@ struct BucketNode {
         : node(node1), mask(mask1), opndNum(opndNum1) {}
 };
 
-typedef std::vector<BucketNode *> BUCKET_VECTOR;
+typedef std::vector<BucketNode> BUCKET_VECTOR;
 typedef BUCKET_VECTOR::iterator BUCKET_VECTOR_ITER;
 
 // This is the head node from which the list of live nodes hangs from.
@@ -267,9 +274,15 @@ class DDD {
     int SEND_BUCKET;
     int SCRATCH_SEND_BUCKET;
     int OTHER_ARF_BUCKET;
+    int SEND_READ_BUCKET;
     int TOTAL_BUCKETS;
     int totalGRFNum;
     bool useMTLatencies;
+    // Keep sends that cannot write memory in SEND_READ_BUCKET so that they
+    // are not checked against each other.
+    bool splitSendBucket;
+    // True while the DAG is being built (see Node::lastEdgePred).
+    bool buildingDAG;
     G4_Kernel* kernel;
 
 public:
@@ -363,6 +376,7 @@ class LocalScheduler {
     // send latencies are now defined in FFLatency in LIR.cpp
     void EmitNode(Node *);
     void isolateBarrierBBs();
+    void scheduleTraces(const LatencyTable &LT, std::map<G4_BB*, uint32_t> &bbCycles);
 
 public:
     LocalScheduler(FlowGraph &flowgraph, Mem_Manager &m)
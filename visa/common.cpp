@@ -27,7 +27,11 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "visa_igc_common_header.h"
 #include "common.h"
 #include "G4_Opcode.h"
+#include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <thread>
+#include <vector>
 
 //for exception handling
 //FIXME: potentially not thread safe, but should be ok since it's debugging code
@@ -172,6 +176,53 @@ const char * GetSteppingString(void)
 
     return steppingName[stepping];
 }
+
+void parallelFor(size_t count, unsigned int numThreads,
+    const std::function<void(size_t)>& body,
+    const std::function<void()>& initThread)
+{
+    size_t numWorkers = std::min((size_t)numThreads, count);
+    if (numWorkers <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            body(i);
+        }
+        return;
+    }
+
+    const TARGET_PLATFORM callerPlatform = visaPlatform;
+    const Stepping callerStepping = stepping;
+
+    std::atomic<size_t> next(0);
+    auto runBodies = [&]()
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            body(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < numWorkers; t++)
+    {
+        workers.emplace_back([&]()
+        {
+            visaPlatform = callerPlatform;
+            stepping = callerStepping;
+            if (initThread)
+            {
+                initThread();
+            }
+            runBodies();
+        });
+    }
+    runBodies();
+    for (std::thread& t : workers)
+    {
+        t.join();
+    }
+}
 G4_Type_Info G4_Type_Table[Type_UNDEF+1] = {
     {Type_UD, 32, 4, 0xF, "ud"},
     {Type_D, 32, 4, 0xF, "d"},
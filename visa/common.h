@@ -29,6 +29,7 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <sstream>
 #include <cassert>
 #include <iostream>
+#include <functional>
 
 #include "cm_portability.h"
 
@@ -176,6 +177,14 @@ extern "C" int SetStepping( const char* s);
 extern "C" Stepping GetStepping( void );
 extern "C" const char * GetSteppingString( void );
 
+// Runs body(0), ..., body(count - 1) on up to numThreads threads, the calling
+// thread included. The platform and stepping are thread-local, so the other
+// threads take the caller's before running any body; initThread, if given,
+// then sets up any further thread-local state they need.
+void parallelFor(size_t count, unsigned int numThreads,
+    const std::function<void(size_t)>& body,
+    const std::function<void()>& initThread = nullptr);
+
 // Error types
 #define ERROR_UNKNOWN                       "ERROR: Unkown fatal internal error!"
 #define ERROR_INTERNAL_ARGUMENT "ERROR: Invalid argument in an internal function!"
@@ -43,6 +43,14 @@ SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "JitterDataStruct.h"
 #ifndef DLL_MODE
 #include "EnumFiles.hpp"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #endif
 
 using namespace std;
@@ -70,6 +78,103 @@ void parseWrapper(const char *fileName, int argc, const char *argv[], Options &o
 _THREAD CISA_IR_Builder * pCisaBuilder = NULL;
 
 #ifndef DLL_MODE
+// Read-only mapping of an input file. Falls back to reading the file into
+// memory if it cannot be mapped.
+class ISAFileMapping
+{
+    char* buf = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#endif
+
+public:
+    ISAFileMapping(const char* fileName)
+    {
+#ifdef _WIN32
+        file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            LARGE_INTEGER fileSize;
+            if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+            {
+                size = (size_t)fileSize.QuadPart;
+                mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (mapping)
+                {
+                    buf = (char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    mapped = buf != nullptr;
+                }
+            }
+        }
+#else
+        int fd = open(fileName, O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+            {
+                size = (size_t)st.st_size;
+                void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED)
+                {
+                    buf = (char*)addr;
+                    mapped = true;
+                }
+            }
+            close(fd);
+        }
+#endif
+        if (!mapped)
+        {
+            FILE* fp = fopen(fileName, "rb");
+            if (fp)
+            {
+                fseek(fp, 0, SEEK_END);
+                size = (size_t)ftell(fp);
+                rewind(fp);
+                buf = new char[size + 1];
+                if (fread(buf, 1, size, fp) != size)
+                {
+                    delete[] buf;
+                    buf = nullptr;
+                }
+                fclose(fp);
+            }
+        }
+    }
+
+    ~ISAFileMapping()
+    {
+        if (mapped)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(buf);
+#else
+            munmap(buf, size);
+#endif
+        }
+        else
+        {
+            delete[] buf;
+        }
+#ifdef _WIN32
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(file);
+        }
+#endif
+    }
+
+    const char* data() const { return buf; }
+};
+
 void parseNativeRelocs(CISA_IR_Builder* cisaBuilder)
 {
     if (cisaBuilder->m_options.getOptionCstr(vISA_RelocFilename))
@@ -99,57 +204,15 @@ void parse(const char *fileName, std::string testName, int argc, const char *arg
     vISA::Mem_Manager phyRegMem(PHY_REG_MEM_SIZE);
     vISA::PhyRegPool phyRegPool(phyRegMem, opt.getuInt32Option(vISA_TotalGRFNum));
 
-    // read in common isa binary file
-    int c;
-    char *buf;
-    FILE *commonISAInput = NULL;
-    long file_size;
-    unsigned byte_pos = 0;
-    common_isa_header commonISAHeader;
-    vISA::Mem_Manager globalMem(KERNEL_MEM_SIZE);
-
-    // open common isa file
-    if ((commonISAInput = fopen(fileName, "rb")) == NULL)
+    // Map the common isa binary file. The reader decodes straight out of the
+    // mapping, so the file is never copied into a heap buffer.
+    ISAFileMapping isafile(fileName);
+    if (!isafile.data())
     {
-        fprintf(stderr, "Cannot open file %s\n", fileName);
-        exit(1);
-    }
-
-    fseek(commonISAInput, 0, SEEK_END);
-    file_size = ftell(commonISAInput);
-    fseek(commonISAInput, 0, SEEK_SET);
-
-    buf = (char*)globalMem.alloc(file_size + 1);
-    char *buf_ptr = buf;
-    while ((c = fgetc(commonISAInput)) != EOF) {
-        *buf_ptr = c;
-        buf_ptr++;
-    }
-
-    processCommonISAHeader(commonISAHeader, byte_pos, buf, &globalMem);
-    fclose(commonISAInput);
-    vISA::Mem_Manager mem(4096);
-
-    /// Try opening the file.
-    FILE* isafile = fopen(fileName, "rb");
-    if (!isafile) {
         cerr << "Failure, unable to be opened." << endl;
         exit(EXIT_FAILURE);
     }
-
-    /// Calculate file size.
-    fseek(isafile, 0, SEEK_END);
-    long isafilesize = ftell(isafile);
-    rewind(isafile);
-
-    /// Reading file into buffer.
-    char* isafilebuf = (char*)mem.alloc(isafilesize);
-    if (isafilesize != fread(isafilebuf, 1, isafilesize, isafile))
-    {
-        cerr << "Unable to read entire file into buffer." << endl;
-        exit(EXIT_FAILURE);
-    }
-    fclose(isafile);
+    const char* isafilebuf = isafile.data();
 
     TARGET_PLATFORM platform = getGenxPlatform();
     CM_VISA_BUILDER_OPTION builderOption =